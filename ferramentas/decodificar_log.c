@@ -0,0 +1,231 @@
+// Decodificador do log adiado (lib/log.h) para o computador: lê a saída do stdio do firmware, converte
+// os quadros binários de volta no texto das mensagens e repassa o texto comum como chegou.
+//
+// Compilação (com a mesma versão de lib/log_mensagens.h do firmware):
+//   cc -I../lib -o decodificar_log decodificar_log.c
+//
+// Uso: a saída da serial USB, em modo bruto, ou da simulação na entrada padrão.
+//   stty -F /dev/ttyACM0 raw && ./decodificar_log < /dev/ttyACM0
+//   ./build_host/paciente_seguro_host | ./build_host/decodificar_log -t
+//
+// Com -t cada mensagem começa pelo instante do registro, em segundos desde o boot. Antes de decodificar,
+// os tipos de cada mensagem são conferidos com as conversões do formato; uma divergência encerra com erro.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "log_mensagens.h"
+
+// Mesmos limites de lib/log.h, que depende do SDK
+#define LOG_QUADRO_INICIO 0x00
+#define LOG_QUADRO_CABECALHO 6
+#define LOG_ARGUMENTOS_BYTES 40
+
+typedef struct {
+    const char *nome;
+    const char *tipos;
+    const char *formato;
+} mensagem_t;
+
+static const mensagem_t mensagens[] = {
+#define LOG_X(nome, nivel, tipos, formato) { #nome, tipos, formato },
+    LOG_MENSAGENS(LOG_X)
+#undef LOG_X
+};
+
+#define MENSAGENS_TOTAL (sizeof(mensagens) / sizeof(mensagens[0]))
+
+// Avança até a conversão de uma especificação iniciada por '%'; retorna NULL se incompleta
+static const char *conversao(const char *p) {
+    for (p++; *p; p++) {
+        if (strchr("diouxXfFeEgGsc", *p)) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+// Tipo esperado para a especificação entre inicio ('%') e fim (a conversão), ou 0 se não suportada
+static char tipo_esperado(const char *inicio, const char *fim) {
+    bool longo = memchr(inicio, 'l', (size_t)(fim - inicio)) != NULL;
+    if (memchr(inicio, '*', (size_t)(fim - inicio))) {
+        return 0;
+    }
+    switch (*fim) {
+    case 'd':
+    case 'i':
+        return longo ? 'l' : 'd';
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        return longo ? 'L' : 'u';
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+        return 'f';
+    case 's':
+        return 's';
+    default:
+        return 0;
+    }
+}
+
+static bool verifica_tabela(void) {
+    bool valida = true;
+    for (size_t i = 0; i < MENSAGENS_TOTAL; i++) {
+        const char *tipos = mensagens[i].tipos;
+        for (const char *p = mensagens[i].formato; *p; p++) {
+            if (*p != '%') {
+                continue;
+            }
+            if (p[1] == '%') {
+                p++;
+                continue;
+            }
+            const char *fim = conversao(p);
+            char esperado = fim ? tipo_esperado(p, fim) : 0;
+            if (!esperado || *tipos != esperado) {
+                fprintf(stderr, "mensagem %s: tipos \"%s\" não correspondem ao formato\n",
+                        mensagens[i].nome, mensagens[i].tipos);
+                valida = false;
+                break;
+            }
+            tipos++;
+            p = fim;
+        }
+        if (valida && *tipos) {
+            fprintf(stderr, "mensagem %s: tipos além dos argumentos do formato\n", mensagens[i].nome);
+            valida = false;
+        }
+    }
+    return valida;
+}
+
+// Imprime a mensagem com os argumentos do registro; argumentos ausentes (truncados) saem como "?"
+static void imprime(const mensagem_t *mensagem, const uint8_t *args, size_t tamanho) {
+    const char *tipos = mensagem->tipos;
+    size_t n = 0;
+    for (const char *p = mensagem->formato; *p; p++) {
+        if (*p != '%') {
+            putchar(*p);
+            continue;
+        }
+        if (p[1] == '%') {
+            putchar('%');
+            p++;
+            continue;
+        }
+        const char *fim = conversao(p);
+        char especificacao[16];
+        size_t len = (size_t)(fim - p) + 1;
+        if (len >= sizeof(especificacao)) {
+            len = sizeof(especificacao) - 1;
+        }
+        memcpy(especificacao, p, len);
+        especificacao[len] = '\0';
+        p = fim;
+
+        char tipo = *tipos++;
+        if (tipo == 's') {
+            const uint8_t *terminador = n < tamanho ? memchr(&args[n], '\0', tamanho - n) : NULL;
+            if (!terminador) {
+                putchar('?');
+                n = tamanho;
+                continue;
+            }
+            printf(especificacao, (const char *)&args[n]);
+            n = (size_t)(terminador - args) + 1;
+            continue;
+        }
+        if (n + sizeof(uint32_t) > tamanho) {
+            putchar('?');
+            n = tamanho;
+            continue;
+        }
+        uint32_t valor = (uint32_t)args[n] | (uint32_t)args[n + 1] << 8 | (uint32_t)args[n + 2] << 16 |
+                         (uint32_t)args[n + 3] << 24;
+        n += sizeof(uint32_t);
+        switch (tipo) {
+        case 'd':
+            printf(especificacao, (int)(int32_t)valor);
+            break;
+        case 'u':
+            printf(especificacao, (unsigned)valor);
+            break;
+        case 'l':
+            printf(especificacao, (long)(int32_t)valor);
+            break;
+        case 'L':
+            printf(especificacao, (unsigned long)valor);
+            break;
+        case 'f': {
+            float f;
+            memcpy(&f, &valor, sizeof(f));
+            printf(especificacao, (double)f);
+            break;
+        }
+        }
+    }
+}
+
+// Lê e imprime um quadro, já consumido o byte de início; retorna false no fim da entrada
+static bool decodifica_quadro(FILE *entrada, bool instantes, unsigned long *invalidos) {
+    int tamanho = fgetc(entrada);
+    if (tamanho == EOF) {
+        return false;
+    }
+    if (tamanho < LOG_QUADRO_CABECALHO || tamanho > LOG_QUADRO_CABECALHO + LOG_ARGUMENTOS_BYTES) {
+        (*invalidos)++;
+        return true; // Não era um quadro; segue procurando o próximo início
+    }
+    uint8_t quadro[LOG_QUADRO_CABECALHO + LOG_ARGUMENTOS_BYTES + 1];
+    if (fread(quadro, 1, (size_t)tamanho + 1, entrada) != (size_t)tamanho + 1) {
+        return false;
+    }
+    uint8_t soma = (uint8_t)tamanho;
+    for (int i = 0; i < tamanho; i++) {
+        soma ^= quadro[i];
+    }
+    uint16_t id = (uint16_t)(quadro[0] | quadro[1] << 8);
+    if (soma != quadro[tamanho] || id >= MENSAGENS_TOTAL) {
+        (*invalidos)++;
+        return true;
+    }
+    if (instantes) {
+        uint32_t instante_us = (uint32_t)quadro[2] | (uint32_t)quadro[3] << 8 | (uint32_t)quadro[4] << 16 |
+                               (uint32_t)quadro[5] << 24;
+        printf("[%lu.%06lu] ", (unsigned long)(instante_us / 1000000), (unsigned long)(instante_us % 1000000));
+    }
+    imprime(&mensagens[id], &quadro[LOG_QUADRO_CABECALHO], (size_t)tamanho - LOG_QUADRO_CABECALHO);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool instantes = argc > 1 && strcmp(argv[1], "-t") == 0;
+    if (!verifica_tabela()) {
+        return 1;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    unsigned long invalidos = 0;
+    int c;
+    while ((c = fgetc(stdin)) != EOF) {
+        if (c != LOG_QUADRO_INICIO) {
+            putchar(c);
+            continue;
+        }
+        if (!decodifica_quadro(stdin, instantes, &invalidos)) {
+            break;
+        }
+    }
+    if (invalidos) {
+        fprintf(stderr, "%lu quadros inválidos ignorados\n", invalidos);
+        return 1;
+    }
+    return 0;
+}
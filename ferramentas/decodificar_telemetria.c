@@ -0,0 +1,113 @@
+// Decodificador de telemetria binária para o computador (ingestão e testes).
+//
+// Compilação:
+//   cc -I../lib -o decodificar_telemetria decodificar_telemetria.c ../lib/telemetria.c
+//
+// Uso: cada mensagem em hexadecimal, como argumento ou uma por linha na entrada padrão.
+//   mosquitto_sub -t /telemetria -F %x | ./decodificar_telemetria
+//   ./decodificar_telemetria 01000305e80705...
+//
+// Saída: uma linha CSV por registro, "sequencia,instante_ms,temperatura,bpm,estado". Mensagens com
+// resumo terminam com uma linha de comentário "# resumo,sequencia,tmin,tmax,tmedia,bpm_min,bpm_max,bpm_medio".
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "telemetria.h"
+
+#define MENSAGEM_MAXIMA 4096
+
+// Converte texto hexadecimal em bytes, ignorando espaços; retorna -1 se inválido
+static int hex_para_bytes(const char *texto, uint8_t *saida, size_t capacidade) {
+    size_t n = 0;
+    int alto = -1;
+    for (; *texto; texto++) {
+        if (isspace((unsigned char)*texto)) {
+            continue;
+        }
+        if (!isxdigit((unsigned char)*texto)) {
+            return -1;
+        }
+        int valor = isdigit((unsigned char)*texto) ? *texto - '0' : tolower((unsigned char)*texto) - 'a' + 10;
+        if (alto < 0) {
+            alto = valor;
+        } else {
+            if (n == capacidade) {
+                return -1;
+            }
+            saida[n++] = (uint8_t)(alto << 4 | valor);
+            alto = -1;
+        }
+    }
+    return alto < 0 ? (int)n : -1;
+}
+
+// Imprime centésimos com duas casas decimais
+static void imprime_centesimos(int32_t centesimos) {
+    long absoluto = centesimos < 0 ? -(long)centesimos : (long)centesimos;
+    printf("%s%ld.%02ld", centesimos < 0 ? "-" : "", absoluto / 100, absoluto % 100);
+}
+
+static int decodifica(const char *hex) {
+    static uint8_t mensagem[MENSAGEM_MAXIMA];
+    int tamanho = hex_para_bytes(hex, mensagem, sizeof(mensagem));
+    if (tamanho < 0) {
+        fprintf(stderr, "hexadecimal inválido\n");
+        return 1;
+    }
+    if (tamanho == 0) {
+        return 0; // Linha em branco
+    }
+
+    telemetria_decodificador_t dec;
+    telemetria_cabecalho_t cabecalho;
+    if (!telemetria_decodifica_cabecalho(&dec, mensagem, tamanho, &cabecalho)) {
+        fprintf(stderr, "cabeçalho inválido ou versão não suportada\n");
+        return 1;
+    }
+
+    telemetria_registro_t registro;
+    uint8_t lidos = 0;
+    while (telemetria_proximo(&dec, &registro)) {
+        printf("%lu,%lu,", (unsigned long)cabecalho.sequencia, (unsigned long)registro.instante_ms);
+        imprime_centesimos(registro.temperatura_c100);
+        printf(",%ld,%u\n", (long)registro.batimento_bpm, registro.estado);
+        lidos++;
+    }
+    if (lidos != cabecalho.contagem) {
+        fprintf(stderr, "mensagem truncada: %u de %u registros\n", lidos, cabecalho.contagem);
+        return 1;
+    }
+
+    if (cabecalho.flags & TELEMETRIA_FLAG_RESUMO) {
+        telemetria_resumo_t resumo;
+        if (!telemetria_decodifica_resumo(&dec, &resumo)) {
+            fprintf(stderr, "resumo truncado\n");
+            return 1;
+        }
+        printf("# resumo,%lu,", (unsigned long)cabecalho.sequencia);
+        imprime_centesimos(resumo.temperatura_min_c100);
+        putchar(',');
+        imprime_centesimos(resumo.temperatura_max_c100);
+        putchar(',');
+        imprime_centesimos(resumo.temperatura_media_c100);
+        printf(",%ld,%ld,%ld\n", (long)resumo.batimento_min_bpm, (long)resumo.batimento_max_bpm,
+               (long)resumo.batimento_media_bpm);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int erros = 0;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            erros += decodifica(argv[i]);
+        }
+    } else {
+        static char linha[2 * MENSAGEM_MAXIMA + 2];
+        while (fgets(linha, sizeof(linha), stdin)) {
+            erros += decodifica(linha);
+        }
+    }
+    return erros ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+#ifndef ANIMACAO_MATRIZ_PIO_HOST_H
+#define ANIMACAO_MATRIZ_PIO_HOST_H
+
+// Substituto do cabeçalho gerado pelo pioasm a partir de lib/animacao_matriz.pio: as mesmas instruções e
+// uma inicialização que liga a máquina de estados à fita de WS2812 simulada no pino (src/pio.c)
+
+#include "pico_host.h"
+#include "simulacao.h"
+
+#define animacao_matriz_wrap_target 0
+#define animacao_matriz_wrap 6
+
+static const uint16_t animacao_matriz_program_instructions[] = {
+    0x6021, //  0: out    x, 1
+    0x0024, //  1: jmp    !x, 4
+    0xe401, //  2: set    pins, 1                [4]
+    0x0006, //  3: jmp    6
+    0xe201, //  4: set    pins, 1                [2]
+    0xe200, //  5: set    pins, 0                [2]
+    0xe100, //  6: set    pins, 0                [1]
+};
+
+static const struct pio_program animacao_matriz_program = {
+    .instructions = animacao_matriz_program_instructions,
+    .length = 7,
+    .origin = -1,
+};
+
+static inline void animacao_matriz_program_init(PIO pio, uint sm, uint offset, uint pin) {
+    (void)offset;
+    pio_gpio_init(pio, pin);
+    host_pio_fita(pio, sm, pin);
+    pio_sm_set_enabled(pio, sm, true);
+}
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef CREDENCIAIS_MQTT_HOST_H
+#define CREDENCIAIS_MQTT_HOST_H
+
+// Credenciais da simulação: a rede e o broker são simulados no próprio processo
+#define WIFI_SSID "simulacao"
+#define WIFI_PASSWORD "simulacao"
+#define MQTT_SERVER "127.0.0.1"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HARDWARE_CLOCKS_HOST_H
+#define HARDWARE_CLOCKS_HOST_H
+
+#include "pico_host.h"
+
+#endif
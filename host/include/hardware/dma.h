@@ -0,0 +1,6 @@
+#ifndef HARDWARE_DMA_HOST_H
+#define HARDWARE_DMA_HOST_H
+
+#include "pico_host.h"
+
+#endif
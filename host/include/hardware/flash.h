@@ -0,0 +1,6 @@
+#ifndef HARDWARE_FLASH_HOST_H
+#define HARDWARE_FLASH_HOST_H
+
+#include "pico_host.h"
+
+#endif
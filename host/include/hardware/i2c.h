@@ -0,0 +1,6 @@
+#ifndef HARDWARE_I2C_HOST_H
+#define HARDWARE_I2C_HOST_H
+
+#include "pico_host.h"
+
+#endif
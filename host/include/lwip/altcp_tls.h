@@ -0,0 +1,6 @@
+#ifndef LWIP_ALTCP_TLS_HOST_H
+#define LWIP_ALTCP_TLS_HOST_H
+
+#include "lwip_host.h"
+
+#endif
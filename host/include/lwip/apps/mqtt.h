@@ -0,0 +1,6 @@
+#ifndef LWIP_APPS_MQTT_HOST_H
+#define LWIP_APPS_MQTT_HOST_H
+
+#include "lwip_host.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef LWIP_DNS_HOST_H
+#define LWIP_DNS_HOST_H
+
+#include "lwip_host.h"
+
+#endif
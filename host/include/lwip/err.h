@@ -0,0 +1,6 @@
+#ifndef LWIP_ERR_HOST_H
+#define LWIP_ERR_HOST_H
+
+#include "lwip_host.h"
+
+#endif
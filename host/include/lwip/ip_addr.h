@@ -0,0 +1,6 @@
+#ifndef LWIP_IP_ADDR_HOST_H
+#define LWIP_IP_ADDR_HOST_H
+
+#include "lwip_host.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef LWIP_NETIF_HOST_H
+#define LWIP_NETIF_HOST_H
+
+#include "lwip_host.h"
+
+#endif
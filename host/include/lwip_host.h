@@ -0,0 +1,179 @@
+#ifndef LWIP_HOST_H
+#define LWIP_HOST_H
+
+// Substitutos do lwIP (MQTT, DNS, netif) e do cyw43 para a simulação no computador. O cliente MQTT
+// conversa com um broker simulado no próprio processo (host/src/rede.c); os callbacks são executados
+// no async context do cyw43, como no alvo. Sem MQTT_CERT_INC o TLS fica desativado, como no firmware.
+
+#include "pico_host.h"
+#include "pico/async_context.h"
+#include "lwipopts.h"   // MQTT_OUTPUT_RINGBUF_SIZE e MQTT_REQ_MAX_IN_FLIGHT do projeto
+
+#ifndef MQTT_REQ_MAX_IN_FLIGHT
+#define MQTT_REQ_MAX_IN_FLIGHT 4
+#endif
+#ifndef MQTT_OUTPUT_RINGBUF_SIZE
+#define MQTT_OUTPUT_RINGBUF_SIZE 256
+#endif
+#ifndef MQTT_VAR_HEADER_BUFFER_LEN
+#define MQTT_VAR_HEADER_BUFFER_LEN 128
+#endif
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef int8_t err_t;
+
+typedef enum {
+    ERR_OK = 0,
+    ERR_MEM = -1,
+    ERR_BUF = -2,
+    ERR_TIMEOUT = -3,
+    ERR_RTE = -4,
+    ERR_INPROGRESS = -5,
+    ERR_VAL = -6,
+    ERR_WOULDBLOCK = -7,
+    ERR_USE = -8,
+    ERR_ALREADY = -9,
+    ERR_ISCONN = -10,
+    ERR_CONN = -11,
+    ERR_IF = -12,
+    ERR_ABRT = -13,
+    ERR_RST = -14,
+    ERR_CLSD = -15,
+    ERR_ARG = -16
+} err_enum_t;
+
+// Endereços (somente IPv4)
+typedef struct {
+    uint32_t addr;
+} ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+#define ip4_addr_isany_val(endereco) ((endereco).addr == 0)
+char *ip4addr_ntoa(const ip4_addr_t *endereco);
+char *ipaddr_ntoa(const ip_addr_t *endereco);
+
+// Interface de rede
+struct netif;
+typedef void (*netif_status_callback_fn)(struct netif *netif);
+struct netif {
+    ip4_addr_t ip_addr;
+    uint8_t flags;
+    netif_status_callback_fn status_callback;
+    netif_status_callback_fn link_callback;
+};
+#define NETIF_FLAG_UP 0x01u
+#define NETIF_FLAG_LINK_UP 0x04u
+#define netif_is_link_up(netif) (((netif)->flags & NETIF_FLAG_LINK_UP) != 0)
+#define netif_ip4_addr(netif) ((const ip4_addr_t *)&(netif)->ip_addr)
+void netif_set_status_callback(struct netif *netif, netif_status_callback_fn callback);
+void netif_set_link_callback(struct netif *netif, netif_status_callback_fn callback);
+
+// Estatísticas: só os pools e o heap usados pelas métricas, preenchidos pelo cliente MQTT simulado
+#ifndef LWIP_STATS
+#define LWIP_STATS 1
+#endif
+typedef enum {
+    MEMP_TCP_PCB,
+    MEMP_TCP_SEG,
+    MEMP_PBUF,
+    MEMP_PBUF_POOL,
+    MEMP_MAX
+} memp_t;
+struct stats_mem {
+    const char *name;
+    uint32_t err;
+    uint32_t avail;
+    uint32_t used;
+    uint32_t max;
+    uint32_t illegal;
+};
+struct stats_ {
+    struct stats_mem mem;
+    struct stats_mem *memp[MEMP_MAX];
+};
+extern struct stats_ lwip_stats;
+
+// DNS: nomes numéricos e "localhost" são resolvidos na hora
+typedef void (*dns_found_callback)(const char *nome, const ip_addr_t *endereco, void *arg);
+err_t dns_gethostbyname(const char *nome, ip_addr_t *endereco, dns_found_callback callback, void *arg);
+
+// MQTT
+#define MQTT_PORT 1883
+#define MQTT_TLS_PORT 8883
+
+typedef struct mqtt_client_s mqtt_client_t;
+
+typedef enum {
+    MQTT_CONNECT_ACCEPTED = 0,
+    MQTT_CONNECT_REFUSED_PROTOCOL_VERSION = 1,
+    MQTT_CONNECT_REFUSED_IDENTIFIER = 2,
+    MQTT_CONNECT_REFUSED_SERVER = 3,
+    MQTT_CONNECT_REFUSED_USERNAME_PASS = 4,
+    MQTT_CONNECT_REFUSED_NOT_AUTHORIZED_ = 5,
+    MQTT_CONNECT_DISCONNECTED = 256,
+    MQTT_CONNECT_TIMEOUT = 257
+} mqtt_connection_status_t;
+
+enum { MQTT_DATA_FLAG_LAST = 1 };
+
+typedef void (*mqtt_connection_cb_t)(mqtt_client_t *client, void *arg, mqtt_connection_status_t status);
+typedef void (*mqtt_incoming_data_cb_t)(void *arg, const u8_t *data, u16_t len, u8_t flags);
+typedef void (*mqtt_incoming_publish_cb_t)(void *arg, const char *topic, u32_t tot_len);
+typedef void (*mqtt_request_cb_t)(void *arg, err_t err);
+
+struct mqtt_connect_client_info_t {
+    const char *client_id;
+    const char *client_user;
+    const char *client_pass;
+    u16_t keep_alive;
+    const char *will_topic;
+    const char *will_msg;
+    u8_t will_qos;
+    u8_t will_retain;
+};
+
+mqtt_client_t *mqtt_client_new(void);
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *endereco, u16_t porta, mqtt_connection_cb_t cb,
+                          void *arg, const struct mqtt_connect_client_info_t *client_info);
+void mqtt_disconnect(mqtt_client_t *client);
+u8_t mqtt_client_is_connected(mqtt_client_t *client);
+void mqtt_set_inpub_callback(mqtt_client_t *client, mqtt_incoming_publish_cb_t pub_cb,
+                             mqtt_incoming_data_cb_t data_cb, void *arg);
+err_t mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub);
+#define mqtt_subscribe(client, topic, qos, cb, arg) mqtt_sub_unsub(client, topic, qos, cb, arg, 1)
+#define mqtt_unsubscribe(client, topic, cb, arg) mqtt_sub_unsub(client, topic, 0, cb, arg, 0)
+err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos,
+                   u8_t retain, mqtt_request_cb_t cb, void *arg);
+
+// cyw43
+#define CYW43_ITF_STA 0
+#define CYW43_ITF_AP 1
+#define CYW43_LINK_DOWN 0
+#define CYW43_LINK_JOIN 1
+#define CYW43_LINK_NOIP 2
+#define CYW43_LINK_UP 3
+#define CYW43_LINK_FAIL (-1)
+#define CYW43_LINK_NONET (-2)
+#define CYW43_LINK_BADAUTH (-3)
+#define CYW43_AUTH_OPEN 0
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+
+typedef struct {
+    struct netif netif[2];
+} cyw43_t;
+extern cyw43_t cyw43_state;
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+int cyw43_arch_wifi_connect_async(const char *ssid, const char *senha, uint32_t autenticacao);
+int cyw43_tcpip_link_status(cyw43_t *self, int itf);
+int cyw43_wifi_leave(cyw43_t *self, int itf);
+async_context_t *cyw43_arch_async_context(void);
+void cyw43_arch_lwip_begin(void);
+void cyw43_arch_lwip_end(void);
+void cyw43_arch_poll(void);
+void cyw43_arch_wait_for_work_until(absolute_time_t ate);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef ASYNC_CONTEXT_HOST_H
+#define ASYNC_CONTEXT_HOST_H
+
+#include <pthread.h>
+#include "pico_host.h"
+
+// Async context com a mesma interface do SDK. O contexto é protegido por um mutex recursivo; os pedidos
+// de outras threads (set_work_pending, novos workers) acordam quem estiver em wait_for_work_until.
+
+typedef struct async_context async_context_t;
+
+typedef struct async_work_on_timeout {
+    struct async_work_on_timeout *next;
+    void (*do_work)(async_context_t *context, struct async_work_on_timeout *worker);
+    absolute_time_t next_time;
+    void *user_data;
+} async_at_time_worker_t;
+
+typedef struct async_when_pending_worker {
+    struct async_when_pending_worker *next;
+    void (*do_work)(async_context_t *context, struct async_when_pending_worker *worker);
+    volatile bool work_pending;
+    void *user_data;
+} async_when_pending_worker_t;
+
+struct async_context {
+    pthread_mutex_t trava;            // Recursivo, como o lock do SDK
+    pthread_mutex_t trava_sinal;
+    pthread_cond_t sinal;
+    bool sinalizado;
+    async_at_time_worker_t *at_time_workers;              // Ordenados pelo instante
+    async_when_pending_worker_t *when_pending_workers;
+    uint core_num;
+};
+
+bool async_context_host_init(async_context_t *context);
+
+bool async_context_add_at_time_worker(async_context_t *context, async_at_time_worker_t *worker);
+bool async_context_add_at_time_worker_at(async_context_t *context, async_at_time_worker_t *worker, absolute_time_t at);
+bool async_context_add_at_time_worker_in_ms(async_context_t *context, async_at_time_worker_t *worker, uint32_t ms);
+bool async_context_remove_at_time_worker(async_context_t *context, async_at_time_worker_t *worker);
+bool async_context_add_when_pending_worker(async_context_t *context, async_when_pending_worker_t *worker);
+bool async_context_remove_when_pending_worker(async_context_t *context, async_when_pending_worker_t *worker);
+void async_context_set_work_pending(async_context_t *context, async_when_pending_worker_t *worker);
+void async_context_poll(async_context_t *context);
+void async_context_wait_for_work_until(async_context_t *context, absolute_time_t until);
+void async_context_wait_for_work_ms(async_context_t *context, uint32_t ms);
+void async_context_acquire_lock_blocking(async_context_t *context);
+void async_context_release_lock(async_context_t *context);
+
+#endif
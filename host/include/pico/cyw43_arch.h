@@ -0,0 +1,6 @@
+#ifndef PICO_CYW43_ARCH_HOST_H
+#define PICO_CYW43_ARCH_HOST_H
+
+#include "lwip_host.h"
+
+#endif
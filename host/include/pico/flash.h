@@ -0,0 +1,6 @@
+#ifndef PICO_FLASH_HOST_H
+#define PICO_FLASH_HOST_H
+
+#include "pico_host.h"
+
+#endif
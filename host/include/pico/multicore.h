@@ -0,0 +1,6 @@
+#ifndef PICO_MULTICORE_HOST_H
+#define PICO_MULTICORE_HOST_H
+
+#include "pico_host.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef PICO_RAND_HOST_H
+#define PICO_RAND_HOST_H
+
+#include "pico_host.h"
+
+#endif
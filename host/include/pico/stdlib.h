@@ -0,0 +1,6 @@
+#ifndef PICO_STDLIB_HOST_H
+#define PICO_STDLIB_HOST_H
+
+#include "pico_host.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef PICO_UNIQUE_ID_HOST_H
+#define PICO_UNIQUE_ID_HOST_H
+
+#include "pico_host.h"
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef PICO_HOST_H
+#define PICO_HOST_H
+
+// Camada de compatibilidade do Pico SDK para a simulação no computador (ver "Simulação no Computador" no
+// README). Reúne as declarações usadas pela aplicação; os cabeçalhos pico/ e hardware/ desta pasta
+// apenas incluem este arquivo. Os núcleos são threads, as interrupções são chamadas a partir das threads
+// dos periféricos simulados e o tempo é o relógio monotônico do sistema.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+typedef unsigned int uint;
+
+#define __unused __attribute__((unused))
+#define __not_in_flash_func(nome) nome
+#define __time_critical_func(nome) nome
+
+#define PICO_ON_DEVICE 0
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_ERROR_GENERIC (-2)
+#define PICO_ERROR_NOT_PERMITTED (-4)
+
+// Tempo
+typedef uint64_t absolute_time_t;
+extern const absolute_time_t at_the_end_of_time;
+
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + (uint64_t)ms * 1000; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return delayed_by_ms(time_us_64(), ms); }
+static inline int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate) { return (int64_t)(ate - de); }
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+static inline void tight_loop_contents(void) {}
+
+void stdio_init_all(void);
+void panic(const char *formato, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+// Núcleos
+uint get_core_num(void);
+
+// Sincronização: barreiras reais; __wfe espera um __sev ou uma "interrupção" simulada, com prazo curto
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __compiler_memory_barrier(void) { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+void __wfe(void);
+void __sev(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t estado);
+
+// Interrupções
+enum { DMA_IRQ_0 = 11, DMA_IRQ_1 = 12, IO_IRQ_BANK0 = 13, I2C0_IRQ = 23, I2C1_IRQ = 24 };
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+typedef void (*irq_handler_t)(void);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t prioridade);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool habilitada);
+
+// GPIO
+enum gpio_function { GPIO_FUNC_SIO = 5, GPIO_FUNC_PWM = 4, GPIO_FUNC_I2C = 3, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7, GPIO_FUNC_NULL = 0x1f };
+#define GPIO_IN false
+#define GPIO_OUT true
+enum { GPIO_IRQ_LEVEL_LOW = 1, GPIO_IRQ_LEVEL_HIGH = 2, GPIO_IRQ_EDGE_FALL = 4, GPIO_IRQ_EDGE_RISE = 8 };
+#define NUM_BANK0_GPIOS 30
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t eventos);
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool saida);
+void gpio_put(uint gpio, bool valor);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function funcao);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitada, gpio_irq_callback_t callback);
+
+// PWM
+uint pwm_gpio_to_slice_num(uint gpio);
+void pwm_set_wrap(uint slice, uint16_t wrap);
+void pwm_set_clkdiv(uint slice, float divisor);
+void pwm_set_gpio_level(uint gpio, uint16_t nivel);
+void pwm_set_enabled(uint slice, bool habilitado);
+
+// Clocks
+enum clock_index { clk_gpout0 = 0, clk_ref = 4, clk_sys = 5, clk_peri = 6, clk_usb = 7, clk_adc = 8 };
+uint32_t clock_get_hz(enum clock_index clock);
+
+// ADC: valores definidos pelo cenário, lidos em round-robin pelo DMA simulado
+typedef struct {
+    volatile uint32_t fifo;
+} adc_hw_t;
+extern adc_hw_t adc_hw_host;
+#define adc_hw (&adc_hw_host)
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint entrada);
+void adc_set_round_robin(uint mascara);
+void adc_fifo_setup(bool habilitado, bool dreq, uint16_t limiar, bool erro, bool byte_shift);
+void adc_set_clkdiv(float divisor);
+void adc_run(bool executar);
+uint16_t adc_read(void);
+
+// DMA: transferências executadas por uma thread, no ritmo do periférico que as solicita
+#define NUM_DMA_CHANNELS 12
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+enum { DREQ_PIO0_TX0 = 0, DREQ_PIO1_TX0 = 8, DREQ_I2C0_TX = 32, DREQ_I2C1_TX = 34, DREQ_ADC = 36, DREQ_FORCE = 0x3f };
+typedef struct {
+    uint32_t ctrl;
+    enum dma_channel_transfer_size tamanho;
+    bool incrementa_leitura;
+    bool incrementa_escrita;
+    uint dreq;
+    uint encadeia;
+} dma_channel_config;
+int dma_claim_unused_channel(bool obrigatorio);
+void dma_channel_unclaim(uint canal);
+dma_channel_config dma_channel_get_default_config(uint canal);
+void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size tamanho);
+void channel_config_set_read_increment(dma_channel_config *config, bool incrementa);
+void channel_config_set_write_increment(dma_channel_config *config, bool incrementa);
+void channel_config_set_dreq(dma_channel_config *config, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *config, uint canal);
+void dma_channel_configure(uint canal, const dma_channel_config *config, volatile void *escrita,
+                           const volatile void *leitura, uint32_t contagem, bool inicia);
+void dma_channel_set_write_addr(uint canal, volatile void *escrita, bool inicia);
+void dma_channel_set_read_addr(uint canal, const volatile void *leitura, bool inicia);
+void dma_channel_set_trans_count(uint canal, uint32_t contagem, bool inicia);
+void dma_channel_start(uint canal);
+void dma_channel_transfer_from_buffer_now(uint canal, const volatile void *leitura, uint32_t contagem);
+bool dma_channel_is_busy(uint canal);
+void dma_channel_abort(uint canal);
+void dma_channel_set_irq0_enabled(uint canal, bool habilitada);
+bool dma_channel_get_irq0_status(uint canal);
+void dma_channel_acknowledge_irq0(uint canal);
+
+// I2C: os bytes enviados são capturados e contados. Os registradores clr_* são limpos pela leitura no
+// RP2040; aqui a leitura não tem efeito e a simulação limpa os bits depois de chamar os tratadores
+#define NUM_I2CS 2
+typedef struct {
+    volatile uint32_t enable;
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t status;
+    volatile uint32_t intr_stat;
+    volatile uint32_t intr_mask;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_intr;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t clr_stop_det;
+    volatile uint32_t tx_abrt_source;
+} i2c_hw_t;
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_TAR_IC_TAR_BITS 0x000003ffu
+#define I2C_IC_STATUS_TFE_BITS 0x00000004u
+#define I2C_IC_STATUS_MST_ACTIVITY_BITS 0x00000020u
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_STAT_R_STOP_DET_BITS 0x00000200u
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS 0x00000200u
+#define I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS 0x00000001u
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t tamanho, bool nostop);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_hw_index(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool tx);
+
+// PIO: as palavras escritas no FIFO de transmissão de uma máquina de estados vão para a fita de WS2812
+// simulada no pino dela (src/pio.c); o programa em si não é executado
+#define NUM_PIO_STATE_MACHINES 4
+typedef struct {
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+extern pio_hw_t pio0_hw_host, pio1_hw_host;
+#define pio0 (&pio0_hw_host)
+#define pio1 (&pio1_hw_host)
+typedef struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+bool pio_can_add_program(PIO pio, const pio_program_t *programa);
+uint pio_add_program(PIO pio, const pio_program_t *programa);
+int pio_claim_unused_sm(PIO pio, bool obrigatorio);
+void pio_gpio_init(PIO pio, uint pino);
+void pio_sm_set_enabled(PIO pio, uint sm, bool habilitada);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t dado);
+uint pio_get_dreq(PIO pio, uint sm, bool tx);
+
+// Multicore
+void multicore_launch_core1(void (*entrada)(void));
+void multicore_fifo_push_blocking(uint32_t valor);
+uint32_t multicore_fifo_pop_blocking(void);
+void multicore_lockout_victim_init(void);
+
+// Flash, número aleatório e identificador da placa
+bool flash_safe_execute_core_init(void);
+int flash_safe_execute(void (*funcao)(void *), void *parametro, uint32_t timeout_ms);
+uint32_t get_rand_32(void);
+void pico_get_unique_board_id_string(char *destino, uint tamanho);
+
+#endif
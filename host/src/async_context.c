@@ -0,0 +1,192 @@
+#include <time.h>
+#include "pico/async_context.h"
+#include "pico/async_context_poll.h"
+#include "simulacao.h"
+
+static void sinaliza(async_context_t *context) {
+    pthread_mutex_lock(&context->trava_sinal);
+    context->sinalizado = true;
+    pthread_cond_broadcast(&context->sinal);
+    pthread_mutex_unlock(&context->trava_sinal);
+}
+
+bool async_context_host_init(async_context_t *context) {
+    pthread_mutexattr_t atributos;
+    pthread_mutexattr_init(&atributos);
+    pthread_mutexattr_settype(&atributos, PTHREAD_MUTEX_RECURSIVE);
+    if (pthread_mutex_init(&context->trava, &atributos) != 0) {
+        return false;
+    }
+    pthread_mutex_init(&context->trava_sinal, NULL);
+    pthread_cond_init(&context->sinal, NULL);
+    context->sinalizado = false;
+    context->at_time_workers = NULL;
+    context->when_pending_workers = NULL;
+    context->core_num = get_core_num();
+    return true;
+}
+
+bool async_context_poll_init_with_defaults(async_context_poll_t *self) {
+    return async_context_host_init(&self->core);
+}
+
+void async_context_acquire_lock_blocking(async_context_t *context) {
+    pthread_mutex_lock(&context->trava);
+}
+
+void async_context_release_lock(async_context_t *context) {
+    pthread_mutex_unlock(&context->trava);
+}
+
+static bool remove_at_time(async_context_t *context, async_at_time_worker_t *worker) {
+    for (async_at_time_worker_t **p = &context->at_time_workers; *p; p = &(*p)->next) {
+        if (*p == worker) {
+            *p = worker->next;
+            worker->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool async_context_add_at_time_worker(async_context_t *context, async_at_time_worker_t *worker) {
+    async_context_acquire_lock_blocking(context);
+    remove_at_time(context, worker);
+    async_at_time_worker_t **p = &context->at_time_workers;
+    while (*p && (*p)->next_time <= worker->next_time) {
+        p = &(*p)->next;
+    }
+    worker->next = *p;
+    *p = worker;
+    async_context_release_lock(context);
+    sinaliza(context);
+    return true;
+}
+
+bool async_context_add_at_time_worker_at(async_context_t *context, async_at_time_worker_t *worker, absolute_time_t at) {
+    worker->next_time = at;
+    return async_context_add_at_time_worker(context, worker);
+}
+
+bool async_context_add_at_time_worker_in_ms(async_context_t *context, async_at_time_worker_t *worker, uint32_t ms) {
+    return async_context_add_at_time_worker_at(context, worker, make_timeout_time_ms(ms));
+}
+
+bool async_context_remove_at_time_worker(async_context_t *context, async_at_time_worker_t *worker) {
+    async_context_acquire_lock_blocking(context);
+    bool removido = remove_at_time(context, worker);
+    async_context_release_lock(context);
+    return removido;
+}
+
+bool async_context_add_when_pending_worker(async_context_t *context, async_when_pending_worker_t *worker) {
+    async_context_acquire_lock_blocking(context);
+    for (async_when_pending_worker_t *w = context->when_pending_workers; w; w = w->next) {
+        if (w == worker) {
+            async_context_release_lock(context);
+            return true;
+        }
+    }
+    worker->next = context->when_pending_workers;
+    context->when_pending_workers = worker;
+    async_context_release_lock(context);
+    return true;
+}
+
+bool async_context_remove_when_pending_worker(async_context_t *context, async_when_pending_worker_t *worker) {
+    async_context_acquire_lock_blocking(context);
+    bool removido = false;
+    for (async_when_pending_worker_t **p = &context->when_pending_workers; *p; p = &(*p)->next) {
+        if (*p == worker) {
+            *p = worker->next;
+            removido = true;
+            break;
+        }
+    }
+    async_context_release_lock(context);
+    return removido;
+}
+
+// Pode ser chamada de qualquer thread, inclusive das "interrupções" simuladas, sem tomar o lock do contexto
+void async_context_set_work_pending(async_context_t *context, async_when_pending_worker_t *worker) {
+    worker->work_pending = true;
+    __dmb();
+    sinaliza(context);
+}
+
+void async_context_poll(async_context_t *context) {
+    async_context_acquire_lock_blocking(context);
+    bool executou;
+    do {
+        executou = false;
+        for (async_when_pending_worker_t *w = context->when_pending_workers; w; w = w->next) {
+            if (w->work_pending) {
+                w->work_pending = false;
+                w->do_work(context, w);
+                executou = true;
+                break; // A lista pode ter mudado
+            }
+        }
+        async_at_time_worker_t *worker = context->at_time_workers;
+        if (!executou && worker && worker->next_time <= get_absolute_time()) {
+            context->at_time_workers = worker->next;
+            worker->next = NULL;
+            worker->do_work(context, worker);
+            executou = true;
+        }
+    } while (executou);
+    async_context_release_lock(context);
+}
+
+static bool tem_pendente(async_context_t *context) {
+    for (async_when_pending_worker_t *w = context->when_pending_workers; w; w = w->next) {
+        if (w->work_pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void async_context_wait_for_work_until(async_context_t *context, absolute_time_t until) {
+    async_context_acquire_lock_blocking(context);
+    if (context->at_time_workers && context->at_time_workers->next_time < until) {
+        until = context->at_time_workers->next_time;
+    }
+    bool pendente = tem_pendente(context);
+    async_context_release_lock(context);
+    if (pendente) {
+        return;
+    }
+
+    pthread_mutex_lock(&context->trava_sinal);
+    if (until != at_the_end_of_time) {
+        // Converte o prazo do relógio monotônico para o relógio usado pela condição
+        struct timespec prazo;
+        clock_gettime(CLOCK_REALTIME, &prazo);
+        int64_t restante = absolute_time_diff_us(get_absolute_time(), until);
+        if (restante < 0) {
+            restante = 0;
+        }
+        prazo.tv_sec += restante / 1000000;
+        prazo.tv_nsec += (restante % 1000000) * 1000;
+        if (prazo.tv_nsec >= 1000000000) {
+            prazo.tv_sec++;
+            prazo.tv_nsec -= 1000000000;
+        }
+        while (!context->sinalizado) {
+            if (pthread_cond_timedwait(&context->sinal, &context->trava_sinal, &prazo) != 0) {
+                break;
+            }
+        }
+    } else {
+        while (!context->sinalizado) {
+            pthread_cond_wait(&context->sinal, &context->trava_sinal);
+        }
+    }
+    context->sinalizado = false;
+    pthread_mutex_unlock(&context->trava_sinal);
+}
+
+void async_context_wait_for_work_ms(async_context_t *context, uint32_t ms) {
+    async_context_wait_for_work_until(context, make_timeout_time_ms(ms));
+}
@@ -0,0 +1,257 @@
+#include <pthread.h>
+#include "simulacao.h"
+#include "perifericos.h"
+#include "aquisicao.h"
+#include "comandos.h"
+#include "matriz.h"
+#include "lwip/apps/mqtt.h"
+
+// Cenário da simulação, repetido a cada CENARIO_CICLO_S segundos:
+//   0 s  sinais normais (36,5 °C, 75 bpm)
+//   3 s  febre (39 °C), que dispara o alarme médico
+//   10 s sinais normais de novo
+//   16 s botão A pressionado (alarme manual) e 18 s pressionado de novo
+// Em paralelo, comandos chegam pelo broker: /ping aos 5 s; aos 6 s a faixa de temperatura padrão em uma
+// mensagem longa o bastante para ser entregue em pedaços; aos 7 s um /print maior que COMANDOS_DADOS_MAX,
+// que deve ser descartado; e /print aos 12 s. Se SIM_QUEDA_S não for 0, o broker fica fora do ar por 3 s
+// nesse instante. Aos 2 s e aos 9 s o quadro da matriz de LEDs é conferido com o LED vermelho e com a
+// temperatura simulada. A publicação de /alarme do toque dos 16 s é recusada pelo lwIP e a dos 18 s se
+// perde sem PUBACK; aos 17 s e aos 19,5 s a mensagem retida em /alarme é conferida com o LED vermelho. Um
+// quadro divergente, uma palavra fora do formato do PIO ou um /alarme retido divergente encerra a simulação
+// com erro. Ao fim de SIM_DURACAO_S segundos o cenário publica /exit e a aplicação encerra; um resumo é
+// impresso na saída.
+
+#define CENARIO_CICLO_S 20
+#define CENARIO_PASSO_MS 10
+#define CENARIO_QUEDA_MS 3000
+#define CENARIO_ENCERRAMENTO_MS 5000
+
+#ifndef SIM_PREFIXO_TOPICO
+#define SIM_PREFIXO_TOPICO "" // Com MQTT_UNIQUE_TOPIC, o nome do cliente ("/picoe661")
+#endif
+
+// Valores do ADC para as grandezas simuladas, pelas mesmas retas de sinais.c
+#define ADC_TEMPERATURA(c10) (16 + ((c10) - 260) * 4065 / 200)
+#define ADC_BATIMENTO(bpm) (16 + ((bpm) - 40) * 4065 / 80)
+
+static struct {
+    uint32_t duracao_s;
+    uint32_t queda_s;
+    uint32_t botao;
+    uint32_t buzzer;
+    uint32_t led_vermelho;
+    uint32_t led_verde;
+    uint32_t conferencias_matriz;
+    uint32_t divergencias_matriz;
+    uint32_t conferencias_alarme;
+    uint32_t divergencias_alarme;
+} cenario;
+
+static uint32_t variavel(const char *nome, uint32_t padrao) {
+    const char *valor = getenv(nome);
+    return valor && *valor ? (uint32_t)strtoul(valor, NULL, 10) : padrao;
+}
+
+// Faixa de temperatura padrão com espaços entre os números, maior que um pedaço de MQTT_VAR_HEADER_BUFFER_LEN
+static void comando_fragmentado(void) {
+    char dados[2 * MQTT_VAR_HEADER_BUFFER_LEN + 16];
+    snprintf(dados, sizeof(dados), "34.00,%*s37.00", MQTT_VAR_HEADER_BUFFER_LEN, "");
+    broker_host_publica(SIM_PREFIXO_TOPICO "/comando/temperatura", dados);
+}
+
+static void comando_excedido(void) {
+    char dados[COMANDOS_DADOS_MAX + 64];
+    memset(dados, 'x', sizeof(dados) - 1);
+    dados[sizeof(dados) - 1] = '\0';
+    broker_host_publica(SIM_PREFIXO_TOPICO "/print", dados);
+}
+
+static void sinais_normais(void) {
+    host_adc_define(AQ_CANAL_TEMPERATURA, ADC_TEMPERATURA(365));
+    host_adc_define(AQ_CANAL_BATIMENTO, ADC_BATIMENTO(75));
+}
+
+static void pressiona_botao(void) {
+    cenario.botao++;
+    host_gpio_entrada(BOTAO_A, false);
+    sleep_ms(100);
+    host_gpio_entrada(BOTAO_A, true);
+}
+
+// Conta as bordas de subida de uma saída
+static void observa(bool atual, bool *anterior, uint32_t *contador) {
+    if (atual && !*anterior) {
+        (*contador)++;
+    }
+    *anterior = atual;
+}
+
+// Cor de um LED da matriz pelo componente aceso: 'r', 'g', 'b' ou 0 apagado ('?' para misturas)
+static char cor_led(uint32_t palavra) {
+    uint8_t g = (uint8_t)(palavra >> 24), r = (uint8_t)(palavra >> 16), b = (uint8_t)(palavra >> 8);
+    if (!r && !g && !b) {
+        return 0;
+    }
+    if (r && !g && !b) {
+        return 'r';
+    }
+    if (g && !r && !b) {
+        return 'g';
+    }
+    return b && !r && !g ? 'b' : '?';
+}
+
+// Confere o último quadro travado pela fita: primeira linha vermelha com o LED vermelho aceso e verde sem
+// ele; coluna da temperatura cheia e vermelha na febre, verde e sem chegar ao topo com a temperatura normal;
+// batimento normal, verde, com o LED de baixo aceso e o do topo apagado
+static void confere_matriz(bool febre) {
+    uint32_t quadro[MATRIZ_LEDS];
+    uint tamanho = 0;
+    cenario.conferencias_matriz++;
+    if (!host_pio_quadro(MATRIZ_PIN, quadro, MATRIZ_LEDS, &tamanho) || tamanho != MATRIZ_LEDS) {
+        printf("Cenario: matriz sem quadro completo (%u palavras)\n", tamanho);
+        cenario.divergencias_matriz++;
+        return;
+    }
+    char estado = host_gpio_saida(LED_PIN_RED) ? 'r' : 'g';
+    bool confere = true;
+    for (uint8_t x = 0; x < MATRIZ_LADO; x++) {
+        confere = confere && cor_led(quadro[matriz_indice(x, 0)]) == estado;
+    }
+    confere = confere && cor_led(quadro[matriz_indice(0, MATRIZ_LADO - 1)]) == (febre ? 'r' : 'g');
+    confere = confere && cor_led(quadro[matriz_indice(0, 1)]) == (febre ? 'r' : 0);
+    confere = confere && cor_led(quadro[matriz_indice(MATRIZ_LADO - 1, MATRIZ_LADO - 1)]) == 'g';
+    confere = confere && cor_led(quadro[matriz_indice(MATRIZ_LADO - 1, 1)]) == 0;
+    if (!confere) {
+        printf("Cenario: quadro da matriz divergente (alarme %s, %s)\n", estado == 'r' ? "ativo" : "inativo",
+               febre ? "febre" : "sinais normais");
+        cenario.divergencias_matriz++;
+    }
+}
+
+// O estado retido no broker deve acompanhar o LED vermelho mesmo com publicações recusadas ou perdidas
+static void confere_alarme_retido(void) {
+    char retido[8];
+    broker_host_retido(SIM_PREFIXO_TOPICO "/alarme", retido, sizeof(retido));
+    const char *esperado = host_gpio_saida(LED_PIN_RED) ? "1" : "0";
+    cenario.conferencias_alarme++;
+    if (strcmp(retido, esperado) != 0) {
+        printf("Cenario: /alarme retido \"%s\", esperado \"%s\"\n", retido, esperado);
+        cenario.divergencias_alarme++;
+    }
+}
+
+static void resumo(void) {
+    uint32_t transacoes, bytes, quadros, invalidas;
+    host_i2c_estatisticas(&transacoes, &bytes);
+    host_pio_estatisticas(MATRIZ_PIN, &quadros, &invalidas);
+    printf("\nResumo da simulacao (%lu s)\n", (unsigned long)(time_us_64() / 1000000));
+    printf("Entradas: %lu toques no botao A\n", (unsigned long)cenario.botao);
+    printf("Saidas: buzzer acionado %lu vezes, LED vermelho %lu vezes, LED verde %lu vezes\n",
+           (unsigned long)cenario.buzzer, (unsigned long)cenario.led_vermelho, (unsigned long)cenario.led_verde);
+    printf("I2C: %lu transacoes, %lu bytes\n", (unsigned long)transacoes, (unsigned long)bytes);
+    printf("Matriz: %lu quadros, %lu palavras fora do formato, %lu de %lu conferencias divergentes\n",
+           (unsigned long)quadros, (unsigned long)invalidas, (unsigned long)cenario.divergencias_matriz,
+           (unsigned long)cenario.conferencias_matriz);
+    printf("Alarme retido: %lu de %lu conferencias divergentes\n", (unsigned long)cenario.divergencias_alarme,
+           (unsigned long)cenario.conferencias_alarme);
+    broker_host_resumo();
+}
+
+static void *executa_cenario(void *arg) {
+    (void)arg;
+    host_define_nucleo(0);
+    uint32_t passos_ciclo = CENARIO_CICLO_S * 1000 / CENARIO_PASSO_MS;
+    uint32_t passos_total = cenario.duracao_s * 1000 / CENARIO_PASSO_MS;
+    bool buzzer = false, vermelho = false, verde = false;
+    absolute_time_t proximo = get_absolute_time();
+
+    for (uint32_t passo = 0; passo < passos_total; passo++) {
+        uint32_t ms = (passo % passos_ciclo) * CENARIO_PASSO_MS;
+        switch (ms) {
+        case 0:
+            sinais_normais();
+            break;
+        case 2000:
+            confere_matriz(false);
+            break;
+        case 3000:
+            host_adc_define(AQ_CANAL_TEMPERATURA, ADC_TEMPERATURA(390));
+            break;
+        case 5000:
+            broker_host_publica(SIM_PREFIXO_TOPICO "/ping", "");
+            break;
+        case 6000:
+            comando_fragmentado();
+            break;
+        case 7000:
+            comando_excedido();
+            break;
+        case 9000:
+            confere_matriz(true);
+            break;
+        case 10000:
+            sinais_normais();
+            break;
+        case 12000:
+            broker_host_publica(SIM_PREFIXO_TOPICO "/print", "simulacao");
+            break;
+        case 15950:
+            broker_host_falha(SIM_PREFIXO_TOPICO "/alarme", BROKER_RECUSA);
+            break;
+        case 17950:
+            broker_host_falha(SIM_PREFIXO_TOPICO "/alarme", BROKER_PERDE);
+            break;
+        case 16000:
+        case 18000:
+            pressiona_botao();
+            break;
+        case 17000:
+        case 19500:
+            confere_alarme_retido();
+            break;
+        }
+        if (cenario.queda_s && passo == cenario.queda_s * 1000 / CENARIO_PASSO_MS) {
+            printf("Cenario: broker fora do ar por %u ms\n", CENARIO_QUEDA_MS);
+            broker_host_queda(CENARIO_QUEDA_MS);
+        }
+
+        observa(host_pwm_ativo(BUZZER_A), &buzzer, &cenario.buzzer);
+        observa(host_gpio_saida(LED_PIN_RED), &vermelho, &cenario.led_vermelho);
+        observa(host_gpio_saida(LED_PIN_GREEN), &verde, &cenario.led_verde);
+
+        proximo = delayed_by_ms(proximo, CENARIO_PASSO_MS);
+        sleep_until(proximo);
+    }
+
+    uint32_t quadros, invalidas;
+    host_pio_estatisticas(MATRIZ_PIN, &quadros, &invalidas);
+    if (cenario.divergencias_matriz || invalidas) {
+        fprintf(stderr, "LED matrix check failed: %lu mismatched frames, %lu malformed words\n",
+                (unsigned long)cenario.divergencias_matriz, (unsigned long)invalidas);
+        exit(1);
+    }
+    if (cenario.divergencias_alarme) {
+        fprintf(stderr, "Retained alarm check failed: %lu mismatches\n", (unsigned long)cenario.divergencias_alarme);
+        exit(1);
+    }
+
+    broker_host_publica(SIM_PREFIXO_TOPICO "/exit", "");
+    sleep_ms(CENARIO_ENCERRAMENTO_MS);
+    fprintf(stderr, "Simulation did not exit after /exit\n");
+    exit(1);
+    return NULL;
+}
+
+void cenario_inicia(void) {
+    cenario.duracao_s = variavel("SIM_DURACAO_S", 60);
+    cenario.queda_s = variavel("SIM_QUEDA_S", 30);
+    sinais_normais();
+    atexit(resumo);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, executa_cenario, NULL) != 0) {
+        panic("Failed to start scenario thread");
+    }
+    pthread_detach(thread);
+}
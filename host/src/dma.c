@@ -0,0 +1,503 @@
+#include <pthread.h>
+#include "pico_host.h"
+#include "simulacao.h"
+
+// DMA, ADC e I2C simulados. Uma thread avança as transferências no ritmo de cada DREQ: uma conversão do
+// ADC a cada (clkdiv + 1) ciclos de 48 MHz, um byte do I2C a cada 9 bits na taxa configurada e uma palavra
+// de uma máquina de estados do PIO a cada HOST_PIO_PALAVRA_NS (24 bits para a fita de WS2812). O fim de
+// um bloco reproduz o hardware: marca a interrupção, inicia o canal encadeado e chama os tratadores de
+// DMA_IRQ_0 no núcleo que habilitou a interrupção. No I2C, cada STOP marca STOP_DET e um alvo sem ACK
+// aborta a transmissão (TX_ABRT) e para o DREQ até o aborto ser limpo; os eventos habilitados em intr_mask
+// chamam os tratadores de I2Cn_IRQ.
+
+#define DMA_PASSO_US 500
+
+typedef struct {
+    bool reservado;
+    dma_channel_config config;
+    volatile void *escrita;
+    const volatile void *leitura;
+    uint32_t contagem;   // Recarregada a cada início, como TRANS_COUNT
+    uint32_t restantes;
+    bool ocupado;
+    bool irq0_habilitada;
+    bool irq0_status;
+    uint64_t credito_ns; // Tempo acumulado para o DREQ do canal
+} canal_t;
+
+static canal_t canais[NUM_DMA_CHANNELS];
+static pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t thread_dma;
+static bool thread_iniciada;
+
+// ADC
+
+adc_hw_t adc_hw_host;
+
+static struct {
+    uint16_t valores[5];
+    uint selecionado;
+    uint mascara;
+    float divisor;
+    bool executando;
+} adc = { .valores = { 2048, 2048, 2048, 2048, 876 }, .divisor = 0 };
+
+void adc_init(void) {
+    adc.selecionado = 0;
+    adc.mascara = 0;
+    adc.executando = false;
+}
+
+void adc_gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void adc_select_input(uint entrada) {
+    adc.selecionado = entrada;
+}
+
+void adc_set_round_robin(uint mascara) {
+    adc.mascara = mascara;
+}
+
+void adc_fifo_setup(bool habilitado, bool dreq, uint16_t limiar, bool erro, bool byte_shift) {
+    (void)habilitado;
+    (void)dreq;
+    (void)limiar;
+    (void)erro;
+    (void)byte_shift;
+}
+
+void adc_set_clkdiv(float divisor) {
+    adc.divisor = divisor;
+}
+
+void adc_run(bool executar) {
+    adc.executando = executar;
+}
+
+void host_adc_define(uint canal, uint16_t valor) {
+    adc.valores[canal] = valor;
+}
+
+uint32_t host_adc_taxa_hz(void) {
+    uint32_t ciclos = (uint32_t)adc.divisor + 1;
+    return 48000000u / (ciclos < 96 ? 96 : ciclos);
+}
+
+// Converte a entrada atual com um ruído de ±4 LSB e avança o round-robin
+uint16_t host_adc_converte(void) {
+    int32_t valor = adc.valores[adc.selecionado] + (int32_t)(get_rand_32() % 9) - 4;
+    if (valor < 0) {
+        valor = 0;
+    } else if (valor > 4095) {
+        valor = 4095;
+    }
+    if (adc.mascara) {
+        do {
+            adc.selecionado = (adc.selecionado + 1) % 5;
+        } while (!(adc.mascara & (1u << adc.selecionado)));
+    }
+    return (uint16_t)valor;
+}
+
+uint16_t adc_read(void) {
+    return host_adc_converte();
+}
+
+// I2C
+
+struct i2c_inst {
+    i2c_hw_t hw;
+    uint baudrate;
+    bool nack;       // O alvo não responde com ACK
+    bool preso;      // O alvo segura o SCL
+    bool abortado;   // Transmissão abortada, com o FIFO descartando dados até a limpeza do aborto
+};
+
+i2c_inst_t i2c0_inst, i2c1_inst;
+
+static struct {
+    uint32_t transacoes;
+    uint32_t bytes;
+} i2c_estatisticas;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    i2c->hw.enable = 1;
+    i2c->hw.status = I2C_IC_STATUS_TFE_BITS;
+    return baudrate;
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+    return &i2c->hw;
+}
+
+uint i2c_hw_index(i2c_inst_t *i2c) {
+    return i2c == i2c0 ? 0 : 1;
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool tx) {
+    (void)tx;
+    return i2c == i2c0 ? DREQ_I2C0_TX : DREQ_I2C1_TX;
+}
+
+void host_i2c_captura(uint16_t palavra) {
+    __atomic_add_fetch(&i2c_estatisticas.bytes, 1, __ATOMIC_RELAXED);
+    if (palavra & I2C_IC_DATA_CMD_STOP_BITS) {
+        __atomic_add_fetch(&i2c_estatisticas.transacoes, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void host_i2c_estatisticas(uint32_t *transacoes, uint32_t *bytes) {
+    *transacoes = __atomic_load_n(&i2c_estatisticas.transacoes, __ATOMIC_RELAXED);
+    *bytes = __atomic_load_n(&i2c_estatisticas.bytes, __ATOMIC_RELAXED);
+}
+
+void host_i2c_nack(i2c_inst_t *i2c, bool nack) {
+    pthread_mutex_lock(&trava);
+    i2c->nack = nack;
+    pthread_mutex_unlock(&trava);
+}
+
+void host_i2c_preso(i2c_inst_t *i2c, bool preso) {
+    pthread_mutex_lock(&trava);
+    i2c->preso = preso;
+    pthread_mutex_unlock(&trava);
+}
+
+// Um byte entregue pelo DMA ao FIFO de transmissão
+static void i2c_transmite(i2c_inst_t *i2c, uint16_t palavra) {
+    if (i2c->nack) {
+        i2c->abortado = true;
+        i2c->hw.tx_abrt_source = I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS;
+        i2c->hw.raw_intr_stat |= I2C_IC_INTR_STAT_R_TX_ABRT_BITS;
+        i2c->hw.status = I2C_IC_STATUS_TFE_BITS;
+        return;
+    }
+    host_i2c_captura(palavra);
+    if (palavra & I2C_IC_DATA_CMD_STOP_BITS) {
+        i2c->hw.raw_intr_stat |= I2C_IC_INTR_STAT_R_STOP_DET_BITS;
+    }
+}
+
+// Chama os tratadores de I2Cn_IRQ para os eventos habilitados e faz a limpeza que, no RP2040, a leitura
+// de clr_stop_det e clr_tx_abrt faria
+static void i2c_interrompe(i2c_inst_t *i2c) {
+    pthread_mutex_lock(&trava);
+    uint32_t pendentes = i2c->hw.raw_intr_stat & i2c->hw.intr_mask;
+    i2c->hw.intr_stat = pendentes;
+    pthread_mutex_unlock(&trava);
+    if (!pendentes) {
+        return;
+    }
+    host_irq_dispara(I2C0_IRQ + i2c_hw_index(i2c));
+    pthread_mutex_lock(&trava);
+    i2c->hw.raw_intr_stat &= ~pendentes;
+    i2c->hw.intr_stat = 0;
+    if (pendentes & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        i2c->hw.tx_abrt_source = 0;
+        i2c->abortado = false;
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+// Tempo de um byte no barramento: 8 bits de dados e o ACK
+static uint64_t i2c_byte_ns(const i2c_inst_t *i2c) {
+    return 9ull * 1000000000ull / (i2c->baudrate ? i2c->baudrate : 100000);
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t tamanho, bool nostop) {
+    i2c->hw.tar = endereco;
+    if (i2c->nack) {
+        sleep_us(2 * i2c_byte_ns(i2c) / 1000);
+        return PICO_ERROR_GENERIC;
+    }
+    for (size_t i = 0; i < tamanho; i++) {
+        bool ultimo = i + 1 == tamanho && !nostop;
+        host_i2c_captura(dados[i] | (ultimo ? I2C_IC_DATA_CMD_STOP_BITS : 0));
+    }
+    sleep_us((tamanho + 1) * i2c_byte_ns(i2c) / 1000);
+    return (int)tamanho;
+}
+
+// DMA
+
+static i2c_inst_t *i2c_do_dreq(uint dreq) {
+    if (dreq == DREQ_I2C0_TX) {
+        return i2c0;
+    }
+    if (dreq == DREQ_I2C1_TX) {
+        return i2c1;
+    }
+    return NULL;
+}
+
+// DREQ de transmissão de uma máquina de estados do PIO
+static bool dreq_pio(uint dreq) {
+    return dreq < DREQ_PIO1_TX0 + NUM_PIO_STATE_MACHINES && dreq % DREQ_PIO1_TX0 < NUM_PIO_STATE_MACHINES;
+}
+
+// Intervalo entre duas transferências do canal, em nanossegundos (0 para DREQ_FORCE)
+static uint64_t intervalo_ns(const canal_t *canal) {
+    if (canal->config.dreq == DREQ_ADC) {
+        return adc.executando ? 1000000000ull / host_adc_taxa_hz() : UINT64_MAX;
+    }
+    i2c_inst_t *i2c = i2c_do_dreq(canal->config.dreq);
+    if (i2c) {
+        return i2c->preso || i2c->abortado ? UINT64_MAX : i2c_byte_ns(i2c);
+    }
+    if (dreq_pio(canal->config.dreq)) {
+        return HOST_PIO_PALAVRA_NS;
+    }
+    return 0;
+}
+
+// Uma transferência, feita no instante instante_us do DREQ
+static void transfere(canal_t *canal, uint64_t instante_us) {
+    uint32_t valor;
+    uint tamanho = 1u << canal->config.tamanho;
+    if (canal->config.dreq == DREQ_ADC) {
+        valor = host_adc_converte();
+    } else if (tamanho == 1) {
+        valor = *(const volatile uint8_t *)canal->leitura;
+    } else if (tamanho == 2) {
+        valor = *(const volatile uint16_t *)canal->leitura;
+    } else {
+        valor = *(const volatile uint32_t *)canal->leitura;
+    }
+
+    i2c_inst_t *i2c = i2c_do_dreq(canal->config.dreq);
+    if (i2c) {
+        i2c_transmite(i2c, (uint16_t)valor);
+    } else if (dreq_pio(canal->config.dreq)) {
+        host_pio_captura(canal->config.dreq, valor, instante_us);
+    } else if (tamanho == 1) {
+        *(volatile uint8_t *)canal->escrita = (uint8_t)valor;
+    } else if (tamanho == 2) {
+        *(volatile uint16_t *)canal->escrita = (uint16_t)valor;
+    } else {
+        *(volatile uint32_t *)canal->escrita = valor;
+    }
+
+    if (canal->config.incrementa_leitura) {
+        canal->leitura = (const volatile uint8_t *)canal->leitura + tamanho;
+    }
+    if (canal->config.incrementa_escrita) {
+        canal->escrita = (volatile uint8_t *)canal->escrita + tamanho;
+    }
+    canal->restantes--;
+}
+
+static void inicia_canal(uint numero) {
+    canal_t *canal = &canais[numero];
+    canal->restantes = canal->contagem;
+    canal->credito_ns = 0;
+    canal->ocupado = canal->restantes > 0;
+    i2c_inst_t *i2c = i2c_do_dreq(canal->config.dreq);
+    if (i2c && canal->ocupado) {
+        i2c->hw.status = I2C_IC_STATUS_MST_ACTIVITY_BITS;
+    }
+}
+
+static void *executa_dma(void *arg) {
+    (void)arg;
+    uint64_t anterior = time_us_64();
+    for (;;) {
+        sleep_us(DMA_PASSO_US);
+        uint64_t agora = time_us_64();
+        uint64_t decorrido_ns = (agora - anterior) * 1000;
+        anterior = agora;
+
+        bool interrupcao = false;
+        pthread_mutex_lock(&trava);
+        for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+            canal_t *canal = &canais[i];
+            if (!canal->ocupado) {
+                continue;
+            }
+            uint64_t intervalo = intervalo_ns(canal);
+            if (intervalo == UINT64_MAX) {
+                continue;
+            }
+            canal->credito_ns += decorrido_ns;
+            while (canal->ocupado && canal->credito_ns >= intervalo && intervalo_ns(canal) != UINT64_MAX) {
+                canal->credito_ns -= intervalo;
+                transfere(canal, agora - canal->credito_ns / 1000);
+                if (canal->restantes > 0) {
+                    continue;
+                }
+                canal->ocupado = false;
+                i2c_inst_t *i2c = i2c_do_dreq(canal->config.dreq);
+                if (i2c) {
+                    i2c->hw.status = I2C_IC_STATUS_TFE_BITS;
+                }
+                if (canal->irq0_habilitada) {
+                    canal->irq0_status = true;
+                    interrupcao = true;
+                }
+                if (canal->config.encadeia != i) {
+                    inicia_canal(canal->config.encadeia);
+                }
+            }
+        }
+        pthread_mutex_unlock(&trava);
+
+        // Os tratadores reprogramam os canais, então rodam sem a trava do DMA
+        if (interrupcao) {
+            host_irq_dispara(DMA_IRQ_0);
+        }
+        i2c_interrompe(i2c0);
+        i2c_interrompe(i2c1);
+    }
+    return NULL;
+}
+
+int dma_claim_unused_channel(bool obrigatorio) {
+    pthread_mutex_lock(&trava);
+    if (!thread_iniciada) {
+        if (pthread_create(&thread_dma, NULL, executa_dma, NULL) != 0) {
+            panic("Failed to start DMA thread");
+        }
+        pthread_detach(thread_dma);
+        thread_iniciada = true;
+    }
+    int livre = -1;
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!canais[i].reservado) {
+            canais[i] = (canal_t){ .reservado = true };
+            livre = (int)i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&trava);
+    if (livre < 0 && obrigatorio) {
+        panic("No DMA channels are available");
+    }
+    return livre;
+}
+
+void dma_channel_unclaim(uint canal) {
+    pthread_mutex_lock(&trava);
+    canais[canal].reservado = false;
+    canais[canal].ocupado = false;
+    pthread_mutex_unlock(&trava);
+}
+
+dma_channel_config dma_channel_get_default_config(uint canal) {
+    return (dma_channel_config){
+        .tamanho = DMA_SIZE_32,
+        .incrementa_leitura = true,
+        .incrementa_escrita = false,
+        .dreq = DREQ_FORCE,
+        .encadeia = canal,
+    };
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size tamanho) {
+    config->tamanho = tamanho;
+}
+
+void channel_config_set_read_increment(dma_channel_config *config, bool incrementa) {
+    config->incrementa_leitura = incrementa;
+}
+
+void channel_config_set_write_increment(dma_channel_config *config, bool incrementa) {
+    config->incrementa_escrita = incrementa;
+}
+
+void channel_config_set_dreq(dma_channel_config *config, uint dreq) {
+    config->dreq = dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *config, uint canal) {
+    config->encadeia = canal;
+}
+
+void dma_channel_configure(uint numero, const dma_channel_config *config, volatile void *escrita,
+                           const volatile void *leitura, uint32_t contagem, bool inicia) {
+    pthread_mutex_lock(&trava);
+    canal_t *canal = &canais[numero];
+    canal->config = *config;
+    canal->escrita = escrita;
+    canal->leitura = leitura;
+    canal->contagem = contagem;
+    if (inicia) {
+        inicia_canal(numero);
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+void dma_channel_set_write_addr(uint numero, volatile void *escrita, bool inicia) {
+    pthread_mutex_lock(&trava);
+    canais[numero].escrita = escrita;
+    if (inicia) {
+        inicia_canal(numero);
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+void dma_channel_set_read_addr(uint numero, const volatile void *leitura, bool inicia) {
+    pthread_mutex_lock(&trava);
+    canais[numero].leitura = leitura;
+    if (inicia) {
+        inicia_canal(numero);
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+void dma_channel_set_trans_count(uint numero, uint32_t contagem, bool inicia) {
+    pthread_mutex_lock(&trava);
+    canais[numero].contagem = contagem;
+    if (inicia) {
+        inicia_canal(numero);
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+void dma_channel_start(uint numero) {
+    pthread_mutex_lock(&trava);
+    inicia_canal(numero);
+    pthread_mutex_unlock(&trava);
+}
+
+void dma_channel_transfer_from_buffer_now(uint numero, const volatile void *leitura, uint32_t contagem) {
+    pthread_mutex_lock(&trava);
+    canais[numero].leitura = leitura;
+    canais[numero].contagem = contagem;
+    inicia_canal(numero);
+    pthread_mutex_unlock(&trava);
+}
+
+bool dma_channel_is_busy(uint numero) {
+    pthread_mutex_lock(&trava);
+    bool ocupado = canais[numero].ocupado;
+    pthread_mutex_unlock(&trava);
+    return ocupado;
+}
+
+// Sem novos bytes do canal, o FIFO do I2C fica vazio: o que restava foi descartado pelo aborto da
+// transmissão ou pela desabilitação do controlador que segue o cancelamento
+void dma_channel_abort(uint numero) {
+    pthread_mutex_lock(&trava);
+    canal_t *canal = &canais[numero];
+    canal->ocupado = false;
+    canal->restantes = 0;
+    i2c_inst_t *i2c = i2c_do_dreq(canal->config.dreq);
+    if (i2c) {
+        i2c->hw.status = I2C_IC_STATUS_TFE_BITS;
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+void dma_channel_set_irq0_enabled(uint numero, bool habilitada) {
+    canais[numero].irq0_habilitada = habilitada;
+}
+
+bool dma_channel_get_irq0_status(uint numero) {
+    return canais[numero].irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint numero) {
+    canais[numero].irq0_status = false;
+}
@@ -0,0 +1,374 @@
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include "pico_host.h"
+#include "simulacao.h"
+
+const absolute_time_t at_the_end_of_time = INT64_MAX;
+
+// Tempo: relógio monotônico a partir do início do processo
+
+static uint64_t relogio_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint64_t inicio_us;
+
+__attribute__((constructor)) static void hal_inicia(void) {
+    inicio_us = relogio_us();
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+uint64_t time_us_64(void) {
+    return relogio_us() - inicio_us;
+}
+
+void sleep_us(uint64_t us) {
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+    while (nanosleep(&ts, &ts) != 0) {
+    }
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+    uint64_t agora = time_us_64();
+    if (t > agora) {
+        sleep_us(t - agora);
+    }
+}
+
+void stdio_init_all(void) {
+    cenario_inicia();
+}
+
+void panic(const char *formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    fputs("*** PANIC ***\n", stderr);
+    vfprintf(stderr, formato, args);
+    fputc('\n', stderr);
+    va_end(args);
+    exit(2);
+}
+
+// Núcleos e espera por eventos
+
+static __thread uint nucleo_atual;
+
+uint get_core_num(void) {
+    return nucleo_atual;
+}
+
+void host_define_nucleo(uint nucleo) {
+    nucleo_atual = nucleo;
+}
+
+static pthread_mutex_t trava_evento = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sinal_evento = PTHREAD_COND_INITIALIZER;
+static uint32_t eventos;
+
+// O prazo curto cobre os pontos da simulação que mudam estado sem chamar host_acorda
+void __wfe(void) {
+    pthread_mutex_lock(&trava_evento);
+    uint32_t visto = eventos;
+    struct timespec prazo;
+    clock_gettime(CLOCK_REALTIME, &prazo);
+    prazo.tv_nsec += 10 * 1000000;
+    if (prazo.tv_nsec >= 1000000000) {
+        prazo.tv_sec++;
+        prazo.tv_nsec -= 1000000000;
+    }
+    while (eventos == visto) {
+        if (pthread_cond_timedwait(&sinal_evento, &trava_evento, &prazo) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&trava_evento);
+}
+
+void __sev(void) {
+    host_acorda();
+}
+
+void host_acorda(void) {
+    pthread_mutex_lock(&trava_evento);
+    eventos++;
+    pthread_cond_broadcast(&sinal_evento);
+    pthread_mutex_unlock(&trava_evento);
+}
+
+// Interrupções: cada núcleo tem uma trava, mantida durante os tratadores e por save_and_disable_interrupts
+
+static pthread_mutex_t trava_irq[2];
+
+__attribute__((constructor)) static void irq_inicia(void) {
+    pthread_mutexattr_t atributos;
+    pthread_mutexattr_init(&atributos);
+    pthread_mutexattr_settype(&atributos, PTHREAD_MUTEX_RECURSIVE);
+    for (int i = 0; i < 2; i++) {
+        pthread_mutex_init(&trava_irq[i], &atributos);
+    }
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    pthread_mutex_lock(&trava_irq[get_core_num()]);
+    return 0;
+}
+
+void restore_interrupts(uint32_t estado) {
+    (void)estado;
+    pthread_mutex_unlock(&trava_irq[get_core_num()]);
+}
+
+#define IRQ_NUMEROS 32
+#define IRQ_TRATADORES 4
+
+typedef struct {
+    irq_handler_t tratadores[IRQ_TRATADORES];
+    uint8_t quantidade;
+    bool habilitada;
+    uint nucleo;
+} irq_t;
+
+static irq_t irqs[IRQ_NUMEROS];
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t prioridade) {
+    (void)prioridade;
+    irq_t *irq = &irqs[num];
+    for (uint8_t i = 0; i < irq->quantidade; i++) {
+        if (irq->tratadores[i] == handler) {
+            return;
+        }
+    }
+    if (irq->quantidade == IRQ_TRATADORES) {
+        panic("Too many handlers for IRQ %u", num);
+    }
+    irq->tratadores[irq->quantidade++] = handler;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    irqs[num].tratadores[0] = handler;
+    irqs[num].quantidade = 1;
+}
+
+void irq_set_enabled(uint num, bool habilitada) {
+    irqs[num].nucleo = get_core_num();
+    irqs[num].habilitada = habilitada;
+}
+
+void host_irq_dispara(uint num) {
+    irq_t *irq = &irqs[num];
+    if (!irq->habilitada) {
+        return;
+    }
+    uint anterior = get_core_num();
+    host_define_nucleo(irq->nucleo);
+    pthread_mutex_lock(&trava_irq[irq->nucleo]);
+    for (uint8_t i = 0; i < irq->quantidade; i++) {
+        irq->tratadores[i]();
+    }
+    pthread_mutex_unlock(&trava_irq[irq->nucleo]);
+    host_define_nucleo(anterior);
+    host_acorda();
+}
+
+// GPIO e PWM
+
+typedef struct {
+    bool saida;
+    bool nivel;
+    bool pull_up;
+    enum gpio_function funcao;
+    uint32_t eventos_irq;
+    gpio_irq_callback_t callback;
+    uint nucleo;
+} gpio_t;
+
+static gpio_t gpios[NUM_BANK0_GPIOS];
+
+typedef struct {
+    bool habilitado;
+    uint16_t wrap;
+} pwm_t;
+
+static pwm_t pwms[8];
+
+void gpio_init(uint gpio) {
+    gpios[gpio] = (gpio_t){ .funcao = GPIO_FUNC_SIO };
+}
+
+void gpio_set_dir(uint gpio, bool saida) {
+    gpios[gpio].saida = saida;
+}
+
+void gpio_put(uint gpio, bool valor) {
+    gpios[gpio].nivel = valor;
+}
+
+bool gpio_get(uint gpio) {
+    return gpios[gpio].nivel;
+}
+
+void gpio_pull_up(uint gpio) {
+    gpios[gpio].pull_up = true;
+    if (!gpios[gpio].saida) {
+        gpios[gpio].nivel = true;
+    }
+}
+
+void gpio_pull_down(uint gpio) {
+    gpios[gpio].pull_up = false;
+    if (!gpios[gpio].saida) {
+        gpios[gpio].nivel = false;
+    }
+}
+
+void gpio_set_function(uint gpio, enum gpio_function funcao) {
+    gpios[gpio].funcao = funcao;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos_irq, bool habilitada, gpio_irq_callback_t callback) {
+    gpios[gpio].eventos_irq = habilitada ? eventos_irq : 0;
+    gpios[gpio].callback = callback;
+    gpios[gpio].nucleo = get_core_num();
+}
+
+void host_gpio_entrada(uint gpio, bool nivel) {
+    gpio_t *pino = &gpios[gpio];
+    bool anterior = pino->nivel;
+    pino->nivel = nivel;
+    uint32_t borda = 0;
+    if (anterior && !nivel) {
+        borda = GPIO_IRQ_EDGE_FALL;
+    } else if (!anterior && nivel) {
+        borda = GPIO_IRQ_EDGE_RISE;
+    }
+    if (!(borda & pino->eventos_irq) || !pino->callback) {
+        return;
+    }
+    uint nucleo = get_core_num();
+    host_define_nucleo(pino->nucleo);
+    pthread_mutex_lock(&trava_irq[pino->nucleo]);
+    pino->callback(gpio, borda);
+    pthread_mutex_unlock(&trava_irq[pino->nucleo]);
+    host_define_nucleo(nucleo);
+    host_acorda();
+}
+
+bool host_gpio_saida(uint gpio) {
+    return gpios[gpio].nivel;
+}
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1) & 7;
+}
+
+void pwm_set_wrap(uint slice, uint16_t wrap) {
+    pwms[slice].wrap = wrap;
+}
+
+void pwm_set_clkdiv(uint slice, float divisor) {
+    (void)slice;
+    (void)divisor;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t nivel) {
+    (void)gpio;
+    (void)nivel;
+}
+
+void pwm_set_enabled(uint slice, bool habilitado) {
+    pwms[slice].habilitado = habilitado;
+}
+
+bool host_pwm_ativo(uint gpio) {
+    return gpios[gpio].funcao == GPIO_FUNC_PWM && pwms[pwm_gpio_to_slice_num(gpio)].habilitado;
+}
+
+uint32_t clock_get_hz(enum clock_index clock) {
+    return clock == clk_adc || clock == clk_usb ? 48000000u : 125000000u;
+}
+
+// Núcleo 1 e FIFO entre os núcleos
+
+#define FIFO_PROFUNDIDADE 8
+
+typedef struct {
+    uint32_t valores[FIFO_PROFUNDIDADE];
+    uint32_t escrita, leitura;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+} fifo_t;
+
+// fifos[n] é lida pelo núcleo n
+static fifo_t fifos[2] = {
+    { .trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER },
+    { .trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER },
+};
+
+static void *executa_nucleo1(void *entrada) {
+    host_define_nucleo(1);
+    ((void (*)(void))entrada)();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entrada)(void)) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, executa_nucleo1, (void *)entrada) != 0) {
+        panic("Failed to start core 1 thread");
+    }
+    pthread_detach(thread);
+}
+
+void multicore_fifo_push_blocking(uint32_t valor) {
+    fifo_t *fifo = &fifos[1 - get_core_num()];
+    pthread_mutex_lock(&fifo->trava);
+    while (fifo->escrita - fifo->leitura == FIFO_PROFUNDIDADE) {
+        pthread_cond_wait(&fifo->sinal, &fifo->trava);
+    }
+    fifo->valores[fifo->escrita++ % FIFO_PROFUNDIDADE] = valor;
+    pthread_cond_broadcast(&fifo->sinal);
+    pthread_mutex_unlock(&fifo->trava);
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    fifo_t *fifo = &fifos[get_core_num()];
+    pthread_mutex_lock(&fifo->trava);
+    while (fifo->escrita == fifo->leitura) {
+        pthread_cond_wait(&fifo->sinal, &fifo->trava);
+    }
+    uint32_t valor = fifo->valores[fifo->leitura++ % FIFO_PROFUNDIDADE];
+    pthread_cond_broadcast(&fifo->sinal);
+    pthread_mutex_unlock(&fifo->trava);
+    return valor;
+}
+
+void multicore_lockout_victim_init(void) {
+}
+
+// Flash, número aleatório e identificador
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+int flash_safe_execute(void (*funcao)(void *), void *parametro, uint32_t timeout_ms) {
+    (void)funcao;
+    (void)parametro;
+    (void)timeout_ms;
+    return PICO_ERROR_NOT_PERMITTED; // Sem flash na simulação: a fila fica só na RAM
+}
+
+uint32_t get_rand_32(void) {
+    static __thread unsigned int semente = 12345;
+    return ((uint32_t)rand_r(&semente) << 16) ^ (uint32_t)rand_r(&semente);
+}
+
+void pico_get_unique_board_id_string(char *destino, uint tamanho) {
+    snprintf(destino, tamanho, "%s", "E6614103E7452D2F");
+}
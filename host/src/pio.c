@@ -0,0 +1,186 @@
+#include <pthread.h>
+#include "pico_host.h"
+#include "simulacao.h"
+
+// PIO simulado. Cada máquina de estados iniciada com o programa da matriz alimenta uma fita de WS2812 no
+// seu pino: os LEDs recebem as palavras em sequência e só mostram as cores depois de um intervalo sem
+// dados de pelo menos PIO_RESET_US. Cada palavra ocupa a fita por HOST_PIO_PALAVRA_NS a partir do fim da
+// anterior, e o quadro pendente é travado quando a palavra seguinte chega depois do intervalo de reset ou
+// quando o cenário lê o quadro.
+
+#define PIO_RESET_US 50
+#define PIO_FIFO 8  // O programa da matriz junta o FIFO de recepção ao de transmissão
+#define PIO_INSTRUCOES 32
+#define PIO_FITA_MAX 64
+
+typedef struct {
+    bool reservada;
+    bool habilitada;
+    int pino;                          // -1 até o programa ser iniciado
+    uint32_t pendente[PIO_FITA_MAX];   // Palavras desde o último reset
+    uint pendentes;
+    uint64_t ultima_us;                // Fim da última palavra na fita
+    uint32_t quadro[PIO_FITA_MAX];     // Cores travadas
+    uint tamanho;
+    uint32_t quadros;
+    uint32_t invalidas;                // Palavras com os 8 bits baixos, que o programa não envia, diferentes de zero
+} maquina_t;
+
+typedef struct {
+    uint instrucoes;
+    maquina_t maquinas[NUM_PIO_STATE_MACHINES];
+} bloco_t;
+
+pio_hw_t pio0_hw_host, pio1_hw_host;
+
+static bloco_t blocos[2];
+static pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+
+static bloco_t *bloco(PIO pio) {
+    return &blocos[pio == pio0 ? 0 : 1];
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *programa) {
+    return bloco(pio)->instrucoes + programa->length <= PIO_INSTRUCOES;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *programa) {
+    if (!pio_can_add_program(pio, programa)) {
+        panic("No program space");
+    }
+    uint offset = bloco(pio)->instrucoes;
+    bloco(pio)->instrucoes += programa->length;
+    return offset;
+}
+
+int pio_claim_unused_sm(PIO pio, bool obrigatorio) {
+    pthread_mutex_lock(&trava);
+    int livre = -1;
+    for (uint i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+        maquina_t *maquina = &bloco(pio)->maquinas[i];
+        if (!maquina->reservada) {
+            *maquina = (maquina_t){ .reservada = true, .pino = -1 };
+            livre = (int)i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&trava);
+    if (livre < 0 && obrigatorio) {
+        panic("No PIO state machines are available");
+    }
+    return livre;
+}
+
+void pio_gpio_init(PIO pio, uint pino) {
+    gpio_set_function(pino, pio == pio0 ? GPIO_FUNC_PIO0 : GPIO_FUNC_PIO1);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool habilitada) {
+    pthread_mutex_lock(&trava);
+    bloco(pio)->maquinas[sm].habilitada = habilitada;
+    pthread_mutex_unlock(&trava);
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool tx) {
+    return (pio == pio0 ? DREQ_PIO0_TX0 : DREQ_PIO1_TX0) + sm + (tx ? 0 : NUM_PIO_STATE_MACHINES);
+}
+
+void host_pio_fita(PIO pio, uint sm, uint pino) {
+    pthread_mutex_lock(&trava);
+    bloco(pio)->maquinas[sm].pino = (int)pino;
+    pthread_mutex_unlock(&trava);
+}
+
+static void trava_quadro(maquina_t *maquina) {
+    uint guardadas = maquina->pendentes < PIO_FITA_MAX ? maquina->pendentes : PIO_FITA_MAX;
+    for (uint i = 0; i < guardadas; i++) {
+        maquina->quadro[i] = maquina->pendente[i];
+    }
+    maquina->tamanho = maquina->pendentes;
+    maquina->pendentes = 0;
+    maquina->quadros++;
+}
+
+// Envia a palavra pela fita a partir de instante_us; retorna o fim do envio
+static uint64_t captura(maquina_t *maquina, uint32_t palavra, uint64_t instante_us) {
+    if (maquina->pendentes && instante_us >= maquina->ultima_us + PIO_RESET_US) {
+        trava_quadro(maquina);
+    }
+    if (!maquina->habilitada) {
+        return instante_us;
+    }
+    if (palavra & 0xff) {
+        maquina->invalidas++;
+    }
+    if (maquina->pendentes < PIO_FITA_MAX) {
+        maquina->pendente[maquina->pendentes] = palavra;
+    }
+    maquina->pendentes++;
+    uint64_t inicio_us = instante_us > maquina->ultima_us ? instante_us : maquina->ultima_us;
+    maquina->ultima_us = inicio_us + HOST_PIO_PALAVRA_NS / 1000;
+    return maquina->ultima_us;
+}
+
+void host_pio_captura(uint dreq, uint32_t palavra, uint64_t instante_us) {
+    PIO pio = dreq >= DREQ_PIO1_TX0 ? pio1 : pio0;
+    pthread_mutex_lock(&trava);
+    captura(&bloco(pio)->maquinas[dreq % NUM_PIO_STATE_MACHINES], palavra, instante_us);
+    pthread_mutex_unlock(&trava);
+}
+
+// Espera só enquanto o FIFO estiver cheio, como no hardware
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t dado) {
+    uint64_t agora_us = time_us_64();
+    pthread_mutex_lock(&trava);
+    uint64_t fim_us = captura(&bloco(pio)->maquinas[sm], dado, agora_us);
+    pthread_mutex_unlock(&trava);
+    uint64_t fila_us = PIO_FIFO * HOST_PIO_PALAVRA_NS / 1000;
+    if (fim_us > agora_us + fila_us) {
+        sleep_us(fim_us - agora_us - fila_us);
+    }
+}
+
+// Máquina de estados da fita no pino, com o quadro pendente travado se o intervalo de reset já passou
+static maquina_t *maquina_do_pino(uint pino) {
+    for (uint b = 0; b < 2; b++) {
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+            maquina_t *maquina = &blocos[b].maquinas[i];
+            if (maquina->reservada && maquina->pino == (int)pino) {
+                if (maquina->pendentes && time_us_64() >= maquina->ultima_us + PIO_RESET_US) {
+                    trava_quadro(maquina);
+                }
+                return maquina;
+            }
+        }
+    }
+    return NULL;
+}
+
+bool host_pio_quadro(uint pino, uint32_t *quadro, uint maximo, uint *tamanho) {
+    pthread_mutex_lock(&trava);
+    maquina_t *maquina = maquina_do_pino(pino);
+    bool travado = maquina && maquina->quadros > 0;
+    if (travado) {
+        uint copiadas = maquina->tamanho;
+        if (copiadas > maximo) {
+            copiadas = maximo;
+        }
+        if (copiadas > PIO_FITA_MAX) {
+            copiadas = PIO_FITA_MAX;
+        }
+        for (uint i = 0; i < copiadas; i++) {
+            quadro[i] = maquina->quadro[i];
+        }
+        *tamanho = maquina->tamanho;
+    }
+    pthread_mutex_unlock(&trava);
+    return travado;
+}
+
+void host_pio_estatisticas(uint pino, uint32_t *quadros, uint32_t *invalidas) {
+    pthread_mutex_lock(&trava);
+    maquina_t *maquina = maquina_do_pino(pino);
+    *quadros = maquina ? maquina->quadros : 0;
+    *invalidas = maquina ? maquina->invalidas : 0;
+    pthread_mutex_unlock(&trava);
+}
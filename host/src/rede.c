@@ -0,0 +1,614 @@
+#include <pthread.h>
+#include <arpa/inet.h>
+#include "lwip_host.h"
+#include "simulacao.h"
+
+// cyw43, lwIP e broker MQTT simulados. Tudo roda no async context do cyw43, atendido por uma thread como
+// o contexto threadsafe_background do SDK: o Wi-Fi associa depois de HOST_WIFI_MS e o broker responde
+// CONNACK, SUBACK e PUBACK depois de HOST_RTT_MS. O cliente segue as regras do lwIP que importam para a
+// aplicação: no máximo MQTT_REQ_MAX_IN_FLIGHT pedidos pendentes, MQTT_OUTPUT_RINGBUF_SIZE bytes no anel
+// de saída (ERR_MEM quando cheio), mensagens recebidas entregues em pedaços e uma queda da conexão que
+// descarta os pedidos pendentes sem chamar os callbacks. O cenário pode fazer a próxima publicação em um
+// tópico ser recusada ou perdida, e consultar a mensagem retida em cada tópico.
+
+#ifndef HOST_RTT_MS
+#define HOST_RTT_MS 20
+#endif
+
+#ifndef HOST_WIFI_MS
+#define HOST_WIFI_MS 500
+#endif
+
+#define BROKER_TOPICOS 32
+#define BROKER_ASSINATURAS 16
+
+// cyw43 e async context
+
+cyw43_t cyw43_state;
+static async_context_t contexto_cyw43;
+static int estado_wifi = CYW43_LINK_DOWN;
+
+static void *executa_contexto(void *arg) {
+    (void)arg;
+    host_define_nucleo(0);
+    for (;;) {
+        async_context_poll(&contexto_cyw43);
+        async_context_wait_for_work_until(&contexto_cyw43, at_the_end_of_time);
+    }
+    return NULL;
+}
+
+int cyw43_arch_init(void) {
+    if (!async_context_host_init(&contexto_cyw43)) {
+        return 1;
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, executa_contexto, NULL) != 0) {
+        return 1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+}
+
+async_context_t *cyw43_arch_async_context(void) {
+    return &contexto_cyw43;
+}
+
+void cyw43_arch_lwip_begin(void) {
+    async_context_acquire_lock_blocking(&contexto_cyw43);
+}
+
+void cyw43_arch_lwip_end(void) {
+    async_context_release_lock(&contexto_cyw43);
+}
+
+void cyw43_arch_poll(void) {
+}
+
+void cyw43_arch_wait_for_work_until(absolute_time_t ate) {
+    sleep_until(ate);
+}
+
+void cyw43_arch_enable_sta_mode(void) {
+}
+
+static void netif_avisa(struct netif *netif) {
+    if (netif->link_callback) {
+        netif->link_callback(netif);
+    }
+    if (netif->status_callback) {
+        netif->status_callback(netif);
+    }
+}
+
+static void wifi_associa_fn(async_context_t *context, async_at_time_worker_t *worker) {
+    (void)context;
+    (void)worker;
+    if (estado_wifi != CYW43_LINK_JOIN) {
+        return;
+    }
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+    inet_pton(AF_INET, "10.0.0.2", &netif->ip_addr.addr);
+    netif->flags = NETIF_FLAG_UP | NETIF_FLAG_LINK_UP;
+    estado_wifi = CYW43_LINK_UP;
+    netif_avisa(netif);
+}
+
+static async_at_time_worker_t wifi_worker = { .do_work = wifi_associa_fn };
+
+int cyw43_arch_wifi_connect_async(const char *ssid, const char *senha, uint32_t autenticacao) {
+    (void)ssid;
+    (void)senha;
+    (void)autenticacao;
+    estado_wifi = CYW43_LINK_JOIN;
+    async_context_add_at_time_worker_in_ms(&contexto_cyw43, &wifi_worker, HOST_WIFI_MS);
+    return 0;
+}
+
+int cyw43_tcpip_link_status(cyw43_t *self, int itf) {
+    (void)self;
+    return itf == CYW43_ITF_STA ? estado_wifi : CYW43_LINK_DOWN;
+}
+
+int cyw43_wifi_leave(cyw43_t *self, int itf) {
+    struct netif *netif = &self->netif[itf];
+    async_context_remove_at_time_worker(&contexto_cyw43, &wifi_worker);
+    estado_wifi = CYW43_LINK_DOWN;
+    netif->flags = 0;
+    netif->ip_addr.addr = 0;
+    netif_avisa(netif);
+    return 0;
+}
+
+// netif, endereços e DNS
+
+void netif_set_status_callback(struct netif *netif, netif_status_callback_fn callback) {
+    netif->status_callback = callback;
+}
+
+void netif_set_link_callback(struct netif *netif, netif_status_callback_fn callback) {
+    netif->link_callback = callback;
+}
+
+char *ip4addr_ntoa(const ip4_addr_t *endereco) {
+    static char texto[INET_ADDRSTRLEN];
+    return (char *)inet_ntop(AF_INET, &endereco->addr, texto, sizeof(texto));
+}
+
+char *ipaddr_ntoa(const ip_addr_t *endereco) {
+    return ip4addr_ntoa(endereco);
+}
+
+err_t dns_gethostbyname(const char *nome, ip_addr_t *endereco, dns_found_callback callback, void *arg) {
+    (void)callback;
+    (void)arg;
+    if (strcmp(nome, "localhost") == 0) {
+        nome = "127.0.0.1";
+    }
+    return inet_pton(AF_INET, nome, &endereco->addr) == 1 ? ERR_OK : ERR_ARG;
+}
+
+// Cliente MQTT
+
+typedef enum {
+    MQTT_DESCONECTADO,
+    MQTT_CONECTANDO,
+    MQTT_CONECTADO
+} mqtt_estado_t;
+
+struct mqtt_client_s {
+    mqtt_estado_t estado;
+    uint32_t geracao;        // Invalida as respostas de uma conexão anterior
+    mqtt_connection_cb_t connect_cb;
+    void *connect_arg;
+    mqtt_incoming_publish_cb_t pub_cb;
+    mqtt_incoming_data_cb_t data_cb;
+    void *inpub_arg;
+    uint8_t pedidos;         // Aguardando PUBACK, SUBACK ou UNSUBACK
+    uint32_t anel_usado;     // Bytes no anel de saída ainda não transmitidos
+};
+
+// Respostas do broker, em ordem de instante
+typedef enum {
+    RESPOSTA_CONNACK,
+    RESPOSTA_TRANSMITIDO,    // A mensagem saiu do anel de saída e chegou ao broker
+    RESPOSTA_ACK,            // PUBACK, SUBACK ou UNSUBACK
+    RESPOSTA_ENTREGA,        // Mensagem de outro cliente
+    RESPOSTA_QUEDA
+} resposta_tipo_t;
+
+typedef struct resposta {
+    struct resposta *proxima;
+    absolute_time_t instante;
+    resposta_tipo_t tipo;
+    mqtt_client_t *cliente;
+    uint32_t geracao;
+    uint32_t bytes;
+    uint32_t anel;           // Bytes ocupados no anel de saída
+    mqtt_request_cb_t cb;
+    void *arg;
+    bool assina;
+    bool retem;
+    bool perdida;            // Transmitida, mas não chega ao broker
+    err_t resultado;         // Entregue ao callback do ACK
+    uint8_t qos;
+    char *topico;
+    uint8_t *dados;
+} resposta_t;
+
+static resposta_t *respostas;
+
+// Estatísticas do lwIP: o anel de saída ocupado conta como heap e cada mensagem ainda não transmitida
+// como um pbuf do pool
+static struct stats_mem stats_mem_pools[MEMP_MAX];
+struct stats_ lwip_stats = {
+    .mem = { .name = "MEM", .avail = MEM_SIZE },
+    .memp = { &stats_mem_pools[MEMP_TCP_PCB], &stats_mem_pools[MEMP_TCP_SEG], &stats_mem_pools[MEMP_PBUF],
+              &stats_mem_pools[MEMP_PBUF_POOL] },
+};
+
+static void estatistica_altera(struct stats_mem *stats, int32_t quantidade) {
+    stats->used += quantidade;
+    if (stats->used > stats->max) {
+        stats->max = stats->used;
+    }
+}
+
+// Estado do broker: assinaturas do cliente e estatísticas e mensagem retida por tópico publicado
+#define BROKER_RETIDO_MAX 16
+
+typedef struct {
+    char nome[MQTT_VAR_HEADER_BUFFER_LEN];
+    uint32_t mensagens;
+    uint32_t bytes;
+    char retido[BROKER_RETIDO_MAX];
+} topico_t;
+
+static struct {
+    mqtt_client_t *cliente;
+    char assinaturas[BROKER_ASSINATURAS][MQTT_VAR_HEADER_BUFFER_LEN];
+    absolute_time_t fora_ate;
+    topico_t topicos[BROKER_TOPICOS];
+    uint32_t conexoes;
+    uint32_t quedas;
+    uint32_t recusas_memoria;
+    char falha_topico[MQTT_VAR_HEADER_BUFFER_LEN];   // Próxima publicação que falha ("" para nenhuma)
+    broker_falha_t falha;
+} broker;
+
+static void respostas_worker_fn(async_context_t *context, async_at_time_worker_t *worker);
+static async_at_time_worker_t respostas_worker = { .do_work = respostas_worker_fn };
+
+static void agenda(resposta_t *resposta, uint32_t atraso_ms) {
+    resposta->instante = make_timeout_time_ms(atraso_ms);
+    resposta_t **p = &respostas;
+    while (*p && (*p)->instante <= resposta->instante) {
+        p = &(*p)->proxima;
+    }
+    resposta->proxima = *p;
+    *p = resposta;
+    async_context_add_at_time_worker_at(&contexto_cyw43, &respostas_worker, respostas->instante);
+}
+
+static resposta_t *nova_resposta(resposta_tipo_t tipo, mqtt_client_t *cliente) {
+    resposta_t *resposta = calloc(1, sizeof(resposta_t));
+    if (!resposta) {
+        panic("Out of memory in MQTT simulation");
+    }
+    resposta->tipo = tipo;
+    resposta->cliente = cliente;
+    resposta->geracao = cliente ? cliente->geracao : 0;
+    return resposta;
+}
+
+static void libera(resposta_t *resposta) {
+    free(resposta->topico);
+    free(resposta->dados);
+    free(resposta);
+}
+
+static bool broker_fora(void) {
+    return get_absolute_time() < broker.fora_ate;
+}
+
+// Fecha a conexão como o mqtt_close do lwIP: descarta os pedidos e avisa com o motivo
+static void fecha(mqtt_client_t *client, mqtt_connection_status_t motivo, bool avisa) {
+    if (client->estado == MQTT_DESCONECTADO) {
+        return;
+    }
+    client->estado = MQTT_DESCONECTADO;
+    client->geracao++;
+    client->pedidos = 0;
+    estatistica_altera(&lwip_stats.mem, -(int32_t)client->anel_usado);
+    lwip_stats.memp[MEMP_PBUF_POOL]->used = 0;
+    client->anel_usado = 0;
+    if (avisa && client->connect_cb) {
+        client->connect_cb(client, client->connect_arg, motivo);
+    }
+}
+
+// Casamento de filtro de assinatura com os curingas + e #
+static bool casa_filtro(const char *filtro, const char *topico) {
+    while (*filtro) {
+        if (filtro[0] == '#') {
+            return true;
+        }
+        if (filtro[0] == '+') {
+            while (*topico && *topico != '/') {
+                topico++;
+            }
+            filtro++;
+            continue;
+        }
+        if (*filtro != *topico) {
+            // "a/#" também casa com "a"
+            return *topico == '\0' && filtro[0] == '/' && filtro[1] == '#' && filtro[2] == '\0';
+        }
+        filtro++;
+        topico++;
+    }
+    return *topico == '\0';
+}
+
+static bool assinado(const char *topico) {
+    for (int i = 0; i < BROKER_ASSINATURAS; i++) {
+        if (broker.assinaturas[i][0] && casa_filtro(broker.assinaturas[i], topico)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void assina(const char *filtro, bool assina) {
+    int livre = -1;
+    for (int i = 0; i < BROKER_ASSINATURAS; i++) {
+        if (strcmp(broker.assinaturas[i], filtro) == 0) {
+            if (!assina) {
+                broker.assinaturas[i][0] = '\0';
+            }
+            return;
+        }
+        if (livre < 0 && !broker.assinaturas[i][0]) {
+            livre = i;
+        }
+    }
+    if (assina && livre >= 0) {
+        snprintf(broker.assinaturas[livre], sizeof(broker.assinaturas[livre]), "%s", filtro);
+    }
+}
+
+static topico_t *topico_publicado(const char *nome, bool cria) {
+    for (int i = 0; i < BROKER_TOPICOS; i++) {
+        topico_t *topico = &broker.topicos[i];
+        if (!topico->nome[0]) {
+            if (!cria) {
+                return NULL;
+            }
+            snprintf(topico->nome, sizeof(topico->nome), "%s", nome);
+        }
+        if (strcmp(topico->nome, nome) == 0) {
+            return topico;
+        }
+    }
+    return NULL;
+}
+
+static void contabiliza(const resposta_t *resposta) {
+    topico_t *topico = topico_publicado(resposta->topico, true);
+    if (!topico) {
+        return;
+    }
+    topico->mensagens++;
+    topico->bytes += resposta->bytes;
+    if (resposta->retem) {
+        uint32_t n = resposta->bytes < BROKER_RETIDO_MAX - 1 ? resposta->bytes : BROKER_RETIDO_MAX - 1;
+        memcpy(topico->retido, resposta->dados, n);
+        topico->retido[n] = '\0';
+    }
+}
+
+// Consome a falha programada para o tópico, se houver
+static bool falha(const char *topico, broker_falha_t tipo) {
+    if (broker.falha != tipo || strcmp(broker.falha_topico, topico) != 0) {
+        return false;
+    }
+    broker.falha_topico[0] = '\0';
+    return true;
+}
+
+// Entrega uma mensagem em pedaços: o primeiro cabe no que sobra do buffer depois do tópico e os demais
+// têm no máximo MQTT_VAR_HEADER_BUFFER_LEN bytes, como no lwIP
+static void entrega(mqtt_client_t *client, const char *topico, const uint8_t *dados, uint32_t tamanho, uint8_t qos) {
+    if (client->pub_cb) {
+        client->pub_cb(client->inpub_arg, topico, tamanho);
+    }
+    if (!client->data_cb) {
+        return;
+    }
+    int primeiro = MQTT_VAR_HEADER_BUFFER_LEN - 2 - (int)strlen(topico) - (qos ? 2 : 0);
+    uint32_t pedaco = primeiro > 0 ? (uint32_t)primeiro : 1;
+    uint32_t enviado = 0;
+    do {
+        uint32_t n = tamanho - enviado < pedaco ? tamanho - enviado : pedaco;
+        enviado += n;
+        client->data_cb(client->inpub_arg, dados + (enviado - n), (u16_t)n, enviado == tamanho ? MQTT_DATA_FLAG_LAST : 0);
+        pedaco = MQTT_VAR_HEADER_BUFFER_LEN;
+    } while (enviado < tamanho);
+}
+
+static void processa(resposta_t *resposta) {
+    mqtt_client_t *client = resposta->cliente;
+    if (client && resposta->geracao != client->geracao) {
+        return; // Resposta de uma conexão já encerrada
+    }
+    switch (resposta->tipo) {
+    case RESPOSTA_CONNACK:
+        if (broker_fora()) {
+            fecha(client, MQTT_CONNECT_DISCONNECTED, true); // Sem resposta do TCP
+            break;
+        }
+        client->estado = MQTT_CONECTADO;
+        broker.cliente = client;
+        broker.conexoes++;
+        memset(broker.assinaturas, 0, sizeof(broker.assinaturas)); // Sessão não persistente
+        if (client->connect_cb) {
+            client->connect_cb(client, client->connect_arg, MQTT_CONNECT_ACCEPTED);
+        }
+        break;
+    case RESPOSTA_TRANSMITIDO:
+        client->anel_usado -= resposta->anel;
+        estatistica_altera(&lwip_stats.mem, -(int32_t)resposta->anel);
+        estatistica_altera(lwip_stats.memp[MEMP_PBUF_POOL], -1);
+        if (resposta->cb) {
+            resposta->cb(resposta->arg, ERR_OK); // QoS 0: concluída ao ser transmitida
+        }
+        if (resposta->perdida) {
+            break;
+        }
+        contabiliza(resposta);
+        if (assinado(resposta->topico)) {
+            entrega(client, resposta->topico, resposta->dados, resposta->bytes, resposta->qos);
+        }
+        break;
+    case RESPOSTA_ACK:
+        client->pedidos--;
+        if (resposta->topico) {
+            assina(resposta->topico, resposta->assina);
+        }
+        if (resposta->cb) {
+            resposta->cb(resposta->arg, resposta->resultado);
+        }
+        break;
+    case RESPOSTA_ENTREGA:
+        if (client->estado == MQTT_CONECTADO && assinado(resposta->topico)) {
+            entrega(client, resposta->topico, resposta->dados, resposta->bytes, 1);
+        }
+        break;
+    case RESPOSTA_QUEDA:
+        broker.quedas++;
+        fecha(client, MQTT_CONNECT_DISCONNECTED, true);
+        break;
+    }
+}
+
+static void respostas_worker_fn(async_context_t *context, async_at_time_worker_t *worker) {
+    while (respostas && respostas->instante <= get_absolute_time()) {
+        resposta_t *resposta = respostas;
+        respostas = resposta->proxima;
+        processa(resposta);
+        libera(resposta);
+    }
+    if (respostas) {
+        async_context_add_at_time_worker_at(context, worker, respostas->instante);
+    }
+}
+
+mqtt_client_t *mqtt_client_new(void) {
+    return calloc(1, sizeof(mqtt_client_t));
+}
+
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *endereco, u16_t porta, mqtt_connection_cb_t cb,
+                          void *arg, const struct mqtt_connect_client_info_t *client_info) {
+    (void)endereco;
+    (void)porta;
+    (void)client_info;
+    if (client->estado != MQTT_DESCONECTADO) {
+        return ERR_ISCONN;
+    }
+    // O lwIP zera o cliente a cada conexão; os callbacks de entrada precisam ser definidos de novo
+    uint32_t geracao = client->geracao;
+    memset(client, 0, sizeof(*client));
+    client->geracao = geracao + 1;
+    client->estado = MQTT_CONECTANDO;
+    client->connect_cb = cb;
+    client->connect_arg = arg;
+    agenda(nova_resposta(RESPOSTA_CONNACK, client), HOST_RTT_MS);
+    return ERR_OK;
+}
+
+void mqtt_disconnect(mqtt_client_t *client) {
+    if (client) {
+        fecha(client, MQTT_CONNECT_DISCONNECTED, false);
+    }
+}
+
+u8_t mqtt_client_is_connected(mqtt_client_t *client) {
+    return client && client->estado == MQTT_CONECTADO;
+}
+
+void mqtt_set_inpub_callback(mqtt_client_t *client, mqtt_incoming_publish_cb_t pub_cb,
+                             mqtt_incoming_data_cb_t data_cb, void *arg) {
+    client->pub_cb = pub_cb;
+    client->data_cb = data_cb;
+    client->inpub_arg = arg;
+}
+
+err_t mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub) {
+    (void)qos;
+    if (client->estado != MQTT_CONECTADO) {
+        return ERR_CONN;
+    }
+    if (client->pedidos >= MQTT_REQ_MAX_IN_FLIGHT) {
+        broker.recusas_memoria++;
+        return ERR_MEM;
+    }
+    client->pedidos++;
+    resposta_t *resposta = nova_resposta(RESPOSTA_ACK, client);
+    resposta->topico = strdup(topic);
+    resposta->assina = sub;
+    resposta->cb = cb;
+    resposta->arg = arg;
+    agenda(resposta, HOST_RTT_MS);
+    return ERR_OK;
+}
+
+err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos,
+                   u8_t retain, mqtt_request_cb_t cb, void *arg) {
+    if (client->estado != MQTT_CONECTADO) {
+        return ERR_CONN;
+    }
+    // Cabeçalho fixo, tamanho do tópico, tópico, identificador do pacote e conteúdo
+    uint32_t tamanho = 2 + 2 + (uint32_t)strlen(topic) + (qos ? 2 : 0) + payload_length;
+    if ((qos && client->pedidos >= MQTT_REQ_MAX_IN_FLIGHT) || client->anel_usado + tamanho > MQTT_OUTPUT_RINGBUF_SIZE ||
+        falha(topic, BROKER_RECUSA)) {
+        broker.recusas_memoria++;
+        return ERR_MEM;
+    }
+    client->anel_usado += tamanho;
+    estatistica_altera(&lwip_stats.mem, (int32_t)tamanho);
+    estatistica_altera(lwip_stats.memp[MEMP_PBUF_POOL], 1);
+
+    resposta_t *transmitido = nova_resposta(RESPOSTA_TRANSMITIDO, client);
+    transmitido->topico = strdup(topic);
+    transmitido->dados = malloc(payload_length + 1);
+    memcpy(transmitido->dados, payload, payload_length);
+    transmitido->bytes = payload_length;
+    transmitido->anel = tamanho;
+    transmitido->qos = qos;
+    transmitido->retem = retain;
+    if (qos) {
+        client->pedidos++;
+        resposta_t *ack = nova_resposta(RESPOSTA_ACK, client);
+        ack->cb = cb;
+        ack->arg = arg;
+        if (falha(topic, BROKER_PERDE)) {
+            transmitido->perdida = true;
+            ack->resultado = ERR_TIMEOUT;
+        }
+        agenda(ack, HOST_RTT_MS);
+    } else {
+        transmitido->cb = cb;
+        transmitido->arg = arg;
+    }
+    agenda(transmitido, HOST_RTT_MS / 2);
+    return ERR_OK;
+}
+
+// Controle do broker pelo cenário; as mudanças são feitas com o lock do contexto, como no lwIP
+
+void broker_host_publica(const char *topico, const char *dados) {
+    async_context_acquire_lock_blocking(&contexto_cyw43);
+    if (broker.cliente) {
+        resposta_t *resposta = nova_resposta(RESPOSTA_ENTREGA, broker.cliente);
+        resposta->topico = strdup(topico);
+        resposta->bytes = (uint32_t)strlen(dados);
+        resposta->dados = (uint8_t *)strdup(dados);
+        agenda(resposta, HOST_RTT_MS / 2);
+    }
+    async_context_release_lock(&contexto_cyw43);
+}
+
+void broker_host_queda(uint32_t ms) {
+    async_context_acquire_lock_blocking(&contexto_cyw43);
+    broker.fora_ate = make_timeout_time_ms(ms);
+    if (broker.cliente && broker.cliente->estado != MQTT_DESCONECTADO) {
+        agenda(nova_resposta(RESPOSTA_QUEDA, broker.cliente), 0);
+    }
+    async_context_release_lock(&contexto_cyw43);
+}
+
+void broker_host_falha(const char *topico, broker_falha_t tipo) {
+    async_context_acquire_lock_blocking(&contexto_cyw43);
+    snprintf(broker.falha_topico, sizeof(broker.falha_topico), "%s", topico);
+    broker.falha = tipo;
+    async_context_release_lock(&contexto_cyw43);
+}
+
+void broker_host_retido(const char *topico, char *dados, size_t tamanho) {
+    async_context_acquire_lock_blocking(&contexto_cyw43);
+    const topico_t *publicado = topico_publicado(topico, false);
+    snprintf(dados, tamanho, "%s", publicado ? publicado->retido : "");
+    async_context_release_lock(&contexto_cyw43);
+}
+
+void broker_host_resumo(void) {
+    printf("Broker: %lu conexoes, %lu quedas, %lu pedidos recusados por falta de memoria\n",
+           (unsigned long)broker.conexoes, (unsigned long)broker.quedas, (unsigned long)broker.recusas_memoria);
+    for (int i = 0; i < BROKER_TOPICOS && broker.topicos[i].nome[0]; i++) {
+        printf("Broker: %-32s %6lu mensagens %8lu bytes\n", broker.topicos[i].nome,
+               (unsigned long)broker.topicos[i].mensagens, (unsigned long)broker.topicos[i].bytes);
+    }
+}
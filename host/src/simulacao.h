@@ -0,0 +1,65 @@
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico_host.h"
+
+// Controle dos periféricos simulados, usado pelo cenário (cenario.c) e entre os módulos da simulação
+
+// Inicia o cenário em uma thread própria; chamada por stdio_init_all, a primeira função da aplicação
+void cenario_inicia(void);
+
+// Executa os tratadores de uma interrupção como se estivessem no núcleo que a habilitou
+void host_irq_dispara(uint num);
+
+// Núcleo simulado pela thread atual (0 para a thread principal e para as threads dos periféricos)
+void host_define_nucleo(uint nucleo);
+
+// Acorda as esperas em __wfe, como uma interrupção no alvo
+void host_acorda(void);
+
+// Valor de 12 bits convertido por um canal do ADC
+void host_adc_define(uint canal, uint16_t valor);
+uint16_t host_adc_converte(void);
+uint32_t host_adc_taxa_hz(void);
+
+// Nível de uma entrada; gera a interrupção de borda configurada
+void host_gpio_entrada(uint gpio, bool nivel);
+
+// Nível atual de uma saída e se o PWM do pino está ativo
+bool host_gpio_saida(uint gpio);
+bool host_pwm_ativo(uint gpio);
+
+// Bytes entregues ao I2C (bloqueante ou por DMA)
+void host_i2c_captura(uint16_t palavra);
+void host_i2c_estatisticas(uint32_t *transacoes, uint32_t *bytes);
+
+// Falhas do alvo no barramento: sem ACK (o controlador aborta a transmissão, TX_ABRT) ou segurando o SCL
+// (nenhum byte avança)
+void host_i2c_nack(i2c_inst_t *i2c, bool nack);
+void host_i2c_preso(i2c_inst_t *i2c, bool preso);
+
+// Fita de WS2812 ligada a uma máquina de estados do PIO: o programa simulado a associa ao pino, o DMA
+// entrega as palavras (uma a cada HOST_PIO_PALAVRA_NS a partir de instante_us, no DREQ da máquina) e o
+// cenário lê o último quadro travado pela fita e as palavras fora do formato do programa
+#define HOST_PIO_PALAVRA_NS 30000
+void host_pio_fita(PIO pio, uint sm, uint pino);
+void host_pio_captura(uint dreq, uint32_t palavra, uint64_t instante_us);
+bool host_pio_quadro(uint pino, uint32_t *quadro, uint maximo, uint *tamanho);
+void host_pio_estatisticas(uint pino, uint32_t *quadros, uint32_t *invalidas);
+
+// Broker simulado: mensagem de outro cliente, queda por um tempo e resumo das publicações recebidas
+void broker_host_publica(const char *topico, const char *dados);
+void broker_host_queda(uint32_t ms);
+void broker_host_resumo(void);
+
+// Falha da próxima publicação em um tópico: recusada pelo lwIP (ERR_MEM) ou perdida, com o PUBACK trocado
+// por ERR_TIMEOUT depois de HOST_RTT_MS (no lwIP, depois de MQTT_REQ_TIMEOUT)
+typedef enum { BROKER_RECUSA, BROKER_PERDE } broker_falha_t;
+void broker_host_falha(const char *topico, broker_falha_t falha);
+
+// Última mensagem retida em um tópico ("" se não houver)
+void broker_host_retido(const char *topico, char *dados, size_t tamanho);
+
+#endif
@@ -0,0 +1,5 @@
+#include "simulacao.h"
+
+// Os testes usam os substitutos do SDK sem o cenário da simulação, iniciado por stdio_init_all
+void cenario_inicia(void) {
+}
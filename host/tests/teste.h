@@ -0,0 +1,33 @@
+#ifndef TESTE_H
+#define TESTE_H
+
+#include <stdio.h>
+
+// Verificações dos testes do host (ctest). Uma falha é impressa com o arquivo e a linha, e o teste segue
+// até o fim; main retorna teste_fim(), diferente de zero se alguma verificação falhou.
+
+static int teste_falhas;
+
+#define CONFERE(condicao) do { \
+        if (!(condicao)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condicao); \
+            teste_falhas++; \
+        } \
+    } while (0)
+
+#define CONFERE_IGUAL(valor, esperado) do { \
+        long long valor_ = (long long)(valor), esperado_ = (long long)(esperado); \
+        if (valor_ != esperado_) { \
+            fprintf(stderr, "%s:%d: %s é %lld, esperado %lld\n", __FILE__, __LINE__, #valor, valor_, esperado_); \
+            teste_falhas++; \
+        } \
+    } while (0)
+
+static inline int teste_fim(void) {
+    if (teste_falhas) {
+        fprintf(stderr, "%d verificações falharam\n", teste_falhas);
+    }
+    return teste_falhas ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "teste.h"
+#include "alarme.h"
+
+// Alarme médico: histerese dos limites, tempos mínimos de disparo e de liberação e a combinação com o
+// alarme manual. As amostras são avaliadas a cada 100 ms, como faria a tarefa do alarme.
+
+#define PASSO_MS 100
+#define TEMPERATURA_NORMAL 3650
+#define BATIMENTO_NORMAL 75
+
+static alarme_t alarme;
+static uint32_t agora_ms;
+static uint32_t ativacoes, liberacoes;
+static uint32_t ultima_borda_ms;
+
+static void novo_alarme(void) {
+    alarme_init(&alarme, 3500, 3800, 50, 110);
+    agora_ms = 1000;
+    ativacoes = liberacoes = 0;
+}
+
+// Avalia a mesma amostra por duracao_ms, contando as bordas
+static void mantem(int32_t temperatura, int32_t batimento, uint32_t duracao_ms) {
+    for (uint32_t t = 0; t < duracao_ms; t += PASSO_MS) {
+        alarme_evento_t evento = alarme_avalia(&alarme, temperatura, batimento, agora_ms);
+        if (evento == ALARME_ATIVADO) {
+            ativacoes++;
+            ultima_borda_ms = agora_ms;
+        } else if (evento == ALARME_LIBERADO) {
+            liberacoes++;
+            ultima_borda_ms = agora_ms;
+        }
+        agora_ms += PASSO_MS;
+    }
+}
+
+// Dispara só depois de ALARME_TEMPO_DISPARO_MS contínuos fora da faixa e libera depois de
+// ALARME_TEMPO_LIBERACAO_MS contínuos de volta
+static void tempos_minimos(void) {
+    novo_alarme();
+    mantem(TEMPERATURA_NORMAL, BATIMENTO_NORMAL, 1000);
+    uint32_t inicio = agora_ms;
+    mantem(3900, BATIMENTO_NORMAL, ALARME_TEMPO_DISPARO_MS + 1000);
+    CONFERE_IGUAL(ativacoes, 1);
+    CONFERE_IGUAL(ultima_borda_ms - inicio, ALARME_TEMPO_DISPARO_MS);
+    CONFERE(alarme_ativo(&alarme));
+
+    inicio = agora_ms;
+    mantem(TEMPERATURA_NORMAL, BATIMENTO_NORMAL, ALARME_TEMPO_LIBERACAO_MS + 1000);
+    CONFERE_IGUAL(liberacoes, 1);
+    CONFERE_IGUAL(ultima_borda_ms - inicio, ALARME_TEMPO_LIBERACAO_MS);
+    CONFERE(!alarme_ativo(&alarme));
+}
+
+// Uma violação mais curta que o tempo de disparo não dispara, e reinicia a contagem
+static void violacao_curta(void) {
+    novo_alarme();
+    for (int i = 0; i < 10; i++) {
+        mantem(TEMPERATURA_NORMAL, 130, ALARME_TEMPO_DISPARO_MS - PASSO_MS);
+        mantem(TEMPERATURA_NORMAL, BATIMENTO_NORMAL, PASSO_MS);
+    }
+    CONFERE_IGUAL(ativacoes, 0);
+}
+
+// Um valor oscilando em torno do limite, dentro da banda de histerese, gera uma única borda
+static void oscilacao_no_limite(void) {
+    novo_alarme();
+    int32_t maximo = alarme.temperatura.maximo;
+    for (int i = 0; i < 100; i++) {
+        mantem(i % 2 ? maximo + 5 : maximo - ALARME_HISTERESE_TEMPERATURA_C100 + 1, BATIMENTO_NORMAL, PASSO_MS);
+    }
+    CONFERE_IGUAL(ativacoes, 1);
+    CONFERE_IGUAL(liberacoes, 0);
+
+    // Só sai da faixa de alarme ao voltar com a folga da histerese
+    mantem(maximo - ALARME_HISTERESE_TEMPERATURA_C100, BATIMENTO_NORMAL, ALARME_TEMPO_LIBERACAO_MS + PASSO_MS);
+    CONFERE_IGUAL(liberacoes, 1);
+}
+
+// Faixa mais estreita que duas histereses: a folga é reduzida para que a saída seja possível
+static void faixa_estreita(void) {
+    novo_alarme();
+    alarme_set_faixa_batimento(&alarme, 70, 72);
+    mantem(TEMPERATURA_NORMAL, 80, ALARME_TEMPO_DISPARO_MS + PASSO_MS);
+    CONFERE_IGUAL(ativacoes, 1);
+    mantem(TEMPERATURA_NORMAL, 71, ALARME_TEMPO_LIBERACAO_MS + PASSO_MS);
+    CONFERE_IGUAL(liberacoes, 1);
+}
+
+// O manual age na hora e o estado combinado só muda quando nenhum dos dois o mantém
+static void manual_e_medico(void) {
+    novo_alarme();
+    CONFERE_IGUAL(alarme_set_manual(&alarme, true), ALARME_ATIVADO);
+    mantem(3900, BATIMENTO_NORMAL, ALARME_TEMPO_DISPARO_MS + PASSO_MS);
+    CONFERE_IGUAL(ativacoes, 0);
+    CONFERE(alarme.medico);
+    CONFERE_IGUAL(alarme_set_manual(&alarme, false), ALARME_SEM_MUDANCA);
+    mantem(TEMPERATURA_NORMAL, BATIMENTO_NORMAL, ALARME_TEMPO_LIBERACAO_MS + PASSO_MS);
+    CONFERE_IGUAL(liberacoes, 1);
+    CONFERE_IGUAL(alarme_set_manual(&alarme, false), ALARME_SEM_MUDANCA);
+}
+
+int main(void) {
+    tempos_minimos();
+    violacao_curta();
+    oscilacao_no_limite();
+    faixa_estreita();
+    manual_e_medico();
+    return teste_fim();
+}
@@ -0,0 +1,52 @@
+#include "teste.h"
+#include "aquisicao.h"
+#include "hardware/dma.h"
+
+// Decimação dos blocos do ADC, com a janela de sobreamostragem de cada canal (o CMakeLists compila este
+// teste com 8 amostras para o batimento e 32 para a temperatura), e a reserva dos canais de DMA.
+
+static uint32_t chamadas;
+static aq_leitura_t recebida;
+
+static void consome(const aq_leitura_t *leitura) {
+    chamadas++;
+    recebida = *leitura;
+}
+
+// Cada canal usa só as suas amostras mais recentes do bloco; os bits acima dos 12 do ADC são ignorados
+static void janela_por_canal(void) {
+    uint16_t bloco[AQ_AMOSTRAS_BLOCO];
+    for (uint32_t n = 0; n < AQ_AMOSTRAS_CANAL; n++) {
+        bloco[n * AQ_NUM_CANAIS + AQ_CANAL_BATIMENTO] = n < AQ_AMOSTRAS_CANAL - 8 ? 0 : 1000;
+        bloco[n * AQ_NUM_CANAIS + AQ_CANAL_TEMPERATURA] = (n & 1 ? 300 : 100) | 0x8000;
+    }
+    aquisicao_set_callback(consome);
+    aquisicao_processa_bloco(bloco, 1234);
+    CONFERE_IGUAL(chamadas, 1);
+    CONFERE_IGUAL(recebida.valor[AQ_CANAL_BATIMENTO], 1000);
+    CONFERE_IGUAL(recebida.valor[AQ_CANAL_TEMPERATURA], 200);
+    CONFERE_IGUAL(recebida.sequencia, 1);
+    CONFERE_IGUAL(recebida.instante_us, 1234);
+
+    aq_leitura_t leitura;
+    aquisicao_processa_bloco(bloco, 5678);
+    aquisicao_leitura(&leitura);
+    CONFERE_IGUAL(leitura.sequencia, 2);
+    CONFERE_IGUAL(aquisicao_valor(AQ_CANAL_BATIMENTO), 1000);
+}
+
+// Sem um segundo canal de DMA livre, a inicialização falha e devolve o primeiro
+static void canais_esgotados(void) {
+    for (int i = 0; i < NUM_DMA_CHANNELS - 1; i++) {
+        CONFERE(dma_claim_unused_channel(false) >= 0);
+    }
+    CONFERE(!aquisicao_init(AQ_TAXA_PADRAO_HZ));
+    CONFERE(dma_claim_unused_channel(false) >= 0);
+    CONFERE(dma_claim_unused_channel(false) < 0);
+}
+
+int main(void) {
+    janela_por_canal();
+    canais_esgotados();
+    return teste_fim();
+}
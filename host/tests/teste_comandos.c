@@ -0,0 +1,197 @@
+#include <string.h>
+#include "teste.h"
+#include "comandos.h"
+
+// Recepção dos comandos: remontagem dos pedaços entregues pelo lwIP, descarte de tópicos desconhecidos,
+// de mensagens maiores que o buffer e das que terminam com outro tamanho que o anunciado, e a leitura
+// das faixas em ponto fixo, inclusive nos limites de int32_t.
+
+static struct {
+    int chamadas;
+    const char *comando;
+    char dados[COMANDOS_DADOS_MAX + 1];
+    size_t len;
+} recebido;
+
+static void registra(const char *comando, const char *dados, size_t len) {
+    recebido.chamadas++;
+    recebido.comando = comando;
+    recebido.len = len;
+    memcpy(recebido.dados, dados, len + 1);
+}
+
+static void comando_faixa(void *contexto, const char *dados, size_t len) {
+    CONFERE(contexto == &recebido);
+    registra("faixa", dados, len);
+}
+
+static void comando_ping(void *contexto, const char *dados, size_t len) {
+    (void)contexto;
+    registra("ping", dados, len);
+}
+
+static const comando_t tabela[] = {
+    COMANDO("/comando/temperatura", comando_faixa),
+    COMANDO("/ping", comando_ping),
+};
+
+static comandos_t comandos;
+
+static void pedaco(const char *texto, bool ultimo) {
+    comandos_fragmento(&comandos, (const uint8_t *)texto, (uint16_t)strlen(texto), ultimo);
+}
+
+// A mensagem em vários pedaços chega inteira, terminada em '\0', ao tratador do tópico
+static void remontagem(void) {
+    memset(&recebido, 0, sizeof(recebido));
+    comandos_inicia(&comandos, "/dev1/comando/temperatura", 7);
+    pedaco("34", false);
+    pedaco(".5,", false);
+    CONFERE_IGUAL(recebido.chamadas, 0);
+    pedaco("37", true);
+    CONFERE_IGUAL(recebido.chamadas, 1);
+    CONFERE(strcmp(recebido.comando, "faixa") == 0);
+    CONFERE(strcmp(recebido.dados, "34.5,37") == 0);
+    CONFERE_IGUAL(recebido.len, 7);
+
+    // Último pedaço vazio e mensagem vazia
+    comandos_inicia(&comandos, "/dev1/ping", 3);
+    pedaco("abc", false);
+    pedaco("", true);
+    CONFERE_IGUAL(recebido.chamadas, 2);
+    CONFERE(strcmp(recebido.dados, "abc") == 0);
+    comandos_inicia(&comandos, "/dev1/ping", 0);
+    pedaco("", true);
+    CONFERE_IGUAL(recebido.chamadas, 3);
+    CONFERE_IGUAL(recebido.len, 0);
+
+    // Exatamente o tamanho do buffer
+    static char cheio[COMANDOS_DADOS_MAX + 1];
+    memset(cheio, 'x', COMANDOS_DADOS_MAX);
+    comandos_inicia(&comandos, "/dev1/ping", COMANDOS_DADOS_MAX);
+    pedaco(cheio, true);
+    CONFERE_IGUAL(recebido.chamadas, 4);
+    CONFERE_IGUAL(recebido.len, COMANDOS_DADOS_MAX);
+    CONFERE_IGUAL(comandos.excedidos, 0);
+}
+
+// Tópicos sem comando, ou sem o prefixo do dispositivo, têm os pedaços ignorados
+static void desconhecidos(void) {
+    memset(&recebido, 0, sizeof(recebido));
+    comandos_inicia(&comandos, "/dev1/comando/outro", 2);
+    pedaco("12", true);
+    comandos_inicia(&comandos, "/comando/temperatura", 2);
+    pedaco("12", true);
+    comandos_inicia(&comandos, "/dev1/ping/", 2);
+    pedaco("12", true);
+    CONFERE_IGUAL(recebido.chamadas, 0);
+    CONFERE_IGUAL(comandos.desconhecidos, 3);
+
+    // Pedaço fora de uma publicação
+    pedaco("12", true);
+    CONFERE_IGUAL(recebido.chamadas, 0);
+}
+
+// Mensagens que não cabem no buffer são descartadas inteiras, e a seguinte é recebida normalmente
+static void excedidas(void) {
+    memset(&recebido, 0, sizeof(recebido));
+    uint32_t excedidos = comandos.excedidos;
+    static char grande[COMANDOS_DADOS_MAX + 2];
+    memset(grande, '1', COMANDOS_DADOS_MAX + 1);
+
+    // Anunciada maior que o buffer
+    comandos_inicia(&comandos, "/dev1/ping", COMANDOS_DADOS_MAX + 1);
+    pedaco(grande, true);
+    CONFERE_IGUAL(comandos.excedidos, excedidos + 1);
+
+    // Anunciada pequena, mas o broker envia mais do que o buffer comporta
+    comandos_inicia(&comandos, "/dev1/ping", 10);
+    pedaco("0123456789", false);
+    pedaco(grande, false);
+    pedaco("fim", true);
+    CONFERE_IGUAL(comandos.excedidos, excedidos + 2);
+    CONFERE_IGUAL(recebido.chamadas, 0);
+
+    comandos_inicia(&comandos, "/dev1/comando/temperatura", 4);
+    pedaco("36,3", true);
+    CONFERE_IGUAL(recebido.chamadas, 1);
+    CONFERE(strcmp(recebido.dados, "36,3") == 0);
+}
+
+// Terminar com menos ou mais bytes que o anunciado descarta a mensagem
+static void tamanho_divergente(void) {
+    memset(&recebido, 0, sizeof(recebido));
+    comandos_inicia(&comandos, "/dev1/ping", 10);
+    pedaco("01234", true);
+    comandos_inicia(&comandos, "/dev1/ping", 3);
+    pedaco("01", false);
+    pedaco("234", true);
+    CONFERE_IGUAL(recebido.chamadas, 0);
+
+    comandos_inicia(&comandos, "/dev1/ping", 2);
+    pedaco("ok", true);
+    CONFERE_IGUAL(recebido.chamadas, 1);
+}
+
+static bool le_par(const char *texto, uint8_t casas, int32_t a, int32_t b) {
+    int32_t lido_a = 12345, lido_b = 12345;
+    if (!comandos_le_par(texto, strlen(texto), casas, &lido_a, &lido_b)) {
+        return false;
+    }
+    if (lido_a != a || lido_b != b) {
+        fprintf(stderr, "\"%s\": lido %ld,%ld, esperado %ld,%ld\n", texto, (long)lido_a, (long)lido_b,
+                (long)a, (long)b);
+        return false;
+    }
+    return true;
+}
+
+static void leitura_par(void) {
+    CONFERE(le_par("34.5,37", 2, 3450, 3700));
+    CONFERE(le_par(" -1.25 , +2 ", 2, -125, 200));
+    CONFERE(le_par("1.999,2", 1, 19, 20));
+    CONFERE(le_par(".5,1.", 2, 50, 100));
+    CONFERE(le_par("40,180", 0, 40, 180));
+    CONFERE(le_par("1.000000000000000000000000001,0", 2, 100, 0));
+
+    // Só os len bytes indicados são lidos
+    int32_t a, b;
+    CONFERE(comandos_le_par("12,34xyz", 5, 0, &a, &b));
+    CONFERE_IGUAL(a, 12);
+    CONFERE_IGUAL(b, 34);
+
+    const char *invalidos[] = { "", ",", "1", "1,", ",1", "a,1", "1,2,3", "1;2", "-,1", "1,+", "1 2,3",
+                                "1,2 x", "--1,2", "1..2,3" };
+    for (size_t i = 0; i < sizeof(invalidos) / sizeof(invalidos[0]); i++) {
+        if (le_par(invalidos[i], 2, 0, 0)) {
+            fprintf(stderr, "\"%s\" aceito\n", invalidos[i]);
+            teste_falhas++;
+        }
+    }
+}
+
+// Os limites de int32_t valem para o valor já multiplicado pelas casas, sem estouro intermediário
+static void limites(void) {
+    CONFERE(le_par("2147483647,-2147483648", 0, INT32_MAX, INT32_MIN));
+    CONFERE(!le_par("2147483648,0", 0, 0, 0));
+    CONFERE(!le_par("0,-2147483649", 0, 0, 0));
+    CONFERE(le_par("21474836.47,-21474836.48", 2, INT32_MAX, INT32_MIN));
+    CONFERE(!le_par("21474836.48,0", 2, 0, 0));
+    CONFERE(!le_par("21474837,0", 2, 0, 0));
+    CONFERE(!le_par("99999999999999999999999,0", 0, 0, 0));
+    CONFERE(!le_par("0.99999999999999999999999,0", 30, 0, 0));
+    CONFERE(!le_par("1,1", 20, 0, 0));
+    CONFERE(!le_par("2147483647,1", 255, 0, 0));
+    CONFERE(le_par("0,0", 255, 0, 0));
+}
+
+int main(void) {
+    comandos_init(&comandos, tabela, sizeof(tabela) / sizeof(tabela[0]), "/dev1", &recebido);
+    remontagem();
+    desconhecidos();
+    excedidas();
+    tamanho_divergente();
+    leitura_par();
+    limites();
+    return teste_fim();
+}
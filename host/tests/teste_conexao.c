@@ -0,0 +1,149 @@
+#include <string.h>
+#include "teste.h"
+#include "simulacao.h"
+#include "conexao.h"
+#include "pico/cyw43_arch.h"
+
+// Gerenciador de conexão: espera exponencial com a parte aleatória e a máquina de estados sobre o Wi-Fi
+// e o DNS simulados (src/rede.c), que associa em HOST_WIFI_MS. O broker é o próprio teste, que conta as
+// tentativas e informa o resultado como o callback de conexão do cliente MQTT.
+
+static volatile uint32_t tentativas;
+static volatile uint32_t desconexoes;
+static volatile bool recusa_broker;
+static ip_addr_t endereco_broker;
+
+static bool conectar_broker(const ip_addr_t *endereco) {
+    endereco_broker = *endereco;
+    tentativas++;
+    return !recusa_broker;
+}
+
+static void desconectar_broker(void) {
+    desconexoes++;
+}
+
+static const conexao_config_t config = {
+    .ssid = "rede",
+    .senha = "senha",
+    .servidor = "localhost",
+    .conectar_broker = conectar_broker,
+    .desconectar_broker = desconectar_broker,
+};
+
+// Metade fixa e metade aleatória; dobra a cada falha até o máximo, sem estourar com muitas falhas
+static void espera(void) {
+    CONFERE_IGUAL(conexao_backoff_ms(0, 0), CONEXAO_BACKOFF_BASE_MS / 2);
+    CONFERE_IGUAL(conexao_backoff_ms(0, CONEXAO_BACKOFF_BASE_MS / 2), CONEXAO_BACKOFF_BASE_MS);
+    CONFERE_IGUAL(conexao_backoff_ms(0, CONEXAO_BACKOFF_BASE_MS / 2 + 1), CONEXAO_BACKOFF_BASE_MS / 2);
+    uint32_t anterior = 0;
+    for (uint8_t falhas = 0; falhas < 16; falhas++) {
+        uint32_t minimo = conexao_backoff_ms(falhas, 0);
+        uint32_t maximo = conexao_backoff_ms(falhas, minimo);
+        CONFERE(maximo <= CONEXAO_BACKOFF_MAXIMO_MS);
+        CONFERE(maximo >= anterior);
+        CONFERE(maximo == CONEXAO_BACKOFF_MAXIMO_MS || maximo == (uint32_t)CONEXAO_BACKOFF_BASE_MS << falhas);
+        anterior = maximo;
+    }
+    CONFERE_IGUAL(anterior, CONEXAO_BACKOFF_MAXIMO_MS);
+    for (uint32_t falhas = 16; falhas <= UINT8_MAX; falhas++) {
+        uint32_t valor = conexao_backoff_ms((uint8_t)falhas, UINT32_MAX);
+        CONFERE(valor >= CONEXAO_BACKOFF_MAXIMO_MS / 2 && valor <= CONEXAO_BACKOFF_MAXIMO_MS);
+    }
+}
+
+static conexao_estado_t estado(void) {
+    cyw43_arch_lwip_begin();
+    conexao_estado_t atual = conexao_estado();
+    cyw43_arch_lwip_end();
+    return atual;
+}
+
+// Espera até o estado ser alcançado ou o prazo esgotar
+static bool aguarda_estado(conexao_estado_t esperado, uint32_t prazo_ms) {
+    for (uint32_t ms = 0; ms < prazo_ms; ms += 5) {
+        if (estado() == esperado) {
+            return true;
+        }
+        sleep_ms(5);
+    }
+    return estado() == esperado;
+}
+
+static void broker_conectado(void) {
+    cyw43_arch_lwip_begin();
+    conexao_broker_conectado();
+    cyw43_arch_lwip_end();
+}
+
+static void broker_perdido(void) {
+    cyw43_arch_lwip_begin();
+    conexao_broker_perdido();
+    cyw43_arch_lwip_end();
+}
+
+// Wi-Fi, DNS e broker em sequência; o tempo de recuperação conta desde a inicialização
+static void primeira_conexao(void) {
+    cyw43_arch_lwip_begin();
+    conexao_inicia(&config);
+    cyw43_arch_lwip_end();
+    CONFERE(aguarda_estado(CONEXAO_BROKER, 3000));
+    CONFERE_IGUAL(tentativas, 1);
+    CONFERE(strcmp(ipaddr_ntoa(&endereco_broker), "127.0.0.1") == 0);
+    broker_conectado();
+    CONFERE_IGUAL(estado(), CONEXAO_CONECTADO);
+    CONFERE_IGUAL(conexao_contagem(), 1);
+    CONFERE(conexao_tempo_recuperacao_ms() >= HOST_WIFI_MS);
+}
+
+// Perdido o broker, nova tentativa após a espera; uma recusa imediata dobra a espera seguinte, e o
+// Wi-Fi não é refeito
+static void queda_do_broker(void) {
+    recusa_broker = true;
+    uint64_t inicio_us = time_us_64();
+    broker_perdido();
+    CONFERE_IGUAL(estado(), CONEXAO_DNS);
+    for (uint32_t ms = 0; ms < 3000 && tentativas < 3; ms += 5) {
+        sleep_ms(5);
+    }
+    uint32_t decorrido_ms = (uint32_t)((time_us_64() - inicio_us) / 1000);
+    CONFERE_IGUAL(tentativas, 3);
+    // Duas esperas: de 250 a 500 ms e de 500 a 1000 ms
+    CONFERE(decorrido_ms >= CONEXAO_BACKOFF_BASE_MS / 2 + CONEXAO_BACKOFF_BASE_MS);
+
+    recusa_broker = false;
+    CONFERE(aguarda_estado(CONEXAO_BROKER, 3000));
+    CONFERE_IGUAL(tentativas, 4);
+    broker_conectado();
+    CONFERE_IGUAL(estado(), CONEXAO_CONECTADO);
+    CONFERE_IGUAL(conexao_contagem(), 2);
+    CONFERE(conexao_tempo_recuperacao_ms() >= decorrido_ms);
+    CONFERE_IGUAL(desconexoes, 0);
+}
+
+// Com o enlace perdido, o cliente MQTT é encerrado e a associação é refeita antes de voltar ao broker
+static void queda_do_wifi(void) {
+    cyw43_arch_lwip_begin();
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    cyw43_arch_lwip_end();
+    CONFERE_IGUAL(desconexoes, 1);
+    CONFERE(aguarda_estado(CONEXAO_WIFI_ASSOCIANDO, 1000));
+    CONFERE(aguarda_estado(CONEXAO_BROKER, 3000));
+    CONFERE_IGUAL(tentativas, 5);
+    broker_conectado();
+    CONFERE_IGUAL(conexao_contagem(), 3);
+    CONFERE(conexao_tempo_recuperacao_ms() >= HOST_WIFI_MS);
+
+    // Resultados fora de hora são ignorados
+    broker_conectado();
+    CONFERE_IGUAL(conexao_contagem(), 3);
+}
+
+int main(void) {
+    espera();
+    CONFERE(cyw43_arch_init() == 0);
+    primeira_conexao();
+    queda_do_broker();
+    queda_do_wifi();
+    return teste_fim();
+}
@@ -0,0 +1,176 @@
+#include <string.h>
+#include "teste.h"
+#include "ssd1306.h"
+#include "font.h"
+
+// Primitivas de desenho do SSD1306, que escrevem bytes inteiros de cada página, comparadas a uma
+// referência pixel a pixel. Depois de cada operação, a imagem deve ser a da referência e as marcações de
+// cada página devem ir exatamente da primeira à última coluna cujo byte mudou.
+
+static ssd1306_t ssd;
+static bool referencia[WIDTH][HEIGHT];
+static uint32_t semente = 12345;
+
+static uint32_t sorteia(uint32_t limite) {
+    semente = semente * 1103515245u + 12345u;
+    return (semente >> 16) % limite;
+}
+
+static void ref_pixel(int x, int y, bool valor) {
+    if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
+        referencia[x][y] = valor;
+    }
+}
+
+static void ref_area(int x0, int x1, int y0, int y1, bool valor) {
+    for (int x = x0; x <= x1; x++) {
+        for (int y = y0; y <= y1; y++) {
+            ref_pixel(x, y, valor);
+        }
+    }
+}
+
+static void ref_rect(int top, int left, int largura, int altura, bool valor, bool preenche) {
+    if (largura == 0 || altura == 0) {
+        return;
+    }
+    int direita = left + largura - 1;
+    int base = top + altura - 1;
+    if (preenche) {
+        ref_area(left, direita, top, base, valor);
+        return;
+    }
+    ref_area(left, direita, top, top, valor);
+    ref_area(left, direita, base, base, valor);
+    ref_area(left, left, top, base, valor);
+    ref_area(direita, direita, top, base, valor);
+}
+
+static void ref_char(char c, int x, int y) {
+    const uint8_t *glifo = &font[(c >= ' ' && c <= '~' ? c - ' ' : 0) * 8];
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            ref_pixel(x + i, y + j, glifo[i] & (1 << j));
+        }
+    }
+}
+
+static bool pixel(const uint8_t *memoria, int x, int y) {
+    return memoria[x * ssd.pages + y / 8 + 1] & (1 << (y & 7));
+}
+
+// Confere a imagem com a referência e as marcações com os bytes que mudaram desde antes
+static void confere(const uint8_t *antes, const char *operacao) {
+    int divergentes = 0;
+    for (int x = 0; x < WIDTH; x++) {
+        for (int y = 0; y < HEIGHT; y++) {
+            divergentes += pixel(ssd.ram_buffer, x, y) != referencia[x][y];
+        }
+    }
+    if (divergentes) {
+        fprintf(stderr, "%s: %d pixels divergentes\n", operacao, divergentes);
+    }
+    CONFERE_IGUAL(divergentes, 0);
+
+    for (uint8_t pagina = 0; pagina < ssd.pages; pagina++) {
+        int primeira = 0xFF, ultima = 0;
+        for (int x = WIDTH - 1; x >= 0; x--) {
+            size_t indice = x * ssd.pages + pagina + 1;
+            if (ssd.ram_buffer[indice] != antes[indice]) {
+                primeira = x;
+                if (x > ultima) {
+                    ultima = x;
+                }
+            }
+        }
+        if (ssd.dirty_x0[pagina] != primeira || ssd.dirty_x1[pagina] != ultima) {
+            fprintf(stderr, "%s: página %u marcada %u..%u, alterada %d..%d\n", operacao, pagina,
+                    ssd.dirty_x0[pagina], ssd.dirty_x1[pagina], primeira, ultima);
+            teste_falhas++;
+        }
+    }
+}
+
+// Operações sorteadas, quase todas dentro da tela e algumas cortadas pela borda
+static void operacoes_sorteadas(void) {
+    uint8_t antes[WIDTH * HEIGHT / 8 + 1];
+    for (int n = 0; n < 2000; n++) {
+        memcpy(antes, ssd.ram_buffer, ssd.bufsize);
+        ssd1306_clear_dirty(&ssd);
+        bool valor = sorteia(2);
+        uint8_t x = sorteia(WIDTH), y = sorteia(HEIGHT);
+        switch (sorteia(6)) {
+        case 0: {
+            uint8_t largura = 1 + sorteia(WIDTH - x), altura = 1 + sorteia(HEIGHT - y);
+            bool preenche = sorteia(2);
+            ssd1306_rect(&ssd, y, x, largura, altura, valor, preenche);
+            ref_rect(y, x, largura, altura, valor, preenche);
+            confere(antes, "rect");
+            break;
+        }
+        case 1: {
+            uint8_t x1 = x + sorteia(WIDTH - x);
+            ssd1306_hline(&ssd, x, x1, y, valor);
+            ref_area(x, x1, y, y, valor);
+            confere(antes, "hline");
+            break;
+        }
+        case 2: {
+            uint8_t y1 = y + sorteia(HEIGHT - y);
+            ssd1306_vline(&ssd, x, y, y1, valor);
+            ref_area(x, x, y, y1, valor);
+            confere(antes, "vline");
+            break;
+        }
+        case 3: {
+            char c = (char)(' ' + sorteia('~' - ' ' + 1));
+            ssd1306_draw_char(&ssd, c, x, y);
+            ref_char(c, x, y);
+            confere(antes, "draw_char");
+            break;
+        }
+        case 4:
+            ssd1306_pixel(&ssd, x, y, valor);
+            ref_pixel(x, y, valor);
+            confere(antes, "pixel");
+            break;
+        default: {
+            // Retângulo que pode passar da borda direita e da inferior
+            bool preenche = sorteia(2);
+            ssd1306_rect(&ssd, y, x, 40, 20, valor, preenche);
+            ref_rect(y, x, 40, 20, valor, preenche);
+            confere(antes, "rect cortado");
+            break;
+        }
+        }
+    }
+}
+
+// Preencher a tela marca só o trecho de cada página que muda; preencher de novo não marca nada
+static void preenchimento(void) {
+    uint8_t antes[WIDTH * HEIGHT / 8 + 1];
+    memcpy(antes, ssd.ram_buffer, ssd.bufsize);
+    ssd1306_clear_dirty(&ssd);
+    ssd1306_fill(&ssd, false);
+    ref_area(0, WIDTH - 1, 0, HEIGHT - 1, false);
+    confere(antes, "fill");
+
+    memcpy(antes, ssd.ram_buffer, ssd.bufsize);
+    ssd1306_clear_dirty(&ssd);
+    ssd1306_fill(&ssd, false);
+    confere(antes, "fill repetido");
+
+    memcpy(antes, ssd.ram_buffer, ssd.bufsize);
+    ssd1306_clear_dirty(&ssd);
+    ssd1306_rect(&ssd, 20, 30, 10, 9, true, true);
+    ssd1306_fill(&ssd, true);
+    ref_area(0, WIDTH - 1, 0, HEIGHT - 1, true);
+    confere(antes, "fill cheio");
+}
+
+int main(void) {
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, i2c0);
+    operacoes_sorteadas();
+    preenchimento();
+    return teste_fim();
+}
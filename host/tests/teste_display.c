@@ -0,0 +1,199 @@
+#include <string.h>
+#include "teste.h"
+#include "perifericos.h"
+#include "font.h"
+
+// Quadros de display_info() com as primitivas de lib/ssd1306.c, que escrevem bytes inteiros de cada página,
+// contra as primitivas antigas pixel a pixel, mantidas aqui como implementação de referência. A imagem deve
+// ser a mesma quadro a quadro; os tempos são só impressos, sem limite, para o teste não depender da máquina.
+
+#define QUADROS 5000
+#define MODELOS 500
+
+extern ssd1306_t ssd;
+
+// Primitivas antigas: cada pixel passa por ssd1306_pixel
+static void antigo_fill(ssd1306_t *d, bool valor) {
+    for (uint8_t y = 0; y < d->height; ++y) {
+        for (uint8_t x = 0; x < d->width; ++x) {
+            ssd1306_pixel(d, x, y, valor);
+        }
+    }
+}
+
+static void antigo_rect(ssd1306_t *d, uint8_t top, uint8_t left, uint8_t largura, uint8_t altura, bool valor, bool preenche) {
+    for (uint8_t x = left; x < left + largura; ++x) {
+        ssd1306_pixel(d, x, top, valor);
+        ssd1306_pixel(d, x, top + altura - 1, valor);
+    }
+    for (uint8_t y = top; y < top + altura; ++y) {
+        ssd1306_pixel(d, left, y, valor);
+        ssd1306_pixel(d, left + largura - 1, y, valor);
+    }
+    if (preenche) {
+        for (uint8_t x = left + 1; x < left + largura - 1; ++x) {
+            for (uint8_t y = top + 1; y < top + altura - 1; ++y) {
+                ssd1306_pixel(d, x, y, valor);
+            }
+        }
+    }
+}
+
+static void antigo_hline(ssd1306_t *d, uint8_t x0, uint8_t x1, uint8_t y, bool valor) {
+    for (uint8_t x = x0; x <= x1; ++x) {
+        ssd1306_pixel(d, x, y, valor);
+    }
+}
+
+static void antigo_draw_char(ssd1306_t *d, char c, uint8_t x, uint8_t y) {
+    uint16_t indice = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t linha = font[indice + i];
+        for (uint8_t j = 0; j < 8; ++j) {
+            ssd1306_pixel(d, x + i, y + j, linha & (1 << j));
+        }
+    }
+}
+
+static void antigo_draw_string(ssd1306_t *d, const char *str, uint8_t x, uint8_t y) {
+    while (*str) {
+        antigo_draw_char(d, *str++, x, y);
+        x += 8;
+        if (x + 8 >= d->width) {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= d->height) {
+            break;
+        }
+    }
+}
+
+// Cópias de desenhar_modelo() (lib/perifericos.c), com as primitivas atuais e com as antigas
+static void modelo_atual(ssd1306_t *d) {
+    ssd1306_fill(d, 1);
+    ssd1306_rect(d, 3, 3, 122, 58, false, true);
+    ssd1306_draw_string(d, "Paciente", 32, 6);
+    ssd1306_draw_string(d, "Seguro", 38, 16);
+    ssd1306_hline(d, 8, 119, 26, true);
+    ssd1306_draw_string(d, "Temp:", 8, 32);
+    ssd1306_draw_string(d, "BPM:", 8, 42);
+    ssd1306_rect(d, 6, 112, 3, 12, true, true);
+    ssd1306_rect(d, 10, 108, 11, 3, true, true);
+}
+
+static void modelo_antigo(ssd1306_t *d) {
+    antigo_fill(d, 1);
+    antigo_rect(d, 3, 3, 122, 58, false, true);
+    antigo_draw_string(d, "Paciente", 32, 6);
+    antigo_draw_string(d, "Seguro", 38, 16);
+    antigo_hline(d, 8, 119, 26, true);
+    antigo_draw_string(d, "Temp:", 8, 32);
+    antigo_draw_string(d, "BPM:", 8, 42);
+    antigo_rect(d, 6, 112, 3, 12, true, true);
+    antigo_rect(d, 10, 108, 11, 3, true, true);
+}
+
+// Cópia de display_info() com as primitivas antigas e um cache de campos próprio
+typedef struct {
+    uint8_t x, y;
+    uint8_t largura;
+    char texto[13];
+} campo_antigo_t;
+
+static campo_antigo_t temperatura_antiga = { .x = 56, .y = 32, .largura = 6 };
+static campo_antigo_t batimento_antigo = { .x = 48, .y = 42, .largura = 3 };
+
+static void atualizar_campo_antigo(ssd1306_t *d, campo_antigo_t *campo, const char *texto) {
+    char novo[sizeof(campo->texto)];
+    snprintf(novo, sizeof(novo), "%-*.*s", campo->largura, campo->largura, texto);
+    if (strcmp(novo, campo->texto) == 0) {
+        return;
+    }
+    antigo_draw_string(d, novo, campo->x, campo->y);
+    strcpy(campo->texto, novo);
+}
+
+static void desenha_campos_antigos(ssd1306_t *d, float temperatura, int batimento) {
+    char buffer[sizeof(temperatura_antiga.texto)];
+    snprintf(buffer, sizeof(buffer), "%.1f C", temperatura);
+    atualizar_campo_antigo(d, &temperatura_antiga, buffer);
+    snprintf(buffer, sizeof(buffer), "%d", batimento);
+    atualizar_campo_antigo(d, &batimento_antigo, buffer);
+}
+
+static void display_info_antigo(float temperatura, int batimento) {
+    desenha_campos_antigos(&ssd, temperatura, batimento);
+    ssd1306_send_dirty_async(&ssd);
+}
+
+// Valores de um quadro: a temperatura muda a cada quadro e o batimento a cada três
+static float temperatura_do_quadro(int i) {
+    return 35.0f + (i % 60) * 0.1f;
+}
+
+static int batimento_do_quadro(int i) {
+    return 55 + (i / 3) % 90;
+}
+
+static bool mesma_imagem(const ssd1306_t *a, const ssd1306_t *b) {
+    return memcmp(a->ram_buffer, b->ram_buffer, a->bufsize) == 0;
+}
+
+// A tela de display_info() é a mesma desenhada pelas primitivas antigas, quadro a quadro
+static void mesma_tela(ssd1306_t *referencia) {
+    modelo_antigo(referencia);
+    CONFERE(mesma_imagem(&ssd, referencia));
+    for (int i = 0; i < 300; i++) {
+        display_info(temperatura_do_quadro(i), batimento_do_quadro(i));
+        desenha_campos_antigos(referencia, temperatura_do_quadro(i), batimento_do_quadro(i));
+        if (!mesma_imagem(&ssd, referencia)) {
+            CONFERE(mesma_imagem(&ssd, referencia));
+            break;
+        }
+    }
+    ssd1306_wait_idle(&ssd);
+}
+
+// Tempo médio, em nanossegundos, de cada chamada
+static double ns_por_quadro(void (*quadro)(float, int)) {
+    uint64_t inicio = time_us_64();
+    for (int i = 0; i < QUADROS; i++) {
+        quadro(temperatura_do_quadro(i), batimento_do_quadro(i));
+    }
+    uint64_t fim = time_us_64();
+    ssd1306_wait_idle(&ssd);
+    return (fim - inicio) * 1000.0 / QUADROS;
+}
+
+static double ns_por_modelo(void (*modelo)(ssd1306_t *), ssd1306_t *d) {
+    uint64_t inicio = time_us_64();
+    for (int i = 0; i < MODELOS; i++) {
+        modelo(d);
+        ssd1306_clear_dirty(d);
+    }
+    return (time_us_64() - inicio) * 1000.0 / MODELOS;
+}
+
+int main(void) {
+    init_ssd();
+
+    ssd1306_t referencia;
+    ssd1306_init(&referencia, WIDTH, HEIGHT, false, ENDERECO, I2C_PORT);
+    mesma_tela(&referencia);
+
+    // Os quadros medidos começam da mesma tela; o cache antigo parte vazio e redesenha os campos no primeiro
+    double atual = ns_por_quadro(display_info);
+    double antigo = ns_por_quadro(display_info_antigo);
+    printf("display_info: %.0f ns/quadro; primitivas pixel a pixel: %.0f ns/quadro (%.1fx)\n",
+           atual, antigo, antigo / atual);
+
+    ssd1306_t rascunho;
+    ssd1306_init(&rascunho, WIDTH, HEIGHT, false, ENDERECO, I2C_PORT);
+    double modelo = ns_por_modelo(modelo_atual, &rascunho);
+    double modelo_pixels = ns_por_modelo(modelo_antigo, &rascunho);
+    printf("modelo da tela: %.0f ns; primitivas pixel a pixel: %.0f ns (%.1fx)\n",
+           modelo, modelo_pixels, modelo_pixels / modelo);
+
+    return teste_fim();
+}
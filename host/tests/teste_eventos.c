@@ -0,0 +1,164 @@
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "teste.h"
+#include "eventos.h"
+
+// Fila de eventos de um produtor e um consumidor: capacidade, contagem de perdidos, volta dos índices de
+// 32 bits, um produtor em um sinal que interrompe o consumidor a qualquer momento (interrupção no mesmo
+// núcleo) e um produtor e um consumidor em threads separadas (o outro núcleo).
+
+#define ESTRESSE_EVENTOS 2000000
+#define INTERRUPCAO_EVENTOS 200000
+#define INTERRUPCAO_PERIODO_US 20
+
+static fila_eventos_t fila;
+
+// Campos derivados do número de sequência, para detectar um evento lido pela metade
+static evento_t evento_numero(uint32_t n) {
+    return (evento_t){ .instante_us = n, .tipo = EVENTO_ALARME, .dado = (uint16_t)n,
+                       .valor = { (int32_t)(n * 3u), (int32_t)~n } };
+}
+
+static bool evento_integro(const evento_t *evento, uint32_t n) {
+    evento_t esperado = evento_numero(n);
+    return evento->instante_us == esperado.instante_us && evento->tipo == esperado.tipo &&
+           evento->dado == esperado.dado && evento->valor[0] == esperado.valor[0] &&
+           evento->valor[1] == esperado.valor[1];
+}
+
+// A fila aceita exatamente a capacidade, conta as recusas e continua em ordem quando os índices dão a
+// volta em 32 bits
+static void capacidade(void) {
+    eventos_init(&fila);
+    fila.escrita = fila.leitura = UINT32_MAX - 5;
+    evento_t evento;
+    CONFERE(!eventos_consome(&fila, &evento));
+
+    uint32_t publicados = 0, consumidos = 0;
+    for (int rodada = 0; rodada < 3; rodada++) {
+        for (int i = 0; i < EVENTOS_CAPACIDADE; i++) {
+            evento_t novo = evento_numero(publicados++);
+            CONFERE(eventos_publica(&fila, &novo));
+        }
+        evento_t extra = evento_numero(9999);
+        CONFERE(!eventos_publica(&fila, &extra));
+        CONFERE_IGUAL(eventos_contagem(&fila), EVENTOS_CAPACIDADE);
+        // Libera metade e completa de novo antes de esvaziar
+        for (int i = 0; i < EVENTOS_CAPACIDADE / 2; i++) {
+            CONFERE(eventos_consome(&fila, &evento));
+            CONFERE(evento_integro(&evento, consumidos++));
+        }
+        for (int i = 0; i < EVENTOS_CAPACIDADE / 2; i++) {
+            evento_t novo = evento_numero(publicados++);
+            CONFERE(eventos_publica(&fila, &novo));
+        }
+        while (eventos_consome(&fila, &evento)) {
+            CONFERE(evento_integro(&evento, consumidos++));
+        }
+    }
+    CONFERE_IGUAL(consumidos, publicados);
+    CONFERE_IGUAL(fila.perdidos, 3);
+    CONFERE(fila.escrita < UINT32_MAX - 5);
+}
+
+static volatile uint32_t publicados_sinal;
+static volatile uint32_t recusas_sinal;
+
+// Produtor na interrupção: a cada disparo publica até encher a fila; o evento recusado é repetido no
+// disparo seguinte
+static void produtor_sinal(int sinal) {
+    (void)sinal;
+    while (publicados_sinal < INTERRUPCAO_EVENTOS) {
+        evento_t evento = evento_numero(publicados_sinal);
+        if (!eventos_publica(&fila, &evento)) {
+            recusas_sinal++;
+            return;
+        }
+        publicados_sinal++;
+    }
+}
+
+// O consumidor é interrompido no meio da leitura; os eventos chegam completos, em ordem e sem repetição
+static void interrupcao(void) {
+    eventos_init(&fila);
+    struct sigaction acao = { .sa_handler = produtor_sinal };
+    sigemptyset(&acao.sa_mask);
+    CONFERE(sigaction(SIGALRM, &acao, NULL) == 0);
+    struct itimerval periodo = { { 0, INTERRUPCAO_PERIODO_US }, { 0, INTERRUPCAO_PERIODO_US } };
+    CONFERE(setitimer(ITIMER_REAL, &periodo, NULL) == 0);
+
+    uint32_t esperado = 0, divergentes = 0;
+    evento_t evento;
+    while (esperado < INTERRUPCAO_EVENTOS) {
+        if (!eventos_consome(&fila, &evento)) {
+            continue;
+        }
+        if (!evento_integro(&evento, esperado)) {
+            divergentes++;
+            esperado = evento.instante_us;
+        }
+        esperado++;
+        // Consumidor mais lento que o produtor: a fila fica quase sempre cheia e a interrupção disputa a
+        // posição que acabou de ser lida
+        for (volatile int i = 0; i < 1000; i++) {
+        }
+    }
+
+    struct itimerval parado = { { 0, 0 }, { 0, 0 } };
+    setitimer(ITIMER_REAL, &parado, NULL);
+    CONFERE_IGUAL(divergentes, 0);
+    CONFERE_IGUAL(fila.perdidos, recusas_sinal);
+}
+
+static uint32_t recusas;
+
+// Produtor: publica a sequência inteira, repetindo cada evento recusado com a fila cheia. As esperas
+// cedem o processador para o teste não depender de haver mais de um.
+static void *produtor(void *arg) {
+    (void)arg;
+    for (uint32_t n = 0; n < ESTRESSE_EVENTOS; n++) {
+        evento_t evento = evento_numero(n);
+        while (!eventos_publica(&fila, &evento)) {
+            recusas++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Consumidor em outra thread: nenhum evento se perde, repete, sai de ordem ou chega incompleto
+static void estresse(void) {
+    eventos_init(&fila);
+    recusas = 0;
+    pthread_t thread;
+    CONFERE(pthread_create(&thread, NULL, produtor, NULL) == 0);
+
+    uint32_t esperado = 0, divergentes = 0;
+    evento_t evento;
+    while (esperado < ESTRESSE_EVENTOS) {
+        if (!eventos_consome(&fila, &evento)) {
+            sched_yield();
+            continue;
+        }
+        if (evento.instante_us != esperado) {
+            divergentes++;
+            esperado = evento.instante_us;
+        } else if (!evento_integro(&evento, esperado)) {
+            divergentes++;
+        }
+        esperado++;
+    }
+    pthread_join(thread, NULL);
+    CONFERE_IGUAL(divergentes, 0);
+    CONFERE(!eventos_consome(&fila, &evento));
+    CONFERE_IGUAL(fila.perdidos, recusas);
+}
+
+int main(void) {
+    capacidade();
+    interrupcao();
+    estresse();
+    return teste_fim();
+}
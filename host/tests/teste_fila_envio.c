@@ -0,0 +1,162 @@
+#include <string.h>
+#include "teste.h"
+#include "fila_envio.h"
+
+// Fila de armazenamento e reenvio, compilada com um anel pequeno (FILA_ENVIO_BYTES = 64) para que as
+// mensagens deem a volta no fim e a fila encha com poucas delas. Cada mensagem de teste tem 10 bytes
+// (12 na fila) preenchidos com o seu número.
+
+#define TAMANHO 10
+
+static fila_envio_t fila;
+
+static bool adiciona(uint8_t numero) {
+    uint8_t mensagem[TAMANHO];
+    memset(mensagem, numero, sizeof(mensagem));
+    return fila_envio_adiciona(&fila, mensagem, sizeof(mensagem));
+}
+
+// Número da próxima mensagem a enviar, conferindo o tamanho e o conteúdo; 0 se não houver
+static uint8_t proxima(void) {
+    uint8_t buffer[32];
+    size_t tamanho = fila_envio_proxima(&fila, buffer, sizeof(buffer));
+    if (tamanho == 0) {
+        return 0;
+    }
+    CONFERE_IGUAL(tamanho, TAMANHO);
+    for (size_t i = 1; i < tamanho; i++) {
+        CONFERE_IGUAL(buffer[i], buffer[0]);
+    }
+    return buffer[0];
+}
+
+// Envia a próxima mensagem e devolve o número dela
+static uint8_t envia(void) {
+    uint8_t numero = proxima();
+    fila_envio_marca_enviada(&fila);
+    return numero;
+}
+
+// Mensagens saem na ordem em que entraram e só deixam a fila com a confirmação
+static void ordem(void) {
+    fila_envio_init(&fila);
+    for (uint8_t n = 1; n <= 3; n++) {
+        CONFERE(adiciona(n));
+    }
+    CONFERE_IGUAL(envia(), 1);
+    CONFERE_IGUAL(envia(), 2);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 3);
+    fila_envio_confirma(&fila);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 2);
+    CONFERE_IGUAL(envia(), 3);
+    CONFERE(!fila_envio_pendente(&fila));
+    CONFERE_IGUAL(proxima(), 0);
+    fila_envio_confirma(&fila);
+    fila_envio_confirma(&fila);
+    fila_envio_confirma(&fila);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 0);
+    CONFERE_IGUAL(fila.descartadas, 0);
+}
+
+// Uma falha faz as enviadas e não confirmadas voltarem a ser enviadas, na ordem original
+static void reenvio(void) {
+    fila_envio_init(&fila);
+    for (uint8_t n = 1; n <= 4; n++) {
+        CONFERE(adiciona(n));
+    }
+    CONFERE_IGUAL(envia(), 1);
+    fila_envio_confirma(&fila);
+    CONFERE_IGUAL(envia(), 2);
+    CONFERE_IGUAL(envia(), 3);
+    fila_envio_reenvia(&fila);
+    CONFERE(fila_envio_pendente(&fila));
+    CONFERE_IGUAL(envia(), 2);
+    CONFERE_IGUAL(envia(), 3);
+    CONFERE_IGUAL(envia(), 4);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 3);
+}
+
+// Sem nada enviado, a fila cheia descarta as mais antigas, também depois de dar a volta no anel
+static void descarte_sem_enviadas(void) {
+    fila_envio_init(&fila);
+    for (uint8_t n = 1; n <= 5; n++) {
+        CONFERE(adiciona(n));
+    }
+    CONFERE(adiciona(6));
+    CONFERE_IGUAL(fila.descartadas, 1);
+    CONFERE(adiciona(7));
+    CONFERE_IGUAL(fila.descartadas, 2);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 5);
+    for (uint8_t n = 3; n <= 7; n++) {
+        CONFERE_IGUAL(envia(), n);
+        fila_envio_confirma(&fila);
+    }
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 0);
+}
+
+// Com mensagens aguardando confirmação, saem as mais antigas ainda não enviadas; as enviadas continuam
+// intactas para a confirmação e para um reenvio
+static void descarte_com_enviadas(void) {
+    fila_envio_init(&fila);
+    // Desloca o início do anel para que as enviadas precisem dar a volta ao serem movidas
+    CONFERE(adiciona(9));
+    CONFERE(adiciona(9));
+    CONFERE_IGUAL(envia(), 9);
+    fila_envio_confirma(&fila);
+    CONFERE_IGUAL(envia(), 9);
+    fila_envio_confirma(&fila);
+
+    for (uint8_t n = 1; n <= 5; n++) {
+        CONFERE(adiciona(n));
+    }
+    CONFERE_IGUAL(envia(), 1);
+    CONFERE_IGUAL(envia(), 2);
+    CONFERE(adiciona(6));
+    CONFERE(adiciona(7));
+    CONFERE_IGUAL(fila.descartadas, 2);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 5);
+    CONFERE_IGUAL(envia(), 5);
+
+    fila_envio_reenvia(&fila);
+    CONFERE_IGUAL(envia(), 1);
+    fila_envio_confirma(&fila);
+    CONFERE_IGUAL(envia(), 2);
+    fila_envio_confirma(&fila);
+    for (uint8_t n = 5; n <= 7; n++) {
+        CONFERE_IGUAL(envia(), n);
+        fila_envio_confirma(&fila);
+    }
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 0);
+}
+
+// Com todas as mensagens aguardando confirmação, a nova é recusada; tamanhos inválidos também
+static void recusa(void) {
+    fila_envio_init(&fila);
+    for (uint8_t n = 1; n <= 5; n++) {
+        CONFERE(adiciona(n));
+        CONFERE_IGUAL(envia(), n);
+    }
+    CONFERE(!adiciona(6));
+    CONFERE_IGUAL(fila.descartadas, 1);
+    CONFERE_IGUAL(fila_envio_contagem(&fila), 5);
+
+    uint8_t grande[FILA_ENVIO_BYTES] = {0};
+    CONFERE(!fila_envio_adiciona(&fila, grande, 0));
+    CONFERE(!fila_envio_adiciona(&fila, grande, sizeof(grande) - 1));
+    CONFERE_IGUAL(fila.descartadas, 3);
+
+    fila_envio_reenvia(&fila);
+    for (uint8_t n = 1; n <= 5; n++) {
+        CONFERE_IGUAL(envia(), n);
+        fila_envio_confirma(&fila);
+    }
+}
+
+int main(void) {
+    ordem();
+    reenvio();
+    descarte_sem_enviadas();
+    descarte_com_enviadas();
+    recusa();
+    return teste_fim();
+}
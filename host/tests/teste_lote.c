@@ -0,0 +1,115 @@
+#include <string.h>
+#include "teste.h"
+#include "lote.h"
+
+// Anel de amostras da telemetria em lote: sobrescrita da mais antiga, resumo com média arredondada,
+// mensagem codificada que decodifica nas mesmas amostras e remoção após a publicação.
+
+static telemetria_registro_t amostra(uint32_t instante_ms, int32_t temperatura_c100, int32_t batimento_bpm) {
+    return (telemetria_registro_t){ .instante_ms = instante_ms, .temperatura_c100 = temperatura_c100,
+                                    .batimento_bpm = batimento_bpm };
+}
+
+// Com o anel cheio, cada amostra nova sobrescreve a mais antiga e é contada como descartada
+static void sobrescrita(void) {
+    lote_t lote;
+    lote_init(&lote);
+    for (uint32_t i = 0; i < LOTE_AMOSTRAS_MAX + 5; i++) {
+        telemetria_registro_t nova = amostra(i * 100, (int32_t)i, 0);
+        lote_adiciona(&lote, &nova);
+    }
+    CONFERE_IGUAL(lote_contagem(&lote), LOTE_AMOSTRAS_MAX);
+    CONFERE_IGUAL(lote.descartadas, 5);
+
+    // A mais antiga restante é a sexta; remover além da contagem esvazia o anel
+    telemetria_resumo_t resumo;
+    lote_resumo(&lote, 1, &resumo);
+    CONFERE_IGUAL(resumo.temperatura_min_c100, 5);
+    lote_remove(&lote, 3);
+    CONFERE_IGUAL(lote_contagem(&lote), LOTE_AMOSTRAS_MAX - 3);
+    lote_resumo(&lote, 1, &resumo);
+    CONFERE_IGUAL(resumo.temperatura_min_c100, 8);
+    lote_remove(&lote, 255);
+    CONFERE_IGUAL(lote_contagem(&lote), 0);
+    lote_resumo(&lote, 4, &resumo);
+    CONFERE_IGUAL(resumo.temperatura_media_c100, 0);
+    CONFERE_IGUAL(lote.descartadas, 5);
+}
+
+// Mínimo, máximo e média só das n mais antigas; a média arredonda para o mais próximo, também negativa
+static void resumo(void) {
+    lote_t lote;
+    lote_init(&lote);
+    const int32_t temperaturas[] = { -101, -102, -102, 3000 };
+    const int32_t batimentos[] = { 61, 62, 62, 200 };
+    for (int i = 0; i < 4; i++) {
+        telemetria_registro_t nova = amostra(i * 100, temperaturas[i], batimentos[i]);
+        lote_adiciona(&lote, &nova);
+    }
+    telemetria_resumo_t resumo;
+    lote_resumo(&lote, 3, &resumo);
+    CONFERE_IGUAL(resumo.temperatura_min_c100, -102);
+    CONFERE_IGUAL(resumo.temperatura_max_c100, -101);
+    CONFERE_IGUAL(resumo.temperatura_media_c100, -102);
+    CONFERE_IGUAL(resumo.batimento_min_bpm, 61);
+    CONFERE_IGUAL(resumo.batimento_max_bpm, 62);
+    CONFERE_IGUAL(resumo.batimento_media_bpm, 62);
+
+    lote_resumo(&lote, 2, &resumo);
+    CONFERE_IGUAL(resumo.temperatura_media_c100, -102);
+    CONFERE_IGUAL(resumo.batimento_media_bpm, 62);
+}
+
+// A mensagem traz as n amostras mais antigas, na ordem, e o resumo delas, sem removê-las do anel
+static void codificacao(void) {
+    lote_t lote;
+    lote_init(&lote);
+    // Começa no meio do anel para a mensagem atravessar a volta do índice
+    for (uint32_t i = 0; i < LOTE_AMOSTRAS_MAX / 2; i++) {
+        telemetria_registro_t nova = amostra(i, 0, 0);
+        lote_adiciona(&lote, &nova);
+    }
+    lote_remove(&lote, LOTE_AMOSTRAS_MAX / 2);
+    for (uint32_t i = 0; i < LOTE_AMOSTRAS_MAX; i++) {
+        telemetria_registro_t nova = amostra(50000 + i * 1000, 3600 + (int32_t)i, 70 - (int32_t)i);
+        nova.estado = i & 1 ? TELEMETRIA_ALARME_ATIVO : 0;
+        lote_adiciona(&lote, &nova);
+    }
+
+    uint8_t buffer[LOTE_MENSAGEM_MAXIMA];
+    const uint8_t n = LOTE_AMOSTRAS_MAX - 2;
+    size_t tamanho = lote_codifica(&lote, n, 42, buffer, sizeof(buffer));
+    CONFERE(tamanho > 0);
+    CONFERE_IGUAL(lote_contagem(&lote), LOTE_AMOSTRAS_MAX);
+
+    telemetria_decodificador_t dec;
+    telemetria_cabecalho_t cabecalho;
+    CONFERE(telemetria_decodifica_cabecalho(&dec, buffer, tamanho, &cabecalho));
+    CONFERE_IGUAL(cabecalho.sequencia, 42);
+    CONFERE_IGUAL(cabecalho.contagem, n);
+    CONFERE(cabecalho.flags & TELEMETRIA_FLAG_RESUMO);
+    telemetria_registro_t lido;
+    for (uint32_t i = 0; i < n; i++) {
+        CONFERE(telemetria_proximo(&dec, &lido));
+        CONFERE_IGUAL(lido.instante_ms, 50000 + i * 1000);
+        CONFERE_IGUAL(lido.temperatura_c100, 3600 + (int32_t)i);
+        CONFERE_IGUAL(lido.batimento_bpm, 70 - (int32_t)i);
+        CONFERE_IGUAL(lido.estado, i & 1 ? TELEMETRIA_ALARME_ATIVO : 0);
+    }
+    telemetria_resumo_t resumo_lido, resumo_esperado;
+    CONFERE(telemetria_decodifica_resumo(&dec, &resumo_lido));
+    lote_resumo(&lote, n, &resumo_esperado);
+    CONFERE(memcmp(&resumo_lido, &resumo_esperado, sizeof(resumo_lido)) == 0);
+
+    // Buffer insuficiente ou anel vazio não geram mensagem
+    CONFERE_IGUAL(lote_codifica(&lote, n, 42, buffer, 40), 0);
+    lote_remove(&lote, LOTE_AMOSTRAS_MAX);
+    CONFERE_IGUAL(lote_codifica(&lote, n, 43, buffer, sizeof(buffer)), 0);
+}
+
+int main(void) {
+    sobrescrita();
+    resumo();
+    codificacao();
+    return teste_fim();
+}
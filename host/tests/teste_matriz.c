@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include "teste.h"
+#include "simulacao.h"
+#include "matriz.h"
+
+// Matriz de LEDs: formato das cores para o PIO, ordem em zigue-zague da fita e envio dos quadros à fita
+// simulada (src/pio.c), sem reenviar um quadro igual ao anterior.
+
+#define PINO 7
+
+// G, R e B nos três bytes altos, na ordem em que o PIO os envia; o byte baixo nunca chega à fita
+static void cores(void) {
+    CONFERE_IGUAL(matriz_cor(0x12, 0x34, 0x56), 0x34125600u);
+    CONFERE_IGUAL(matriz_cor(0xFF, 0, 0), 0x00FF0000u);
+    CONFERE_IGUAL(matriz_cor(0, 0xFF, 0), 0xFF000000u);
+    CONFERE_IGUAL(matriz_cor(0, 0, 0xFF), 0x0000FF00u);
+    CONFERE_IGUAL(matriz_cor(0xFF, 0xFF, 0xFF) & 0xFF, 0);
+}
+
+// Cada LED tem uma posição própria; a fita começa no canto inferior direito, e posições seguidas na fita
+// são LEDs vizinhos na matriz
+static void indices(void) {
+    CONFERE_IGUAL(matriz_indice(0, 0), MATRIZ_LEDS - 1);
+    CONFERE_IGUAL(matriz_indice(MATRIZ_LADO - 1, 0), MATRIZ_LEDS - MATRIZ_LADO);
+    CONFERE_IGUAL(matriz_indice(MATRIZ_LADO - 1, 1), MATRIZ_LEDS - MATRIZ_LADO - 1);
+    CONFERE_IGUAL(matriz_indice(MATRIZ_LADO - 1, MATRIZ_LADO - 1), 0);
+
+    int x_de[MATRIZ_LEDS], y_de[MATRIZ_LEDS];
+    bool usado[MATRIZ_LEDS] = {0};
+    for (uint8_t y = 0; y < MATRIZ_LADO; y++) {
+        for (uint8_t x = 0; x < MATRIZ_LADO; x++) {
+            uint8_t i = matriz_indice(x, y);
+            CONFERE(i < MATRIZ_LEDS);
+            if (i < MATRIZ_LEDS) {
+                CONFERE(!usado[i]);
+                usado[i] = true;
+                x_de[i] = x;
+                y_de[i] = y;
+            }
+        }
+    }
+    for (int i = 0; i + 1 < MATRIZ_LEDS; i++) {
+        CONFERE_IGUAL(abs(x_de[i] - x_de[i + 1]) + abs(y_de[i] - y_de[i + 1]), 1);
+    }
+}
+
+// Espera o quadro ocupar a fita e travar, e o confere com a cor esperada de cada LED
+static void confere_fita(const uint32_t esperado[MATRIZ_LEDS], uint32_t quadros) {
+    sleep_us(2000);
+    uint32_t fita[MATRIZ_LEDS + 1];
+    uint tamanho = 0;
+    CONFERE(host_pio_quadro(PINO, fita, MATRIZ_LEDS + 1, &tamanho));
+    CONFERE_IGUAL(tamanho, MATRIZ_LEDS);
+    for (int i = 0; i < MATRIZ_LEDS && i < (int)tamanho; i++) {
+        CONFERE_IGUAL(fita[i], esperado[i]);
+    }
+    uint32_t travados, invalidas;
+    host_pio_estatisticas(PINO, &travados, &invalidas);
+    CONFERE_IGUAL(travados, quadros);
+    CONFERE_IGUAL(invalidas, 0);
+}
+
+static void envio(void) {
+    CONFERE(matriz_init(PINO));
+    uint32_t esperado[MATRIZ_LEDS] = {0};
+    for (uint8_t y = 0; y < MATRIZ_LADO; y++) {
+        for (uint8_t x = 0; x < MATRIZ_LADO; x++) {
+            uint32_t cor = matriz_cor(x * 50, y * 50, (uint8_t)(x + y));
+            matriz_pixel(x, y, cor);
+            esperado[matriz_indice(x, y)] = cor;
+        }
+    }
+    matriz_pixel(MATRIZ_LADO, 0, matriz_cor(1, 1, 1));
+    matriz_pixel(0, MATRIZ_LADO, matriz_cor(1, 1, 1));
+    CONFERE(matriz_envia());
+    confere_fita(esperado, 1);
+
+    // O mesmo quadro não é reenviado
+    CONFERE(!matriz_envia());
+    CONFERE_IGUAL(matriz_quadros_iguais(), 1);
+
+    // Quadros diferentes são enviados e substituem o anterior por inteiro
+    matriz_limpa();
+    matriz_pixel(2, 3, matriz_cor(0, 0, 200));
+    CONFERE(matriz_envia());
+    uint32_t apagado[MATRIZ_LEDS] = {0};
+    apagado[matriz_indice(2, 3)] = matriz_cor(0, 0, 200);
+    confere_fita(apagado, 2);
+
+    matriz_pixel(4, 4, matriz_cor(9, 9, 9));
+    CONFERE(matriz_envia());
+    apagado[matriz_indice(4, 4)] = matriz_cor(9, 9, 9);
+    confere_fita(apagado, 3);
+    CONFERE(!matriz_envia());
+    CONFERE_IGUAL(matriz_quadros_enviados(), 3);
+    CONFERE_IGUAL(matriz_quadros_iguais(), 2);
+}
+
+int main(void) {
+    cores();
+    indices();
+    envio();
+    return teste_fim();
+}
@@ -0,0 +1,219 @@
+#include <math.h>
+#include "teste.h"
+#include "sinais.h"
+
+// Processamento dos sinais vitais, compilado com SINAIS_BATIMENTO_POR_PULSO=1: formas de onda de pulso
+// sintéticas em frequências conhecidas, com onda dicrótica e picos duplos que o período refratário deve
+// descartar, a volta a 0 sem pulso, a resposta ao degrau dos filtros e a conversão da temperatura nos
+// extremos do ADC.
+
+// Um valor decimado por canal a cada 64 conversões de AQ_TAXA_PADRAO_HZ (62,5 Hz)
+#define PERIODO_US (1000000u * AQ_AMOSTRAS_BLOCO / AQ_TAXA_PADRAO_HZ)
+
+// Pico em cosseno levantado centrado em centro_us, com meia largura largura_us
+static double pico(double t_us, double centro_us, double largura_us, double amplitude) {
+    double d = fabs(t_us - centro_us);
+    return d < largura_us ? amplitude * (1 + cos(M_PI * d / largura_us)) / 2 : 0;
+}
+
+typedef struct {
+    double bpm;
+    double amplitude;
+    double segundo_atraso_us;    // Atraso do segundo pico após o sistólico (0 sem segundo pico)
+    double segundo_amplitude;    // Em fração da amplitude do sistólico
+} onda_t;
+
+// Forma de onda de pulso no instante t, sobre uma linha de base que deriva lentamente
+static int32_t amostra_onda(const onda_t *onda, double t_us) {
+    double periodo_us = 60e6 / onda->bpm;
+    double fase_us = fmod(t_us, periodo_us);
+    double valor = 2000 + 150 * sin(2 * M_PI * t_us / 20e6);
+    for (int k = -1; k <= 1; k++) {
+        double centro_us = 100000 + k * periodo_us;
+        valor += pico(fase_us, centro_us, 80000, onda->amplitude);
+        if (onda->segundo_atraso_us) {
+            valor += pico(fase_us, centro_us + onda->segundo_atraso_us, 60000,
+                          onda->amplitude * onda->segundo_amplitude);
+        }
+    }
+    return (int32_t)lround(valor);
+}
+
+static uint32_t instante_us;
+
+// Reproduz a onda por duracao_s e retorna o último BPM
+static int32_t reproduz(detector_pulso_t *detector, const onda_t *onda, double duracao_s) {
+    int32_t bpm = 0;
+    for (uint32_t n = (uint32_t)(duracao_s * 1e6 / PERIODO_US); n > 0; n--) {
+        bpm = detector_pulso_atualiza(detector, amostra_onda(onda, instante_us), instante_us);
+        instante_us += PERIODO_US;
+    }
+    return bpm;
+}
+
+static void novo_detector(detector_pulso_t *detector) {
+    sinais_config_t config;
+    sinais_config_padrao(&config);
+    detector_pulso_init(detector, config.janela_batimento, config.intervalos_batimento);
+    // Começa perto do fim do contador de 32 bits, que dá a volta durante a reprodução
+    instante_us = UINT32_MAX - 5000000u;
+}
+
+static void confere_bpm(int32_t bpm, double esperado, const char *caso) {
+    double tolerancia = esperado / 50 > 1 ? esperado / 50 : 1;
+    if (fabs(bpm - esperado) > tolerancia) {
+        fprintf(stderr, "%s: %ld BPM, esperado %.0f\n", caso, (long)bpm, esperado);
+        teste_falhas++;
+    }
+}
+
+// A frequência é recuperada em toda a faixa clínica, com amplitudes pequenas e grandes
+static void frequencias(void) {
+    const double frequencias_bpm[] = { 35, 45, 60, 72, 100, 150, 180, 210 };
+    for (size_t i = 0; i < sizeof(frequencias_bpm) / sizeof(frequencias_bpm[0]); i++) {
+        for (int amplitude = 80; amplitude <= 1600; amplitude *= 20) {
+            detector_pulso_t detector;
+            novo_detector(&detector);
+            onda_t onda = { .bpm = frequencias_bpm[i], .amplitude = amplitude };
+            confere_bpm(reproduz(&detector, &onda, 20), onda.bpm, "frequencia");
+        }
+    }
+}
+
+// A onda dicrótica e um segundo pico logo após o sistólico caem no período refratário e não contam
+static void periodo_refratario(void) {
+    const onda_t ondas[] = {
+        { .bpm = 60, .amplitude = 600, .segundo_atraso_us = 220000, .segundo_amplitude = 0.9 },
+        { .bpm = 90, .amplitude = 600, .segundo_atraso_us = 200000, .segundo_amplitude = 0.7 },
+        { .bpm = 75, .amplitude = 600, .segundo_atraso_us = 160000, .segundo_amplitude = 1.0 },
+    };
+    for (size_t i = 0; i < sizeof(ondas) / sizeof(ondas[0]); i++) {
+        detector_pulso_t detector;
+        novo_detector(&detector);
+        confere_bpm(reproduz(&detector, &ondas[i], 20), ondas[i].bpm, "refratario");
+    }
+}
+
+// Sem picos por 3 s o BPM volta a 0; um sinal abaixo da amplitude mínima nunca gera estimativa
+static void sem_pulso(void) {
+    detector_pulso_t detector;
+    novo_detector(&detector);
+    onda_t onda = { .bpm = 60, .amplitude = 600 };
+    confere_bpm(reproduz(&detector, &onda, 15), 60, "antes da parada");
+
+    onda_t parado = { .bpm = 60, .amplitude = 0 };
+    uint32_t parada_us = instante_us;
+    CONFERE(reproduz(&detector, &parado, 2) > 0);
+    int32_t bpm = 1;
+    while (bpm && instante_us - parada_us < 10000000u) {
+        bpm = detector_pulso_atualiza(&detector, amostra_onda(&parado, instante_us), instante_us);
+        instante_us += PERIODO_US;
+    }
+    // O último pico ficou até um período antes da parada
+    uint32_t sem_pulso_us = instante_us - parada_us;
+    CONFERE(sem_pulso_us >= 3000000u - 1000000u && sem_pulso_us <= 3000000u + 2 * PERIODO_US);
+    CONFERE_IGUAL(reproduz(&detector, &parado, 5), 0);
+
+    // O pulso volta e a estimativa também
+    confere_bpm(reproduz(&detector, &onda, 10), 60, "retomada");
+
+    novo_detector(&detector);
+    onda_t fraca = { .bpm = 60, .amplitude = 10 };
+    CONFERE_IGUAL(reproduz(&detector, &fraca, 20), 0);
+}
+
+// Passa-baixa: a primeira amostra inicia o estado, o degrau segue 1 - (1 - alfa)^n e o estado em Q8
+// alcança o valor final exato, nos dois sentidos
+static void passa_baixa(void) {
+    passa_baixa_t filtro;
+    const uint16_t alfa_q15 = 1638;
+    passa_baixa_init(&filtro, alfa_q15);
+    CONFERE_IGUAL(passa_baixa_atualiza(&filtro, 100), 100);
+    double alfa = alfa_q15 / 32768.0;
+    int divergentes = 0;
+    for (int n = 1; n <= 40; n++) {
+        int32_t saida = passa_baixa_atualiza(&filtro, 1100);
+        double esperado = 100 + 1000 * (1 - pow(1 - alfa, n));
+        divergentes += fabs(saida - esperado) > 1.5;
+    }
+    CONFERE_IGUAL(divergentes, 0);
+    int32_t saida = 0;
+    for (int n = 0; n < 400; n++) {
+        saida = passa_baixa_atualiza(&filtro, 1100);
+    }
+    CONFERE_IGUAL(saida, 1100);
+    for (int n = 0; n < 400; n++) {
+        saida = passa_baixa_atualiza(&filtro, -4095 * 16);
+    }
+    CONFERE_IGUAL(saida, -4095 * 16);
+
+    // Com alfa 1 a saída é a entrada
+    passa_baixa_init(&filtro, 32767);
+    passa_baixa_atualiza(&filtro, 0);
+    for (int n = 0; n < 3; n++) {
+        saida = passa_baixa_atualiza(&filtro, 4095 << 4);
+    }
+    CONFERE_IGUAL(saida, 4095 << 4);
+}
+
+// Média móvel: enquanto a janela enche, média das amostras recebidas; o degrau leva exatamente a janela
+static void media_movel(void) {
+    media_movel_t media;
+    media_movel_init(&media, 8);
+    CONFERE_IGUAL(media_movel_atualiza(&media, 40), 40);
+    CONFERE_IGUAL(media_movel_atualiza(&media, 20), 30);
+    for (int n = 2; n < 8; n++) {
+        media_movel_atualiza(&media, 0);
+    }
+    CONFERE_IGUAL(media_movel_atualiza(&media, 800), (20 + 800) / 8);
+    for (int n = 2; n <= 8; n++) {
+        CONFERE_IGUAL(media_movel_atualiza(&media, 800), 800 * n / 8);
+    }
+    CONFERE_IGUAL(media_movel_atualiza(&media, 800), 800);
+
+    // Janelas fora dos limites
+    media_movel_init(&media, 0);
+    media_movel_atualiza(&media, 5);
+    CONFERE_IGUAL(media_movel_atualiza(&media, 9), 9);
+    media_movel_init(&media, 200);
+    CONFERE_IGUAL(media.tamanho, SINAIS_JANELA_MAX);
+}
+
+// Temperatura para um valor constante do ADC, depois de os filtros assentarem
+static int32_t temperatura_c100(uint16_t adc) {
+    sinais_config_t config;
+    sinais_config_padrao(&config);
+    sinais_init(&config);
+    aq_leitura_t leitura = { .valor = { [AQ_CANAL_BATIMENTO] = 2048, [AQ_CANAL_TEMPERATURA] = adc } };
+    for (int n = 0; n < 50; n++) {
+        leitura.sequencia = n;
+        leitura.instante_us = n * PERIODO_US;
+        sinais_processa(&leitura);
+    }
+    sinais_leitura_t resultado;
+    sinais_leitura(&resultado);
+    CONFERE_IGUAL(resultado.sequencia, 49);
+    return resultado.temperatura_c100;
+}
+
+// 16 a 4081 do joystick cobrem de 26 a 46 °C; os extremos do ADC ficam um pouco além, sem estouro
+static void temperatura(void) {
+    CONFERE_IGUAL(temperatura_c100(16), 2600);
+    int32_t maxima = temperatura_c100(4081);
+    CONFERE(maxima >= 4599 && maxima <= 4600);
+    int32_t zero = temperatura_c100(0);
+    CONFERE(zero >= 2592 && zero <= 2593);
+    int32_t topo = temperatura_c100(4095);
+    CONFERE(topo >= 4606 && topo <= 4607);
+    CONFERE_IGUAL(temperatura_c100(2048), 2600 + (int32_t)((2048 - 16) * 2000 / 4065));
+}
+
+int main(void) {
+    frequencias();
+    periodo_refratario();
+    sem_pulso();
+    passa_baixa();
+    media_movel();
+    temperatura();
+    return teste_fim();
+}
@@ -0,0 +1,229 @@
+#include <string.h>
+#include "teste.h"
+#include "simulacao.h"
+#include "ssd1306.h"
+
+// Janelas de envio parcial do SSD1306: agrupamento das páginas alteradas e o custo que decide a união.
+// Envio por DMA: fim no último STOP, aborto do I2C (alvo sem ACK) e prazo com o barramento preso.
+
+static ssd1306_t ssd;
+
+static void novo_display(void) {
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, i2c0);
+}
+
+// Marca as colunas x0..x1 da página como alteradas, mudando um bit de cada byte
+static void altera(uint8_t x0, uint8_t x1, uint8_t pagina) {
+    for (uint8_t x = x0; x <= x1; x++) {
+        ssd1306_pixel(&ssd, x, (uint8_t)(pagina * 8), true);
+    }
+}
+
+static void confere_janela(const ssd1306_window_t *janela, uint8_t x0, uint8_t x1, uint8_t pagina0, uint8_t pagina1) {
+    CONFERE_IGUAL(janela->x0, x0);
+    CONFERE_IGUAL(janela->x1, x1);
+    CONFERE_IGUAL(janela->page0, pagina0);
+    CONFERE_IGUAL(janela->page1, pagina1);
+}
+
+static void display_limpo(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    novo_display();
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 0);
+}
+
+static void um_byte(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    novo_display();
+    altera(10, 10, 2);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 1);
+    confere_janela(&janelas[0], 10, 10, 2, 2);
+}
+
+// Mesmas colunas em páginas vizinhas: a união não envia nenhum byte a mais
+static void paginas_vizinhas_unidas(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    novo_display();
+    altera(20, 30, 3);
+    altera(22, 28, 4);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 1);
+    confere_janela(&janelas[0], 20, 30, 3, 4);
+}
+
+// Colunas distantes em páginas vizinhas: separadas custam 2 + 8 + SSD1306_WINDOW_OVERHEAD bytes, a
+// união custaria 2 * 128
+static void paginas_vizinhas_separadas(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    novo_display();
+    altera(0, 1, 0);
+    altera(120, 127, 1);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 2);
+    confere_janela(&janelas[0], 0, 1, 0, 0);
+    confere_janela(&janelas[1], 120, 127, 1, 1);
+}
+
+// No limite do custo: a união vale enquanto não passa dos bytes separados mais o custo de uma janela
+static void limite_do_custo(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    // Separadas: 10 + 1 + 10 = 21; unidas: 2 * 10 = 20
+    novo_display();
+    altera(0, 9, 5);
+    altera(9, 9, 6);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 1);
+    // Separadas: 1 + 1 + 10 = 12; unidas: 2 * 12 = 24
+    novo_display();
+    altera(0, 0, 5);
+    altera(11, 11, 6);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 2);
+}
+
+// Páginas não vizinhas nunca são unidas
+static void paginas_distantes(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    novo_display();
+    altera(5, 5, 1);
+    altera(5, 5, 3);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 2);
+    confere_janela(&janelas[0], 5, 5, 1, 1);
+    confere_janela(&janelas[1], 5, 5, 3, 3);
+}
+
+// Sem espaço para mais janelas, a última é estendida até cobrir as páginas restantes
+static void limite_de_janelas(void) {
+    ssd1306_window_t janelas[2];
+    novo_display();
+    altera(0, 0, 0);
+    altera(100, 100, 2);
+    altera(50, 50, 4);
+    altera(127, 127, 6);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, 2), 2);
+    confere_janela(&janelas[0], 0, 0, 0, 0);
+    confere_janela(&janelas[1], 50, 127, 2, 6);
+}
+
+// O envio parcial manda só os bytes das janelas, cada uma com o endereçamento em uma transação, e limpa
+// as marcações
+static void envio_parcial(void) {
+    ssd1306_window_t janelas[SSD1306_MAX_PAGES];
+    novo_display();
+    altera(40, 49, 7);
+    uint32_t transacoes_antes, bytes_antes, transacoes, bytes;
+    host_i2c_estatisticas(&transacoes_antes, &bytes_antes);
+    CONFERE_IGUAL(ssd1306_send_dirty(&ssd), 10);
+    host_i2c_estatisticas(&transacoes, &bytes);
+    CONFERE_IGUAL(transacoes - transacoes_antes, 2);
+    CONFERE_IGUAL(bytes - bytes_antes, 7 + 1 + 10);
+    CONFERE_IGUAL(ssd1306_dirty_windows(&ssd, janelas, SSD1306_MAX_PAGES), 0);
+}
+
+static uint32_t envios_ok, envios_falhos;
+
+static void conta_envio(ssd1306_t *display, bool ok, void *dados) {
+    (void)display;
+    (void)dados;
+    if (ok) {
+        envios_ok++;
+    } else {
+        envios_falhos++;
+    }
+}
+
+static void novo_display_dma(void) {
+    novo_display();
+    CONFERE(ssd1306_init_dma(&ssd));
+    ssd1306_set_flush_callback(&ssd, conta_envio, NULL);
+    envios_ok = envios_falhos = 0;
+}
+
+// Diferença de bytes e transações no barramento desde a última chamada
+static void barramento(uint32_t *transacoes, uint32_t *bytes) {
+    static uint32_t transacoes_antes, bytes_antes;
+    uint32_t t, b;
+    host_i2c_estatisticas(&t, &b);
+    *transacoes = t - transacoes_antes;
+    *bytes = b - bytes_antes;
+    transacoes_antes = t;
+    bytes_antes = b;
+}
+
+// O envio por DMA manda os mesmos bytes do bloqueante e só termina no STOP da última janela
+static void envio_assincrono(void) {
+    uint32_t transacoes, bytes;
+    novo_display_dma();
+    altera(40, 49, 7);
+    altera(0, 0, 1);
+    barramento(&transacoes, &bytes);
+    CONFERE(ssd1306_send_dirty_async(&ssd));
+    CONFERE(ssd1306_busy(&ssd));
+    CONFERE(!ssd1306_send_dirty_async(&ssd));
+    CONFERE(ssd1306_wait_idle(&ssd));
+    CONFERE(!ssd1306_busy(&ssd));
+    barramento(&transacoes, &bytes);
+    CONFERE_IGUAL(transacoes, 4);
+    CONFERE_IGUAL(bytes, 7 + 1 + 10 + 7 + 1 + 1);
+    CONFERE_IGUAL(envios_ok, 1);
+    CONFERE_IGUAL(envios_falhos, 0);
+}
+
+// Alvo sem ACK: o aborto é detectado pela interrupção, sem esperar o prazo, e o envio seguinte manda a
+// tela inteira, já que o quadro abortado ficou incompleto no display
+static void envio_abortado(void) {
+    uint32_t transacoes, bytes;
+    novo_display_dma();
+    altera(40, 49, 7);
+    host_i2c_nack(i2c0, true);
+    uint32_t inicio = time_us_32();
+    CONFERE(ssd1306_send_dirty_async(&ssd));
+    CONFERE(!ssd1306_wait_idle(&ssd));
+    CONFERE(time_us_32() - inicio < SSD1306_TIMEOUT_US);
+    CONFERE(!ssd1306_busy(&ssd));
+    CONFERE_IGUAL(ssd.aborts, 1);
+    CONFERE_IGUAL(envios_falhos, 1);
+
+    host_i2c_nack(i2c0, false);
+    barramento(&transacoes, &bytes);
+    CONFERE(ssd1306_send_dirty_async(&ssd));
+    CONFERE(ssd1306_wait_idle(&ssd));
+    barramento(&transacoes, &bytes);
+    CONFERE_IGUAL(transacoes, 2);
+    CONFERE_IGUAL(bytes, 7 + 1 + WIDTH * HEIGHT / 8);
+    CONFERE_IGUAL(envios_ok, 1);
+}
+
+// Barramento preso: nenhum byte avança, o prazo cancela o envio e o próximo manda a tela inteira
+static void barramento_preso(void) {
+    uint32_t transacoes, bytes;
+    novo_display_dma();
+    altera(0, 0, 0);
+    host_i2c_preso(i2c0, true);
+    uint32_t inicio = time_us_32();
+    CONFERE(ssd1306_send_dirty_async(&ssd));
+    CONFERE(!ssd1306_wait_idle(&ssd));
+    CONFERE(time_us_32() - inicio >= SSD1306_TIMEOUT_US);
+    CONFERE(!ssd1306_busy(&ssd));
+    CONFERE_IGUAL(ssd.aborts, 1);
+
+    host_i2c_preso(i2c0, false);
+    barramento(&transacoes, &bytes);
+    CONFERE(ssd1306_send_dirty_async(&ssd));
+    CONFERE(ssd1306_wait_idle(&ssd));
+    barramento(&transacoes, &bytes);
+    CONFERE_IGUAL(bytes, 7 + 1 + WIDTH * HEIGHT / 8);
+    CONFERE_IGUAL(envios_ok, 1);
+}
+
+int main(void) {
+    display_limpo();
+    um_byte();
+    paginas_vizinhas_unidas();
+    paginas_vizinhas_separadas();
+    limite_do_custo();
+    paginas_distantes();
+    limite_de_janelas();
+    envio_parcial();
+    i2c_init(i2c0, 400 * 1000);
+    envio_assincrono();
+    envio_abortado();
+    barramento_preso();
+    return teste_fim();
+}
@@ -0,0 +1,201 @@
+#include <string.h>
+#include "teste.h"
+#include "pico/stdlib.h"
+#include "telemetria.h"
+
+// Formato binário da telemetria: bytes exatos de uma mensagem conhecida, ida e volta com os extremos do
+// varint e do zigzag, buffer cheio e mensagens truncadas. Por último, o custo de codificar um registro,
+// comparado ao texto com snprintf("%.2f") que o formato substituiu; os tempos são só impressos.
+
+#define MEDICOES 200000
+
+static void confere_registro(const telemetria_registro_t *lido, const telemetria_registro_t *esperado) {
+    CONFERE_IGUAL(lido->instante_ms, esperado->instante_ms);
+    CONFERE_IGUAL(lido->temperatura_c100, esperado->temperatura_c100);
+    CONFERE_IGUAL(lido->batimento_bpm, esperado->batimento_bpm);
+    CONFERE_IGUAL(lido->estado, esperado->estado);
+}
+
+// Cabeçalho (versão, flags, contagem, sequência 1, base 300) e um registro: delta 5, 36,50 °C (zigzag
+// 7300), 75 BPM (zigzag 150) e alarme ativo
+static void bytes_conhecidos(void) {
+    const uint8_t esperado[] = { 1, 0, 1, 0x01, 0xAC, 0x02, 0x05, 0x84, 0x39, 0x96, 0x01, 0x01 };
+    uint8_t buffer[64];
+    telemetria_codificador_t cod;
+    CONFERE(telemetria_inicia(&cod, buffer, sizeof(buffer), 1, 300));
+    telemetria_registro_t registro = { .instante_ms = 305, .temperatura_c100 = 3650, .batimento_bpm = 75,
+                                       .estado = TELEMETRIA_ALARME_ATIVO };
+    CONFERE(telemetria_adiciona(&cod, &registro));
+    CONFERE_IGUAL(telemetria_finaliza(&cod), sizeof(esperado));
+    CONFERE(memcmp(buffer, esperado, sizeof(esperado)) == 0);
+}
+
+// Extremos de cada campo: os varints de 5 bytes e os negativos do zigzag voltam iguais
+static void ida_e_volta(void) {
+    const telemetria_registro_t registros[] = {
+        { 0, 0, 0, 0 },
+        { 1, -1, 1, TELEMETRIA_ALARME_MEDICO },
+        { 128, 63, -64, TELEMETRIA_ALARME_MANUAL },
+        { 16512, 64, -65, 0xFF },
+        { 0x7FFFFFFF, INT32_MAX, INT32_MIN, 0 },
+        { UINT32_MAX, INT32_MIN, INT32_MAX, TELEMETRIA_ALARME_ATIVO },
+    };
+    const size_t quantidade = sizeof(registros) / sizeof(registros[0]);
+    const telemetria_resumo_t resumo = { INT32_MIN, INT32_MAX, -1, 0, 1, -2 };
+    uint8_t buffer[TELEMETRIA_CABECALHO_MAXIMO + 6 * TELEMETRIA_REGISTRO_MAXIMO + TELEMETRIA_RESUMO_MAXIMO];
+
+    telemetria_codificador_t cod;
+    CONFERE(telemetria_inicia(&cod, buffer, sizeof(buffer), UINT32_MAX, 0));
+    for (size_t i = 0; i < quantidade; i++) {
+        size_t antes = cod.tamanho;
+        CONFERE(telemetria_adiciona(&cod, &registros[i]));
+        CONFERE(cod.tamanho - antes <= TELEMETRIA_REGISTRO_MAXIMO);
+    }
+    size_t antes = cod.tamanho;
+    CONFERE(telemetria_adiciona_resumo(&cod, &resumo));
+    CONFERE(cod.tamanho - antes <= TELEMETRIA_RESUMO_MAXIMO);
+    CONFERE(!telemetria_adiciona(&cod, &registros[0]));
+    size_t tamanho = telemetria_finaliza(&cod);
+
+    telemetria_decodificador_t dec;
+    telemetria_cabecalho_t cabecalho;
+    CONFERE(telemetria_decodifica_cabecalho(&dec, buffer, tamanho, &cabecalho));
+    CONFERE_IGUAL(cabecalho.sequencia, UINT32_MAX);
+    CONFERE_IGUAL(cabecalho.contagem, quantidade);
+    CONFERE_IGUAL(cabecalho.flags, TELEMETRIA_FLAG_RESUMO);
+    telemetria_registro_t lido;
+    for (size_t i = 0; i < quantidade; i++) {
+        CONFERE(telemetria_proximo(&dec, &lido));
+        confere_registro(&lido, &registros[i]);
+    }
+    CONFERE(!telemetria_proximo(&dec, &lido));
+    telemetria_resumo_t resumo_lido;
+    CONFERE(telemetria_decodifica_resumo(&dec, &resumo_lido));
+    CONFERE(memcmp(&resumo_lido, &resumo, sizeof(resumo)) == 0);
+    CONFERE_IGUAL(dec.posicao, tamanho);
+}
+
+// Um registro que não cabe é recusado sem alterar a mensagem, que continua decodificável
+static void buffer_cheio(void) {
+    uint8_t buffer[20];
+    telemetria_codificador_t cod;
+    CONFERE(telemetria_inicia(&cod, buffer, sizeof(buffer), 7, 1000));
+    telemetria_registro_t registro = { .instante_ms = 1000, .temperatura_c100 = 3650, .batimento_bpm = 75 };
+    size_t aceitos = 0;
+    while (telemetria_adiciona(&cod, &registro)) {
+        aceitos++;
+        registro.instante_ms += 100;
+    }
+    size_t tamanho = telemetria_finaliza(&cod);
+    CONFERE(tamanho <= sizeof(buffer));
+    CONFERE_IGUAL(aceitos, 2);
+
+    telemetria_decodificador_t dec;
+    telemetria_cabecalho_t cabecalho;
+    telemetria_registro_t lido;
+    CONFERE(telemetria_decodifica_cabecalho(&dec, buffer, tamanho, &cabecalho));
+    size_t lidos = 0;
+    while (telemetria_proximo(&dec, &lido)) {
+        lidos++;
+    }
+    CONFERE_IGUAL(lidos, aceitos);
+    CONFERE(!telemetria_inicia(&cod, buffer, 2, 0, 0));
+}
+
+// Nenhum prefixo de uma mensagem válida é lido além do fim nem devolve todos os registros
+static void mensagem_truncada(void) {
+    uint8_t buffer[64];
+    telemetria_codificador_t cod;
+    CONFERE(telemetria_inicia(&cod, buffer, sizeof(buffer), 300, 123456));
+    telemetria_registro_t registro = { .instante_ms = 123456, .temperatura_c100 = -4000, .batimento_bpm = 200 };
+    CONFERE(telemetria_adiciona(&cod, &registro));
+    registro.instante_ms += 70000;
+    CONFERE(telemetria_adiciona(&cod, &registro));
+    telemetria_resumo_t resumo = { -4000, -4000, -4000, 200, 200, 200 };
+    CONFERE(telemetria_adiciona_resumo(&cod, &resumo));
+    size_t tamanho = telemetria_finaliza(&cod);
+
+    for (size_t n = 0; n < tamanho; n++) {
+        telemetria_decodificador_t dec;
+        telemetria_cabecalho_t cabecalho;
+        telemetria_registro_t lido;
+        bool completa = telemetria_decodifica_cabecalho(&dec, buffer, n, &cabecalho);
+        if (completa) {
+            completa = telemetria_proximo(&dec, &lido) && telemetria_proximo(&dec, &lido) &&
+                       telemetria_decodifica_resumo(&dec, &resumo);
+            CONFERE(dec.posicao <= n);
+        }
+        CONFERE(!completa);
+    }
+
+    // Outra versão do formato é recusada
+    buffer[0] = TELEMETRIA_VERSAO + 1;
+    telemetria_decodificador_t dec;
+    telemetria_cabecalho_t cabecalho;
+    CONFERE(!telemetria_decodifica_cabecalho(&dec, buffer, tamanho, &cabecalho));
+}
+
+// Registro de um ciclo com valores variando como os de um paciente
+static telemetria_registro_t registro_medido(uint32_t i) {
+    telemetria_registro_t registro = { .instante_ms = 1000000 + i * 500,
+                                       .temperatura_c100 = 3500 + (int32_t)(i * 7 % 300),
+                                       .batimento_bpm = 55 + (int32_t)(i % 90),
+                                       .estado = (i % 16) ? 0 : TELEMETRIA_ALARME_ATIVO };
+    return registro;
+}
+
+// Tempo e bytes por registro: uma mensagem binária por registro (o envio a cada ciclo), registros em
+// lotes de 32 na mesma mensagem, e o texto "sequência,instante_ms,temperatura,bpm,estado" com a
+// temperatura em "%.2f"
+static void custo_por_registro(void) {
+    uint8_t buffer[TELEMETRIA_CABECALHO_MAXIMO + 32 * TELEMETRIA_REGISTRO_MAXIMO];
+    char texto[64];
+    size_t bytes_unico = 0, bytes_lote = 0, bytes_texto = 0;
+    telemetria_codificador_t cod;
+
+    uint64_t inicio = time_us_64();
+    for (uint32_t i = 0; i < MEDICOES; i++) {
+        telemetria_registro_t registro = registro_medido(i);
+        telemetria_inicia(&cod, buffer, sizeof(buffer), i, registro.instante_ms);
+        telemetria_adiciona(&cod, &registro);
+        bytes_unico += telemetria_finaliza(&cod);
+    }
+    double ns_unico = (time_us_64() - inicio) * 1000.0 / MEDICOES;
+
+    inicio = time_us_64();
+    for (uint32_t i = 0; i < MEDICOES; i += 32) {
+        telemetria_inicia(&cod, buffer, sizeof(buffer), i, registro_medido(i).instante_ms);
+        for (uint32_t j = i; j < i + 32; j++) {
+            telemetria_registro_t registro = registro_medido(j);
+            telemetria_adiciona(&cod, &registro);
+        }
+        bytes_lote += telemetria_finaliza(&cod);
+    }
+    double ns_lote = (time_us_64() - inicio) * 1000.0 / MEDICOES;
+
+    inicio = time_us_64();
+    for (uint32_t i = 0; i < MEDICOES; i++) {
+        telemetria_registro_t registro = registro_medido(i);
+        float temperatura = registro.temperatura_c100 / 100.0f;
+        bytes_texto += snprintf(texto, sizeof(texto), "%lu,%lu,%.2f,%ld,%u", (unsigned long)i,
+                                (unsigned long)registro.instante_ms, temperatura,
+                                (long)registro.batimento_bpm, registro.estado);
+    }
+    double ns_texto = (time_us_64() - inicio) * 1000.0 / MEDICOES;
+
+    // Confere que os três laços produziram mensagens de tamanho plausível
+    CONFERE(bytes_unico > 0 && bytes_lote < bytes_unico && bytes_texto > bytes_unico);
+
+    printf("binario, um registro por mensagem: %.0f ns, %.1f bytes\n", ns_unico, (double)bytes_unico / MEDICOES);
+    printf("binario, 32 registros por mensagem: %.0f ns, %.1f bytes\n", ns_lote, (double)bytes_lote / MEDICOES);
+    printf("texto com snprintf(\"%%.2f\"): %.0f ns, %.1f bytes\n", ns_texto, (double)bytes_texto / MEDICOES);
+}
+
+int main(void) {
+    bytes_conhecidos();
+    ida_e_volta();
+    buffer_cheio();
+    mensagem_truncada();
+    custo_por_registro();
+    return teste_fim();
+}
@@ -0,0 +1,59 @@
+#include "agendador.h"
+#include "log.h"
+
+static void agenda_em(agendador_tarefa_t *tarefa, absolute_time_t instante) {
+    tarefa->previsto = instante;
+    async_context_remove_at_time_worker(tarefa->contexto, &tarefa->worker);
+    async_context_add_at_time_worker_at(tarefa->contexto, &tarefa->worker, instante);
+}
+
+static void agendador_worker_fn(async_context_t *contexto, async_at_time_worker_t *worker) {
+    agendador_tarefa_t *tarefa = (agendador_tarefa_t *)worker->user_data;
+    absolute_time_t previsto = tarefa->previsto;
+    absolute_time_t inicio = get_absolute_time();
+
+    int64_t atraso_us = absolute_time_diff_us(previsto, inicio);
+    if (atraso_us > (int64_t)tarefa->atraso_max_us) {
+        tarefa->atraso_max_us = atraso_us > UINT32_MAX ? UINT32_MAX : (uint32_t)atraso_us;
+    }
+    tarefa->execucoes++;
+
+    tarefa->executa(tarefa);
+
+    int64_t duracao_us = absolute_time_diff_us(inicio, get_absolute_time());
+    if (duracao_us > (int64_t)tarefa->duracao_max_us) {
+        tarefa->duracao_max_us = duracao_us > UINT32_MAX ? UINT32_MAX : (uint32_t)duracao_us;
+    }
+
+    // A própria execução pode ter agendado ou disparado a tarefa novamente
+    if (to_us_since_boot(tarefa->previsto) != to_us_since_boot(previsto) || tarefa->periodo_ms == 0) {
+        return;
+    }
+    absolute_time_t proximo = delayed_by_ms(previsto, tarefa->periodo_ms);
+    if (absolute_time_diff_us(inicio, proximo) <= 0) {
+        proximo = delayed_by_ms(inicio, tarefa->periodo_ms);
+    }
+    agenda_em(tarefa, proximo);
+}
+
+void agendador_inicia(agendador_tarefa_t *tarefa, async_context_t *contexto, uint32_t atraso_ms) {
+    tarefa->contexto = contexto;
+    tarefa->worker.do_work = agendador_worker_fn;
+    tarefa->worker.user_data = tarefa;
+    agenda_em(tarefa, make_timeout_time_ms(atraso_ms));
+}
+
+void agendador_agenda(agendador_tarefa_t *tarefa, uint32_t ms) {
+    agenda_em(tarefa, make_timeout_time_ms(ms));
+}
+
+void agendador_dispara(agendador_tarefa_t *tarefa) {
+    tarefa->disparos++;
+    agenda_em(tarefa, get_absolute_time());
+}
+
+void agendador_imprime(const agendador_tarefa_t *tarefa) {
+    LOG_TEXTO(LOG_INFO, "Tarefa %s: %lu execuções (%lu por evento), atraso máximo %lu us, duração máxima %lu us\n",
+              tarefa->nome, (unsigned long)tarefa->execucoes, (unsigned long)tarefa->disparos,
+              (unsigned long)tarefa->atraso_max_us, (unsigned long)tarefa->duracao_max_us);
+}
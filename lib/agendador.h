@@ -0,0 +1,50 @@
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/async_context.h"
+
+// Tarefas periódicas sobre um async context, cada uma com o seu período, mais o disparo imediato por evento.
+// A cadência é mantida a partir do instante previsto, sem acumular o atraso de cada execução; se uma
+// execução atrasar mais de um período, a seguinte recomeça a contagem a partir do seu início.
+// As funções devem ser chamadas no núcleo do async context da tarefa (dentro de um worker ou com o lock).
+
+typedef struct agendador_tarefa agendador_tarefa_t;
+
+struct agendador_tarefa {
+    async_at_time_worker_t worker;
+    const char *nome;
+    void (*executa)(agendador_tarefa_t *tarefa);
+    void *dados;
+    uint32_t periodo_ms;          // 0: executa apenas quando agendada ou disparada
+    async_context_t *contexto;
+    absolute_time_t previsto;     // Início previsto da próxima execução
+
+    uint32_t execucoes;
+    uint32_t disparos;            // Execuções antecipadas por evento
+    uint32_t atraso_max_us;       // Pior atraso entre o instante previsto e o início da execução
+    uint32_t duracao_max_us;      // Execução mais longa
+};
+
+#define AGENDADOR_TAREFA(nome_tarefa, funcao, periodo) \
+    { .nome = (nome_tarefa), .executa = (funcao), .periodo_ms = (periodo) }
+
+// Associa a tarefa ao contexto e agenda a primeira execução após atraso_ms
+void agendador_inicia(agendador_tarefa_t *tarefa, async_context_t *contexto, uint32_t atraso_ms);
+
+// Agenda uma execução após ms, substituindo a que estava agendada
+void agendador_agenda(agendador_tarefa_t *tarefa, uint32_t ms);
+
+// Executa a tarefa assim que o contexto estiver livre; a cadência periódica recomeça a partir daí
+void agendador_dispara(agendador_tarefa_t *tarefa);
+
+// Novo período, aplicado a partir da próxima execução
+static inline void agendador_set_periodo(agendador_tarefa_t *tarefa, uint32_t periodo_ms) {
+    tarefa->periodo_ms = periodo_ms;
+}
+
+// Mostra as contagens e os piores tempos da tarefa no log, depois dos registros pendentes (núcleo 0)
+void agendador_imprime(const agendador_tarefa_t *tarefa);
+
+#endif
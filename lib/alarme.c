@@ -0,0 +1,87 @@
+#include "alarme.h"
+
+static void limite_init(alarme_limite_t *limite, int32_t minimo, int32_t maximo, int32_t histerese) {
+    limite->minimo = minimo;
+    limite->maximo = maximo;
+    limite->histerese = histerese;
+    limite->fora = false;
+}
+
+// Entra no alarme ao cruzar o limite; só sai quando o valor volta para dentro da faixa com a folga da histerese
+static bool limite_avalia(alarme_limite_t *limite, int32_t valor) {
+    if (limite->fora) {
+        // Em faixas mais estreitas que duas histereses a folga é reduzida para que a saída seja possível
+        int32_t folga = limite->histerese;
+        if (2 * folga > limite->maximo - limite->minimo) {
+            folga = (limite->maximo - limite->minimo) / 2;
+        }
+        if (valor >= limite->minimo + folga && valor <= limite->maximo - folga) {
+            limite->fora = false;
+        }
+    } else if (valor < limite->minimo || valor > limite->maximo) {
+        limite->fora = true;
+    }
+    return limite->fora;
+}
+
+// Recalcula o estado combinado e informa a borda, se houver
+static alarme_evento_t alarme_atualiza(alarme_t *alarme) {
+    bool ativo = alarme->medico || alarme->manual;
+    if (ativo == alarme->ativo) {
+        return ALARME_SEM_MUDANCA;
+    }
+    alarme->ativo = ativo;
+    return ativo ? ALARME_ATIVADO : ALARME_LIBERADO;
+}
+
+void alarme_init(alarme_t *alarme, int32_t temp_min_c100, int32_t temp_max_c100, int32_t bpm_min, int32_t bpm_max) {
+    limite_init(&alarme->temperatura, temp_min_c100, temp_max_c100, ALARME_HISTERESE_TEMPERATURA_C100);
+    limite_init(&alarme->batimento, bpm_min, bpm_max, ALARME_HISTERESE_BATIMENTO);
+    alarme->tempo_disparo_ms = ALARME_TEMPO_DISPARO_MS;
+    alarme->tempo_liberacao_ms = ALARME_TEMPO_LIBERACAO_MS;
+    alarme->medico = false;
+    alarme->manual = false;
+    alarme->ativo = false;
+    alarme->em_transicao = false;
+    alarme->desde_ms = 0;
+}
+
+void alarme_set_faixa_temperatura(alarme_t *alarme, int32_t minimo_c100, int32_t maximo_c100) {
+    alarme->temperatura.minimo = minimo_c100;
+    alarme->temperatura.maximo = maximo_c100;
+}
+
+void alarme_set_faixa_batimento(alarme_t *alarme, int32_t minimo, int32_t maximo) {
+    alarme->batimento.minimo = minimo;
+    alarme->batimento.maximo = maximo;
+}
+
+// Avalia uma amostra. A condição precisa persistir pelo tempo mínimo antes de mudar o alarme médico.
+alarme_evento_t alarme_avalia(alarme_t *alarme, int32_t temperatura_c100, int32_t batimento_bpm, uint32_t agora_ms) {
+    bool temperatura_fora = limite_avalia(&alarme->temperatura, temperatura_c100);
+    bool batimento_fora = limite_avalia(&alarme->batimento, batimento_bpm);
+    bool violacao = temperatura_fora || batimento_fora;
+
+    if (violacao == alarme->medico) {
+        alarme->em_transicao = false; // A condição voltou antes do tempo mínimo
+        return ALARME_SEM_MUDANCA;
+    }
+    if (!alarme->em_transicao) {
+        alarme->em_transicao = true;
+        alarme->desde_ms = agora_ms;
+    }
+
+    uint32_t espera_ms = violacao ? alarme->tempo_disparo_ms : alarme->tempo_liberacao_ms;
+    if (agora_ms - alarme->desde_ms < espera_ms) {
+        return ALARME_SEM_MUDANCA;
+    }
+    alarme->medico = violacao;
+    alarme->em_transicao = false;
+    return alarme_atualiza(alarme);
+}
+
+// O alarme manual não tem tempo mínimo: o botão age imediatamente
+alarme_evento_t alarme_set_manual(alarme_t *alarme, bool ativo) {
+    alarme->manual = ativo;
+    return alarme_atualiza(alarme);
+}
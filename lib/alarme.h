@@ -0,0 +1,66 @@
+#ifndef ALARME_H
+#define ALARME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Histerese padrão de cada limite: para sair do alarme o valor precisa voltar para dentro da faixa com essa folga
+#ifndef ALARME_HISTERESE_TEMPERATURA_C100
+#define ALARME_HISTERESE_TEMPERATURA_C100 20   // 0,2 °C
+#endif
+#ifndef ALARME_HISTERESE_BATIMENTO
+#define ALARME_HISTERESE_BATIMENTO 3           // 3 BPM
+#endif
+
+// Tempo contínuo fora da faixa antes de disparar e dentro da faixa antes de liberar
+#ifndef ALARME_TEMPO_DISPARO_MS
+#define ALARME_TEMPO_DISPARO_MS 2000
+#endif
+#ifndef ALARME_TEMPO_LIBERACAO_MS
+#define ALARME_TEMPO_LIBERACAO_MS 5000
+#endif
+
+// Faixa normal de um sinal, com banda de histerese própria
+typedef struct {
+    int32_t minimo;
+    int32_t maximo;
+    int32_t histerese;
+    bool fora;          // Fora da faixa, já considerando a histerese
+} alarme_limite_t;
+
+// Mudança no estado combinado (médico ou manual) do alarme
+typedef enum {
+    ALARME_SEM_MUDANCA = 0,
+    ALARME_ATIVADO,
+    ALARME_LIBERADO
+} alarme_evento_t;
+
+typedef struct {
+    alarme_limite_t temperatura;   // Centésimos de grau Celsius
+    alarme_limite_t batimento;     // BPM
+    uint32_t tempo_disparo_ms;
+    uint32_t tempo_liberacao_ms;
+    bool medico;                   // Alarme médico confirmado (após os tempos mínimos)
+    bool manual;                   // Alarme manual, acionado pelo botão
+    bool ativo;                    // Estado combinado já sinalizado
+    bool em_transicao;             // Condição atual diverge de medico e está sendo cronometrada
+    uint32_t desde_ms;             // Início da condição divergente
+} alarme_t;
+
+// Inicializa com as faixas dadas e os tempos e histereses padrão
+void alarme_init(alarme_t *alarme, int32_t temp_min_c100, int32_t temp_max_c100, int32_t bpm_min, int32_t bpm_max);
+
+void alarme_set_faixa_temperatura(alarme_t *alarme, int32_t minimo_c100, int32_t maximo_c100);
+void alarme_set_faixa_batimento(alarme_t *alarme, int32_t minimo, int32_t maximo);
+
+// Avalia uma amostra; retorna um evento apenas quando o estado combinado muda
+alarme_evento_t alarme_avalia(alarme_t *alarme, int32_t temperatura_c100, int32_t batimento_bpm, uint32_t agora_ms);
+
+// Liga ou desliga o alarme manual; retorna um evento apenas quando o estado combinado muda
+alarme_evento_t alarme_set_manual(alarme_t *alarme, bool ativo);
+
+static inline bool alarme_ativo(const alarme_t *alarme) {
+    return alarme->ativo;
+}
+
+#endif
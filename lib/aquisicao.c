@@ -0,0 +1,135 @@
+#include "aquisicao.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#define AQ_CLOCK_ADC_HZ 48000000   // O ADC é alimentado pelo clk_adc de 48 MHz
+#define AQ_CICLOS_CONVERSAO 96     // Cada conversão leva no mínimo 96 ciclos do clk_adc
+
+// Anel de duas metades: enquanto o DMA preenche uma, a outra é decimada
+static uint16_t anel[2][AQ_AMOSTRAS_BLOCO];
+static int canal_dma[2] = { -1, -1 };
+
+static const uint8_t sobreamostragem[AQ_NUM_CANAIS] = {
+    [AQ_CANAL_BATIMENTO] = AQ_SOBREAMOSTRAGEM_BATIMENTO,
+    [AQ_CANAL_TEMPERATURA] = AQ_SOBREAMOSTRAGEM_TEMPERATURA,
+};
+
+// Última leitura decimada, protegida por um contador de versão (ímpar durante a escrita)
+static aq_leitura_t ultima;
+static volatile uint32_t versao = 0;
+static aq_callback_t callback_bloco = NULL;
+
+// Fim de uma metade do anel: reaponta o canal para o início da sua metade e decima o bloco
+static void aquisicao_dma_irq_handler(void) {
+    for (int i = 0; i < 2; i++) {
+        uint canal = canal_dma[i];
+        if (dma_channel_get_irq0_status(canal)) {
+            dma_channel_acknowledge_irq0(canal);
+            dma_channel_set_write_addr(canal, anel[i], false);
+            aquisicao_processa_bloco(anel[i], time_us_32());
+        }
+    }
+}
+
+// Configura o ADC em round-robin com FIFO e o DMA em ping-pong, e inicia a aquisição
+bool aquisicao_init(uint32_t taxa_hz) {
+    canal_dma[0] = dma_claim_unused_channel(false);
+    if (canal_dma[0] < 0) {
+        return false;
+    }
+    canal_dma[1] = dma_claim_unused_channel(false);
+    if (canal_dma[1] < 0) {
+        dma_channel_unclaim(canal_dma[0]);
+        canal_dma[0] = -1;
+        return false;
+    }
+
+    adc_init();
+    adc_gpio_init(26 + AQ_CANAL_BATIMENTO);
+    adc_gpio_init(26 + AQ_CANAL_TEMPERATURA);
+
+    // O round-robin começa pela entrada selecionada, então as amostras chegam intercaladas a partir do canal 0
+    adc_select_input(0);
+    adc_set_round_robin((1u << AQ_CANAL_BATIMENTO) | (1u << AQ_CANAL_TEMPERATURA));
+    adc_fifo_setup(true, true, 1, false, false); // FIFO com DREQ a cada amostra, sem bit de erro, 12 bits
+    aquisicao_set_taxa(taxa_hz);
+
+    // Cada canal preenche uma metade do anel e encadeia o outro, sem intervalo entre os blocos
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config config = dma_channel_get_default_config(canal_dma[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_chain_to(&config, canal_dma[1 - i]);
+        dma_channel_configure(canal_dma[i], &config, anel[i], &adc_hw->fifo, AQ_AMOSTRAS_BLOCO, false);
+        dma_channel_set_irq0_enabled(canal_dma[i], true);
+    }
+    irq_add_shared_handler(DMA_IRQ_0, aquisicao_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    dma_channel_start(canal_dma[0]);
+    adc_run(true);
+    return true;
+}
+
+// Altera a taxa de conversão do ADC
+void aquisicao_set_taxa(uint32_t taxa_hz) {
+    uint32_t ciclos = AQ_CLOCK_ADC_HZ / taxa_hz;
+    if (ciclos < AQ_CICLOS_CONVERSAO) {
+        ciclos = AQ_CICLOS_CONVERSAO;
+    }
+    adc_set_clkdiv(ciclos - 1);
+}
+
+// Registra o consumidor de cada nova leitura decimada
+void aquisicao_set_callback(aq_callback_t callback) {
+    callback_bloco = callback;
+}
+
+// Decima um bloco de amostras intercaladas e publica o resultado. Cada canal soma as suas
+// sobreamostragem[canal] amostras mais recentes, no fim do bloco.
+void aquisicao_processa_bloco(const uint16_t *amostras, uint32_t instante_us) {
+    uint32_t soma[AQ_NUM_CANAIS] = { 0 };
+    for (uint8_t canal = 0; canal < AQ_NUM_CANAIS; canal++) {
+        uint32_t inicio = (AQ_AMOSTRAS_CANAL - sobreamostragem[canal]) * AQ_NUM_CANAIS + canal;
+        for (uint32_t i = inicio; i < AQ_AMOSTRAS_BLOCO; i += AQ_NUM_CANAIS) {
+            soma[canal] += amostras[i] & 0x0FFF;
+        }
+    }
+
+    versao++;
+    __dmb();
+    for (uint8_t canal = 0; canal < AQ_NUM_CANAIS; canal++) {
+        ultima.valor[canal] = soma[canal] / sobreamostragem[canal];
+    }
+    ultima.sequencia++;
+    ultima.instante_us = instante_us;
+    __dmb();
+    versao++;
+
+    if (callback_bloco) {
+        callback_bloco(&ultima);
+    }
+}
+
+// Cópia consistente da última leitura; repete se o tratador de DMA publicou no meio da cópia
+void aquisicao_leitura(aq_leitura_t *leitura) {
+    uint32_t inicio;
+    do {
+        inicio = versao;
+        __dmb();
+        *leitura = ultima;
+        __dmb();
+    } while ((inicio & 1) || inicio != versao);
+}
+
+// Último valor decimado de um canal
+uint16_t aquisicao_valor(uint8_t canal) {
+    aq_leitura_t leitura;
+    aquisicao_leitura(&leitura);
+    return leitura.valor[canal];
+}
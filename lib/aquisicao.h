@@ -0,0 +1,68 @@
+#ifndef AQUISICAO_H
+#define AQUISICAO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Canais do ADC usados pelos sinais vitais (canal n corresponde ao GPIO 26 + n)
+#define AQ_CANAL_BATIMENTO 0     // GPIO 26, eixo Y do joystick
+#define AQ_CANAL_TEMPERATURA 1   // GPIO 27, eixo X do joystick
+#define AQ_NUM_CANAIS 2
+
+// Conversões por segundo, somando todos os canais do round-robin
+#ifndef AQ_TAXA_PADRAO_HZ
+#define AQ_TAXA_PADRAO_HZ 4000
+#endif
+
+// Amostras de cada canal em uma metade do anel; cada metade gera um valor decimado por canal.
+// O round-robin converte os canais alternadamente, então todos recebem o mesmo número de amostras.
+#ifndef AQ_AMOSTRAS_CANAL
+#define AQ_AMOSTRAS_CANAL 32
+#endif
+
+// Sobreamostragem de cada canal: quantas das amostras mais recentes do bloco formam o valor decimado
+// (potência de 2, até AQ_AMOSTRAS_CANAL). Uma janela menor acompanha variações mais rápidas com mais ruído.
+#ifndef AQ_SOBREAMOSTRAGEM_BATIMENTO
+#define AQ_SOBREAMOSTRAGEM_BATIMENTO 32
+#endif
+#ifndef AQ_SOBREAMOSTRAGEM_TEMPERATURA
+#define AQ_SOBREAMOSTRAGEM_TEMPERATURA 32
+#endif
+
+#if AQ_SOBREAMOSTRAGEM_BATIMENTO > AQ_AMOSTRAS_CANAL || AQ_SOBREAMOSTRAGEM_TEMPERATURA > AQ_AMOSTRAS_CANAL
+#error AQ_SOBREAMOSTRAGEM_* must not exceed AQ_AMOSTRAS_CANAL
+#endif
+
+// Amostras em cada metade do anel
+#define AQ_AMOSTRAS_BLOCO (AQ_NUM_CANAIS * AQ_AMOSTRAS_CANAL)
+
+// Última leitura decimada de todos os canais, obtida de um mesmo bloco
+typedef struct {
+    uint16_t valor[AQ_NUM_CANAIS];   // Média das amostras mais recentes do bloco (12 bits)
+    uint32_t sequencia;              // Número de blocos processados até esta leitura
+    uint32_t instante_us;            // Instante em que o bloco foi concluído
+} aq_leitura_t;
+
+// Chamada a cada bloco decimado, em contexto de interrupção
+typedef void (*aq_callback_t)(const aq_leitura_t *leitura);
+
+// Configura o ADC em round-robin com FIFO e o DMA em ping-pong, e inicia a aquisição
+bool aquisicao_init(uint32_t taxa_hz);
+
+// Altera a taxa de conversão do ADC
+void aquisicao_set_taxa(uint32_t taxa_hz);
+
+// Registra o consumidor de cada nova leitura decimada (ex.: processamento de sinais)
+void aquisicao_set_callback(aq_callback_t callback);
+
+// Decima um bloco de amostras intercaladas (canal 0, canal 1, canal 0, ...) e publica o resultado.
+// Chamada pelo tratador de DMA; pode ser alimentada por uma fonte sintética fora do alvo.
+void aquisicao_processa_bloco(const uint16_t *amostras, uint32_t instante_us);
+
+// Cópia consistente da última leitura, sem acessar o ADC
+void aquisicao_leitura(aq_leitura_t *leitura);
+
+// Último valor decimado de um canal
+uint16_t aquisicao_valor(uint8_t canal);
+
+#endif
@@ -0,0 +1,134 @@
+#include <string.h>
+#include "comandos.h"
+#include "log.h"
+
+void comandos_init(comandos_t *comandos, const comando_t *tabela, size_t total, const char *prefixo, void *contexto) {
+    memset(comandos, 0, sizeof(*comandos));
+    comandos->tabela = tabela;
+    comandos->total = total;
+    comandos->prefixo = prefixo;
+    comandos->tamanho_prefixo = strlen(prefixo);
+    comandos->contexto = contexto;
+}
+
+// Compara primeiro os tamanhos, calculados na compilação, e só então o texto
+static const comando_t *resolve(const comandos_t *comandos, const char *topico) {
+    if (strncmp(topico, comandos->prefixo, comandos->tamanho_prefixo) != 0) {
+        return NULL;
+    }
+    topico += comandos->tamanho_prefixo;
+    size_t tamanho = strlen(topico);
+    for (size_t i = 0; i < comandos->total; i++) {
+        const comando_t *comando = &comandos->tabela[i];
+        if (comando->tamanho == tamanho && memcmp(comando->topico, topico, tamanho) == 0) {
+            return comando;
+        }
+    }
+    return NULL;
+}
+
+void comandos_inicia(comandos_t *comandos, const char *topico, uint32_t tamanho_total) {
+    comandos->atual = resolve(comandos, topico);
+    comandos->esperado = tamanho_total;
+    comandos->recebido = 0;
+    if (!comandos->atual) {
+        comandos->desconhecidos++;
+        LOG(COMANDO_DESCONHECIDO, topico);
+    } else if (tamanho_total > COMANDOS_DADOS_MAX) {
+        comandos->excedidos++;
+        LOG(COMANDO_EXCEDIDO, comandos->atual->topico, (unsigned long)tamanho_total, (unsigned)COMANDOS_DADOS_MAX);
+        comandos->atual = NULL;
+    }
+}
+
+void comandos_fragmento(comandos_t *comandos, const uint8_t *dados, uint16_t len, bool ultimo) {
+    const comando_t *comando = comandos->atual;
+    if (!comando) {
+        return; // Tópico desconhecido, mensagem grande demais ou pedaço fora de uma publicação
+    }
+    // O tamanho total já foi conferido, mas um broker que envie mais do que anunciou não passa do buffer
+    if (len > COMANDOS_DADOS_MAX - comandos->recebido) {
+        comandos->excedidos++;
+        LOG(COMANDO_EXCEDIDO, comando->topico, (unsigned long)(comandos->recebido + len), (unsigned)COMANDOS_DADOS_MAX);
+        comandos->atual = NULL;
+        return;
+    }
+    if (len) {
+        memcpy(&comandos->dados[comandos->recebido], dados, len);
+        comandos->recebido += len;
+    }
+    if (!ultimo) {
+        return;
+    }
+    comandos->atual = NULL;
+    if (comandos->recebido != comandos->esperado) {
+        LOG(COMANDO_INCOMPLETO, comando->topico, (unsigned long)comandos->recebido, (unsigned long)comandos->esperado);
+        return;
+    }
+    comandos->dados[comandos->recebido] = '\0';
+    LOG(MENSAGEM_RECEBIDA, comando->topico, comandos->dados);
+    comando->trata(comandos->contexto, comandos->dados, comandos->recebido);
+}
+
+static const char *pula_espacos(const char *p, const char *fim) {
+    while (p < fim && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+    return p;
+}
+
+// Lê um número em ponto fixo a partir de *p, avançando *p até o primeiro caractere não lido. O valor é
+// conferido a cada algarismo, e o acumulado nunca passa de 10 vezes o limite.
+static bool le_fixo(const char **p, const char *fim, uint8_t casas, int32_t *valor) {
+    const char *c = pula_espacos(*p, fim);
+    bool negativo = false;
+    if (c < fim && (*c == '-' || *c == '+')) {
+        negativo = *c == '-';
+        c++;
+    }
+    const int64_t limite = negativo ? -(int64_t)INT32_MIN : INT32_MAX;
+    int64_t acumulado = 0;
+    bool algarismos = false;
+    for (; c < fim && *c >= '0' && *c <= '9'; c++) {
+        acumulado = acumulado * 10 + (*c - '0');
+        algarismos = true;
+        if (acumulado > limite) {
+            return false;
+        }
+    }
+    uint8_t lidas = 0;
+    if (c < fim && *c == '.') {
+        for (c++; c < fim && *c >= '0' && *c <= '9'; c++) {
+            if (lidas < casas) {
+                acumulado = acumulado * 10 + (*c - '0');
+                lidas++;
+                if (acumulado > limite) {
+                    return false;
+                }
+            }
+            algarismos = true;
+        }
+    }
+    if (!algarismos) {
+        return false;
+    }
+    for (; lidas < casas; lidas++) {
+        acumulado *= 10;
+        if (acumulado > limite) {
+            return false;
+        }
+    }
+    *valor = (int32_t)(negativo ? -acumulado : acumulado);
+    *p = pula_espacos(c, fim);
+    return true;
+}
+
+bool comandos_le_par(const char *texto, size_t len, uint8_t casas, int32_t *a, int32_t *b) {
+    const char *p = texto;
+    const char *fim = texto + len;
+    if (!le_fixo(&p, fim, casas, a) || p == fim || *p != ',') {
+        return false;
+    }
+    p++;
+    return le_fixo(&p, fim, casas, b) && p == fim;
+}
@@ -0,0 +1,60 @@
+#ifndef COMANDOS_H
+#define COMANDOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Recepção dos comandos MQTT. O tópico é resolvido uma única vez, no início da publicação, para uma
+// entrada da tabela de comandos. Os pedaços entregues pelo lwIP são remontados em um buffer de tamanho
+// fixo, e o tratador só é chamado com a mensagem completa. Uma mensagem maior que o buffer é descartada
+// inteira, sem ser truncada.
+
+// Maior mensagem de comando aceita, em bytes
+#ifndef COMANDOS_DADOS_MAX
+#define COMANDOS_DADOS_MAX 256
+#endif
+
+// Recebe a mensagem completa, terminada em '\0' (len não conta o terminador)
+typedef void (*comando_fn)(void *contexto, const char *dados, size_t len);
+
+typedef struct {
+    const char *topico;     // Sem o prefixo do dispositivo, ex.: "/comando/temperatura"
+    uint8_t tamanho;        // strlen(topico), calculado na compilação por COMANDO
+    comando_fn trata;
+} comando_t;
+
+#define COMANDO(topico_comando, funcao) \
+    { .topico = (topico_comando), .tamanho = sizeof(topico_comando) - 1, .trata = (funcao) }
+
+typedef struct {
+    const comando_t *tabela;
+    size_t total;
+    const char *prefixo;    // Prefixo esperado antes do tópico do comando ("" sem MQTT_UNIQUE_TOPIC)
+    size_t tamanho_prefixo;
+    void *contexto;         // Repassado aos tratadores
+
+    const comando_t *atual; // Comando da publicação em andamento; NULL descarta os pedaços
+    uint32_t esperado;      // Tamanho total anunciado pelo broker
+    uint32_t recebido;
+    char dados[COMANDOS_DADOS_MAX + 1];
+
+    uint32_t desconhecidos; // Publicações em tópicos sem comando
+    uint32_t excedidos;     // Mensagens maiores que COMANDOS_DADOS_MAX
+} comandos_t;
+
+void comandos_init(comandos_t *comandos, const comando_t *tabela, size_t total, const char *prefixo, void *contexto);
+
+// Início de uma publicação recebida (mqtt_incoming_publish_cb)
+void comandos_inicia(comandos_t *comandos, const char *topico, uint32_t tamanho_total);
+
+// Pedaço da publicação em andamento (mqtt_incoming_data_cb); com ultimo, chama o tratador
+void comandos_fragmento(comandos_t *comandos, const uint8_t *dados, uint16_t len, bool ultimo);
+
+// Lê "a,b" em ponto fixo com casas decimais (ex.: "34.5,37" com 2 casas dá 3450 e 3700), sem alocação
+// nem ponto flutuante. Aceita sinal e espaços em volta dos números; casas além das pedidas são
+// desprezadas. Retorna false se o formato for inválido ou se um valor, já multiplicado pelas casas, não
+// couber em int32_t.
+bool comandos_le_par(const char *texto, size_t len, uint8_t casas, int32_t *a, int32_t *b);
+
+#endif
@@ -0,0 +1,230 @@
+#include "conexao.h"
+#include "log.h"
+#include "pico/cyw43_arch.h"
+#include "pico/rand.h"
+#include "lwip/dns.h"
+#include "lwip/netif.h"
+
+static struct {
+    const conexao_config_t *config;
+    conexao_estado_t estado;
+    uint8_t falhas;              // Falhas seguidas, base da espera
+    uint8_t falhas_broker;       // Falhas seguidas do broker desde a última resolução
+    uint32_t prazo_ms;           // Fim da associação em andamento
+    ip_addr_t endereco;          // Último endereço resolvido do broker
+    bool tem_endereco;
+    uint32_t resolvido_ms;
+    uint32_t perdida_ms;         // Início da indisponibilidade atual
+    uint32_t recuperacao_ms;
+    uint32_t conexoes;
+    bool callbacks_netif;
+} cx;
+
+static void conexao_worker_fn(async_context_t *context, async_at_time_worker_t *worker);
+static async_at_time_worker_t conexao_worker = { .do_work = conexao_worker_fn };
+
+static inline uint32_t agora_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static struct netif *netif_sta(void) {
+    return &cyw43_state.netif[CYW43_ITF_STA];
+}
+
+static bool wifi_ativo(void) {
+    struct netif *netif = netif_sta();
+    return netif_is_link_up(netif) && !ip4_addr_isany_val(*netif_ip4_addr(netif));
+}
+
+// Executa a próxima etapa após ms, cancelando um prazo agendado
+static void agenda(uint32_t ms) {
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &conexao_worker);
+    async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &conexao_worker, ms);
+}
+
+static void muda_estado(conexao_estado_t estado, uint32_t ms) {
+    cx.estado = estado;
+    agenda(ms);
+}
+
+// Marca o início da indisponibilidade, medida até a próxima conexão ao broker
+static void perde_conexao(void) {
+    if (cx.estado == CONEXAO_CONECTADO) {
+        cx.perdida_ms = agora_ms();
+    }
+}
+
+uint32_t conexao_backoff_ms(uint8_t falhas, uint32_t aleatorio) {
+    uint32_t espera = CONEXAO_BACKOFF_MAXIMO_MS;
+    if (falhas < 16 && ((uint32_t)CONEXAO_BACKOFF_BASE_MS << falhas) < espera) {
+        espera = (uint32_t)CONEXAO_BACKOFF_BASE_MS << falhas;
+    }
+    // A parte aleatória evita que vários dispositivos tentem ao mesmo tempo após uma queda do broker
+    return espera / 2 + aleatorio % (espera / 2 + 1);
+}
+
+// Nova tentativa após a espera; volta ao Wi-Fi apenas se o enlace tiver caído
+static void falha(const char *etapa) {
+    uint32_t espera = conexao_backoff_ms(cx.falhas, get_rand_32());
+    if (cx.falhas < UINT8_MAX) {
+        cx.falhas++;
+    }
+    LOG(CONEXAO_FALHA, etapa, (unsigned long)espera);
+    muda_estado(wifi_ativo() ? CONEXAO_DNS : CONEXAO_WIFI_DESLIGADO, espera);
+}
+
+static void inicia_broker(void) {
+    muda_estado(CONEXAO_BROKER, CONEXAO_BROKER_TIMEOUT_MS);
+    if (!cx.config->conectar_broker(&cx.endereco)) {
+        cx.falhas_broker++;
+        falha("broker");
+    }
+}
+
+static void dns_cb(const char *nome, const ip_addr_t *endereco, void *arg) {
+    if (cx.estado != CONEXAO_DNS_RESOLVENDO) {
+        return; // Resposta após o prazo
+    }
+    if (endereco) {
+        cx.endereco = *endereco;
+        cx.tem_endereco = true;
+        cx.resolvido_ms = agora_ms();
+        cx.falhas_broker = 0;
+        inicia_broker();
+    } else if (cx.tem_endereco) {
+        LOG(CONEXAO_DNS_ANTERIOR, ipaddr_ntoa(&cx.endereco));
+        inicia_broker();
+    } else {
+        falha("DNS");
+    }
+}
+
+// Resolve o nome do broker quando não há endereço válido; senão conecta direto
+static void resolve(void) {
+    if (cx.tem_endereco && cx.falhas_broker < CONEXAO_FALHAS_ANTES_DNS &&
+        agora_ms() - cx.resolvido_ms < CONEXAO_DNS_VALIDADE_MS) {
+        inicia_broker();
+        return;
+    }
+
+    ip_addr_t endereco;
+    muda_estado(CONEXAO_DNS_RESOLVENDO, CONEXAO_DNS_TIMEOUT_MS);
+    err_t err = dns_gethostbyname(cx.config->servidor, &endereco, dns_cb, NULL);
+    if (err == ERR_OK) {
+        dns_cb(cx.config->servidor, &endereco, NULL);
+    } else if (err != ERR_INPROGRESS) {
+        dns_cb(cx.config->servidor, NULL, NULL);
+    }
+}
+
+// Enlace ou endereço IP perdidos: o cliente MQTT é encerrado e o Wi-Fi associado novamente
+static void netif_cb(struct netif *netif) {
+    if (cx.estado < CONEXAO_DNS || wifi_ativo()) {
+        return;
+    }
+    LOG(CONEXAO_WIFI_PERDIDO);
+    if (cx.estado == CONEXAO_BROKER || cx.estado == CONEXAO_CONECTADO) {
+        cx.config->desconectar_broker();
+    }
+    perde_conexao();
+    muda_estado(CONEXAO_WIFI_DESLIGADO, 0);
+}
+
+static void conexao_worker_fn(async_context_t *context, async_at_time_worker_t *worker) {
+    if (!cx.callbacks_netif) {
+        netif_set_link_callback(netif_sta(), netif_cb);
+        netif_set_status_callback(netif_sta(), netif_cb);
+        cx.callbacks_netif = true;
+    }
+
+    switch (cx.estado) {
+    case CONEXAO_WIFI_DESLIGADO:
+        if (cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) != CYW43_LINK_DOWN) {
+            cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+        }
+        if (cyw43_arch_wifi_connect_async(cx.config->ssid, cx.config->senha, cx.config->autenticacao)) {
+            falha("Wi-Fi");
+            break;
+        }
+        cx.prazo_ms = agora_ms() + CONEXAO_WIFI_TIMEOUT_MS;
+        muda_estado(CONEXAO_WIFI_ASSOCIANDO, CONEXAO_VERIFICACAO_MS);
+        break;
+
+    case CONEXAO_WIFI_ASSOCIANDO: {
+        int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        if (status == CYW43_LINK_UP) {
+            LOG(CONEXAO_WIFI_CONECTADO, ip4addr_ntoa(netif_ip4_addr(netif_sta())));
+            muda_estado(CONEXAO_DNS, 0);
+        } else if (status < 0 || (int32_t)(agora_ms() - cx.prazo_ms) >= 0) {
+            falha("Wi-Fi");
+        } else {
+            agenda(CONEXAO_VERIFICACAO_MS);
+        }
+        break;
+    }
+
+    case CONEXAO_DNS:
+        resolve();
+        break;
+
+    case CONEXAO_DNS_RESOLVENDO:
+        dns_cb(cx.config->servidor, NULL, NULL); // Prazo esgotado
+        break;
+
+    case CONEXAO_BROKER:
+        cx.config->desconectar_broker(); // Prazo esgotado
+        cx.falhas_broker++;
+        falha("broker");
+        break;
+
+    case CONEXAO_CONECTADO:
+        // Verificação de reserva, caso o callback do enlace não seja chamado
+        if (!wifi_ativo()) {
+            netif_cb(netif_sta());
+        } else {
+            agenda(CONEXAO_VERIFICACAO_CONECTADO_MS);
+        }
+        break;
+    }
+}
+
+void conexao_inicia(const conexao_config_t *config) {
+    cx.config = config;
+    cx.estado = CONEXAO_WIFI_DESLIGADO;
+    cx.perdida_ms = agora_ms();
+    agenda(0);
+}
+
+void conexao_broker_conectado(void) {
+    if (cx.estado != CONEXAO_BROKER) {
+        return;
+    }
+    uint32_t agora = agora_ms();
+    cx.recuperacao_ms = agora - cx.perdida_ms;
+    cx.conexoes++;
+    cx.falhas = 0;
+    cx.falhas_broker = 0;
+    LOG(CONEXAO_BROKER, (unsigned long)cx.recuperacao_ms);
+    muda_estado(CONEXAO_CONECTADO, CONEXAO_VERIFICACAO_CONECTADO_MS);
+}
+
+void conexao_broker_perdido(void) {
+    if (cx.estado != CONEXAO_BROKER && cx.estado != CONEXAO_CONECTADO) {
+        return; // Já tratado pela queda do Wi-Fi ou pelo prazo
+    }
+    perde_conexao();
+    cx.falhas_broker++;
+    falha("broker");
+}
+
+conexao_estado_t conexao_estado(void) {
+    return cx.estado;
+}
+
+uint32_t conexao_tempo_recuperacao_ms(void) {
+    return cx.recuperacao_ms;
+}
+
+uint32_t conexao_contagem(void) {
+    return cx.conexoes;
+}
@@ -0,0 +1,73 @@
+#ifndef CONEXAO_H
+#define CONEXAO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/ip_addr.h"
+
+// Gerenciador de conexão não bloqueante: Wi-Fi, DNS e broker MQTT, executado no async context do cyw43.
+// Qualquer falha leva a uma nova tentativa com espera exponencial e componente aleatória.
+
+// Espera antes da primeira nova tentativa e espera máxima
+#ifndef CONEXAO_BACKOFF_BASE_MS
+#define CONEXAO_BACKOFF_BASE_MS 500
+#endif
+#ifndef CONEXAO_BACKOFF_MAXIMO_MS
+#define CONEXAO_BACKOFF_MAXIMO_MS 30000
+#endif
+
+// Prazos de cada etapa
+#define CONEXAO_WIFI_TIMEOUT_MS 20000
+#define CONEXAO_DNS_TIMEOUT_MS 5000
+#define CONEXAO_BROKER_TIMEOUT_MS 20000     // Inclui o handshake TLS
+
+// Intervalo de verificação do enlace durante a associação e com o broker conectado
+#define CONEXAO_VERIFICACAO_MS 250
+#define CONEXAO_VERIFICACAO_CONECTADO_MS 2000
+
+// O endereço do broker é resolvido novamente após esse tempo ou após falhas seguidas do broker
+#define CONEXAO_DNS_VALIDADE_MS (10 * 60 * 1000)
+#define CONEXAO_FALHAS_ANTES_DNS 2
+
+typedef enum {
+    CONEXAO_WIFI_DESLIGADO = 0,   // Aguardando a próxima tentativa de associação
+    CONEXAO_WIFI_ASSOCIANDO,
+    CONEXAO_DNS,                  // Aguardando a próxima tentativa de resolução ou de conexão ao broker
+    CONEXAO_DNS_RESOLVENDO,
+    CONEXAO_BROKER,               // Conexão MQTT em andamento
+    CONEXAO_CONECTADO
+} conexao_estado_t;
+
+typedef struct {
+    const char *ssid;
+    const char *senha;
+    uint32_t autenticacao;          // CYW43_AUTH_*
+    const char *servidor;           // Nome ou endereço do broker
+
+    // Inicia a conexão MQTT; o resultado é informado por conexao_broker_conectado ou conexao_broker_perdido.
+    // Retorna false se a tentativa falhar imediatamente.
+    bool (*conectar_broker)(const ip_addr_t *endereco);
+
+    // O Wi-Fi caiu ou a conexão ao broker demorou demais: encerra o cliente MQTT sem aguardar o broker
+    void (*desconectar_broker)(void);
+} conexao_config_t;
+
+// Inicia a conexão em segundo plano; a configuração precisa permanecer válida
+void conexao_inicia(const conexao_config_t *config);
+
+// Resultado da conexão MQTT, chamado pelo callback de conexão do cliente
+void conexao_broker_conectado(void);
+void conexao_broker_perdido(void);
+
+conexao_estado_t conexao_estado(void);
+
+// Tempo entre a última perda de conexão (ou a inicialização) e a conexão seguinte ao broker
+uint32_t conexao_tempo_recuperacao_ms(void);
+
+// Número de vezes em que a conexão ao broker foi estabelecida
+uint32_t conexao_contagem(void);
+
+// Espera antes da próxima tentativa: dobra a cada falha até o máximo, metade fixa e metade aleatória
+uint32_t conexao_backoff_ms(uint8_t falhas, uint32_t aleatorio);
+
+#endif
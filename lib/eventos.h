@@ -0,0 +1,74 @@
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/sync.h"
+
+// Fila sem trava de um produtor e um consumidor, para levar eventos de interrupções (ou do outro núcleo)
+// até um worker. O produtor só escreve o índice de escrita e o consumidor só o de leitura; as barreiras
+// garantem que o evento esteja completo antes de o índice avançar.
+
+// Capacidade da fila (potência de 2)
+#ifndef EVENTOS_CAPACIDADE
+#define EVENTOS_CAPACIDADE 16
+#endif
+
+typedef enum {
+    EVENTO_BOTAO = 1,           // Borda de descida de um botão; dado = GPIO
+    EVENTO_ALARME,              // Mudança do alarme; dado = bits TELEMETRIA_ALARME_*
+    EVENTO_FAIXA_TEMPERATURA,   // Nova faixa do alarme; valor = mínimo e máximo em centésimos de grau
+    EVENTO_FAIXA_BATIMENTO,     // Nova faixa do alarme; valor = mínimo e máximo em BPM
+} evento_tipo_t;
+
+typedef struct {
+    uint32_t instante_us;   // Instante capturado pelo produtor
+    uint16_t tipo;          // evento_tipo_t
+    uint16_t dado;
+    int32_t valor[2];
+} evento_t;
+
+typedef struct {
+    evento_t itens[EVENTOS_CAPACIDADE];
+    volatile uint32_t escrita;    // Índices contínuos; a posição é o índice módulo a capacidade
+    volatile uint32_t leitura;
+    volatile uint32_t perdidos;   // Eventos descartados com a fila cheia (escrito pelo produtor)
+} fila_eventos_t;
+
+static inline void eventos_init(fila_eventos_t *fila) {
+    fila->escrita = 0;
+    fila->leitura = 0;
+    fila->perdidos = 0;
+}
+
+// Produtor: copia o evento e publica o novo índice; retorna false com a fila cheia
+static inline bool eventos_publica(fila_eventos_t *fila, const evento_t *evento) {
+    uint32_t escrita = fila->escrita;
+    if (escrita - fila->leitura >= EVENTOS_CAPACIDADE) {
+        fila->perdidos++;
+        return false;
+    }
+    fila->itens[escrita % EVENTOS_CAPACIDADE] = *evento;
+    __dmb();
+    fila->escrita = escrita + 1;
+    return true;
+}
+
+// Consumidor: lê o evento mais antigo e só então libera a posição; retorna false com a fila vazia
+static inline bool eventos_consome(fila_eventos_t *fila, evento_t *evento) {
+    uint32_t leitura = fila->leitura;
+    if (fila->escrita == leitura) {
+        return false;
+    }
+    __dmb();
+    *evento = fila->itens[leitura % EVENTOS_CAPACIDADE];
+    __dmb();
+    fila->leitura = leitura + 1;
+    return true;
+}
+
+static inline uint32_t eventos_contagem(const fila_eventos_t *fila) {
+    return fila->escrita - fila->leitura;
+}
+
+#endif
@@ -0,0 +1,244 @@
+#include <string.h>
+#include "fila_envio.h"
+
+#if FILA_ENVIO_FLASH_SETORES
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+// Região reservada no fim da flash, uma mensagem por página
+#define FILA_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FILA_ENVIO_FLASH_SETORES * FLASH_SECTOR_SIZE)
+#define FILA_FLASH_PAGINAS_POR_SETOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define FILA_FLASH_PAGINAS (FILA_ENVIO_FLASH_SETORES * FILA_FLASH_PAGINAS_POR_SETOR)
+#define FILA_FLASH_TIMEOUT_MS 100
+#endif
+
+#define FILA_CABECALHO 2   // Tamanho da mensagem, little-endian
+
+// Cópias que dão a volta no fim do anel
+static void escreve_anel(fila_envio_t *fila, uint32_t posicao, const uint8_t *origem, size_t n) {
+    posicao %= FILA_ENVIO_BYTES;
+    size_t ate_o_fim = FILA_ENVIO_BYTES - posicao;
+    if (n <= ate_o_fim) {
+        memcpy(&fila->dados[posicao], origem, n);
+    } else {
+        memcpy(&fila->dados[posicao], origem, ate_o_fim);
+        memcpy(fila->dados, origem + ate_o_fim, n - ate_o_fim);
+    }
+}
+
+static void le_anel(const fila_envio_t *fila, uint32_t posicao, uint8_t *destino, size_t n) {
+    posicao %= FILA_ENVIO_BYTES;
+    size_t ate_o_fim = FILA_ENVIO_BYTES - posicao;
+    if (n <= ate_o_fim) {
+        memcpy(destino, &fila->dados[posicao], n);
+    } else {
+        memcpy(destino, &fila->dados[posicao], ate_o_fim);
+        memcpy(destino + ate_o_fim, fila->dados, n - ate_o_fim);
+    }
+}
+
+static uint16_t tamanho_em(const fila_envio_t *fila, uint32_t posicao) {
+    uint8_t cabecalho[FILA_CABECALHO];
+    le_anel(fila, posicao, cabecalho, FILA_CABECALHO);
+    return (uint16_t)(cabecalho[0] | cabecalho[1] << 8);
+}
+
+// Remove a mensagem mais antiga da RAM
+static void remove_ram(fila_envio_t *fila) {
+    uint32_t ocupado = FILA_CABECALHO + tamanho_em(fila, fila->inicio);
+    fila->inicio = (fila->inicio + ocupado) % FILA_ENVIO_BYTES;
+    fila->ocupados -= ocupado;
+    fila->mensagens_ram--;
+}
+
+// Remove a mensagem mais antiga da RAM que ainda não foi enviada. As enviadas antes dela aguardam
+// confirmação e continuam no início da fila: seus bytes avançam para ocupar o espaço liberado.
+static void remove_ram_nao_enviada(fila_envio_t *fila) {
+    uint32_t enviados = 0;
+    for (uint16_t i = 0; i < fila->enviadas; i++) {
+        enviados += FILA_CABECALHO + tamanho_em(fila, fila->inicio + enviados);
+    }
+    uint32_t ocupado = FILA_CABECALHO + tamanho_em(fila, fila->inicio + enviados);
+    for (uint32_t i = enviados; i-- > 0;) {
+        fila->dados[(fila->inicio + ocupado + i) % FILA_ENVIO_BYTES] = fila->dados[(fila->inicio + i) % FILA_ENVIO_BYTES];
+    }
+    fila->inicio = (fila->inicio + ocupado) % FILA_ENVIO_BYTES;
+    fila->ocupados -= ocupado;
+    fila->mensagens_ram--;
+}
+
+#if FILA_ENVIO_FLASH_SETORES
+typedef struct {
+    uint32_t offset;
+    const uint8_t *pagina;   // NULL apaga o setor
+} operacao_flash_t;
+
+// Executada com as interrupções desligadas e o outro núcleo em espera
+static void executa_operacao_flash(void *param) {
+    const operacao_flash_t *operacao = (const operacao_flash_t *)param;
+    if (operacao->pagina) {
+        flash_range_program(operacao->offset, operacao->pagina, FLASH_PAGE_SIZE);
+    } else {
+        flash_range_erase(operacao->offset, FLASH_SECTOR_SIZE);
+    }
+}
+
+static const uint8_t *pagina_flash(uint32_t pagina) {
+    return (const uint8_t *)(XIP_BASE + FILA_FLASH_OFFSET + pagina * FLASH_PAGE_SIZE);
+}
+
+// Remove a mensagem mais antiga da flash; a fila vazia recomeça no primeiro setor
+static void remove_flash(fila_envio_t *fila) {
+    fila->flash_inicio = (fila->flash_inicio + 1) % FILA_FLASH_PAGINAS;
+    if (--fila->flash_contagem == 0) {
+        fila->flash_inicio = 0;
+    }
+}
+
+// Grava a mensagem na próxima página. Ao entrar em um setor ele é apagado, descartando as mensagens
+// mais antigas que ainda estejam nele.
+static bool adiciona_flash(fila_envio_t *fila, const uint8_t *mensagem, size_t tamanho) {
+    if (tamanho > FILA_ENVIO_FLASH_MENSAGEM_MAXIMA) {
+        return false;
+    }
+
+    uint32_t pagina = (fila->flash_inicio + fila->flash_contagem) % FILA_FLASH_PAGINAS;
+    if (pagina % FILA_FLASH_PAGINAS_POR_SETOR == 0) {
+        uint32_t setor = pagina / FILA_FLASH_PAGINAS_POR_SETOR;
+        while (fila->flash_contagem > 0 && fila->flash_inicio / FILA_FLASH_PAGINAS_POR_SETOR == setor) {
+            if (fila->mensagens_ram == 0 && fila->enviadas > 0) {
+                return false; // A mais antiga aguarda confirmação
+            }
+            remove_flash(fila);
+            fila->descartadas++;
+        }
+        pagina = (fila->flash_inicio + fila->flash_contagem) % FILA_FLASH_PAGINAS;
+        operacao_flash_t apagar = { FILA_FLASH_OFFSET + pagina * FLASH_PAGE_SIZE, NULL };
+        if (flash_safe_execute(executa_operacao_flash, &apagar, FILA_FLASH_TIMEOUT_MS) != PICO_OK) {
+            return false;
+        }
+    }
+
+    static uint8_t buffer[FLASH_PAGE_SIZE];
+    memset(buffer, 0xFF, sizeof(buffer));
+    buffer[0] = (uint8_t)tamanho;
+    buffer[1] = (uint8_t)(tamanho >> 8);
+    memcpy(&buffer[FILA_CABECALHO], mensagem, tamanho);
+    operacao_flash_t gravar = { FILA_FLASH_OFFSET + pagina * FLASH_PAGE_SIZE, buffer };
+    if (flash_safe_execute(executa_operacao_flash, &gravar, FILA_FLASH_TIMEOUT_MS) != PICO_OK) {
+        return false;
+    }
+    fila->flash_contagem++;
+    return true;
+}
+#endif
+
+void fila_envio_init(fila_envio_t *fila) {
+    fila->inicio = 0;
+    fila->ocupados = 0;
+    fila->mensagens_ram = 0;
+#if FILA_ENVIO_FLASH_SETORES
+    fila->flash_inicio = 0;
+    fila->flash_contagem = 0;
+#endif
+    fila->enviadas = 0;
+    fila->descartadas = 0;
+}
+
+bool fila_envio_adiciona(fila_envio_t *fila, const uint8_t *mensagem, size_t tamanho) {
+    if (tamanho == 0 || tamanho > UINT16_MAX || tamanho + FILA_CABECALHO > FILA_ENVIO_BYTES) {
+        fila->descartadas++;
+        return false;
+    }
+
+#if FILA_ENVIO_FLASH_SETORES
+    // A flash guarda as mensagens mais novas: enquanto tiver alguma, as seguintes também vão para ela
+    if (fila->flash_contagem > 0 || FILA_ENVIO_BYTES - fila->ocupados < tamanho + FILA_CABECALHO) {
+        if (adiciona_flash(fila, mensagem, tamanho)) {
+            return true;
+        }
+        if (fila->flash_contagem > 0) {
+            fila->descartadas++;
+            return false;
+        }
+    }
+#endif
+
+    while (FILA_ENVIO_BYTES - fila->ocupados < tamanho + FILA_CABECALHO) {
+        if (fila->mensagens_ram <= fila->enviadas) {
+            fila->descartadas++;
+            return false;
+        }
+        remove_ram_nao_enviada(fila);
+        fila->descartadas++;
+    }
+
+    uint8_t cabecalho[FILA_CABECALHO] = { (uint8_t)tamanho, (uint8_t)(tamanho >> 8) };
+    uint32_t fim = fila->inicio + fila->ocupados;
+    escreve_anel(fila, fim, cabecalho, FILA_CABECALHO);
+    escreve_anel(fila, fim + FILA_CABECALHO, mensagem, tamanho);
+    fila->ocupados += tamanho + FILA_CABECALHO;
+    fila->mensagens_ram++;
+    return true;
+}
+
+// As mensagens da flash só são enviadas depois que todas as da RAM forem confirmadas
+size_t fila_envio_proxima(const fila_envio_t *fila, uint8_t *buffer, size_t capacidade) {
+    if (fila->enviadas < fila->mensagens_ram) {
+        uint32_t posicao = fila->inicio;
+        for (uint16_t i = 0; i < fila->enviadas; i++) {
+            posicao += FILA_CABECALHO + tamanho_em(fila, posicao);
+        }
+        uint16_t tamanho = tamanho_em(fila, posicao);
+        if (tamanho > capacidade) {
+            return 0;
+        }
+        le_anel(fila, posicao + FILA_CABECALHO, buffer, tamanho);
+        return tamanho;
+    }
+#if FILA_ENVIO_FLASH_SETORES
+    if (fila->mensagens_ram == 0 && fila->enviadas < fila->flash_contagem) {
+        const uint8_t *pagina = pagina_flash((fila->flash_inicio + fila->enviadas) % FILA_FLASH_PAGINAS);
+        uint16_t tamanho = (uint16_t)(pagina[0] | pagina[1] << 8);
+        if (tamanho > capacidade) {
+            return 0;
+        }
+        memcpy(buffer, &pagina[FILA_CABECALHO], tamanho);
+        return tamanho;
+    }
+#endif
+    return 0;
+}
+
+void fila_envio_marca_enviada(fila_envio_t *fila) {
+    if (fila_envio_pendente(fila)) {
+        fila->enviadas++;
+    }
+}
+
+void fila_envio_confirma(fila_envio_t *fila) {
+    if (fila->enviadas == 0) {
+        return;
+    }
+    fila->enviadas--;
+    if (fila->mensagens_ram > 0) {
+        remove_ram(fila);
+    }
+#if FILA_ENVIO_FLASH_SETORES
+    else {
+        remove_flash(fila);
+    }
+#endif
+}
+
+void fila_envio_reenvia(fila_envio_t *fila) {
+    fila->enviadas = 0;
+}
+
+uint32_t fila_envio_contagem(const fila_envio_t *fila) {
+#if FILA_ENVIO_FLASH_SETORES
+    return fila->mensagens_ram + fila->flash_contagem;
+#else
+    return fila->mensagens_ram;
+#endif
+}
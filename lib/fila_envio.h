@@ -0,0 +1,66 @@
+#ifndef FILA_ENVIO_H
+#define FILA_ENVIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fila de armazenamento e reenvio (store-and-forward) de mensagens já codificadas.
+// As mensagens ficam na fila até o broker confirmar o recebimento; enquanto a conexão está fora,
+// elas se acumulam e depois são reenviadas na ordem original.
+
+// Bytes da fila em RAM (cada mensagem ocupa o seu tamanho mais 2 bytes)
+#ifndef FILA_ENVIO_BYTES
+#define FILA_ENVIO_BYTES 8192
+#endif
+
+// Setores de flash reservados no fim da memória para estender a fila quando a RAM enche (0 desativa).
+// A extensão não é persistente: o conteúdo é descartado a cada inicialização.
+#ifndef FILA_ENVIO_FLASH_SETORES
+#define FILA_ENVIO_FLASH_SETORES 0
+#endif
+
+// Cada mensagem na flash ocupa uma página de 256 bytes, com 2 bytes de tamanho
+#define FILA_ENVIO_FLASH_MENSAGEM_MAXIMA 254
+
+typedef struct {
+    uint8_t dados[FILA_ENVIO_BYTES];   // Anel de mensagens: tamanho (2 bytes) seguido do conteúdo
+    uint32_t inicio;                   // Byte da mensagem mais antiga
+    uint32_t ocupados;
+    uint16_t mensagens_ram;
+#if FILA_ENVIO_FLASH_SETORES
+    uint32_t flash_inicio;             // Página da mensagem mais antiga na flash
+    uint32_t flash_contagem;           // Mensagens na flash, sempre mais novas que as da RAM
+#endif
+    uint16_t enviadas;                 // Mensagens no início da fila entregues ao cliente, aguardando confirmação
+    uint32_t descartadas;              // Mensagens perdidas por falta de espaço
+} fila_envio_t;
+
+void fila_envio_init(fila_envio_t *fila);
+
+// Acrescenta uma mensagem ao fim da fila. Sem espaço na RAM, descarta as mais antigas que ainda não
+// foram enviadas; as que aguardam confirmação nunca são descartadas. Retorna false se mesmo assim a
+// mensagem não couber.
+bool fila_envio_adiciona(fila_envio_t *fila, const uint8_t *mensagem, size_t tamanho);
+
+// Copia a próxima mensagem ainda não enviada; retorna 0 se não houver nenhuma disponível
+size_t fila_envio_proxima(const fila_envio_t *fila, uint8_t *buffer, size_t capacidade);
+
+// A mensagem devolvida por fila_envio_proxima foi entregue ao cliente MQTT
+void fila_envio_marca_enviada(fila_envio_t *fila);
+
+// O broker confirmou a mensagem enviada mais antiga, que sai da fila
+void fila_envio_confirma(fila_envio_t *fila);
+
+// As mensagens enviadas e não confirmadas voltam a aguardar envio (erro de publicação ou desconexão)
+void fila_envio_reenvia(fila_envio_t *fila);
+
+// Mensagens na fila, enviadas ou não
+uint32_t fila_envio_contagem(const fila_envio_t *fila);
+
+// Há mensagens aguardando envio
+static inline bool fila_envio_pendente(const fila_envio_t *fila) {
+    return fila_envio_contagem(fila) > fila->enviadas;
+}
+
+#endif
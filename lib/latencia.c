@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <string.h>
+#include "latencia.h"
+
+// Os valores de 0 a 3 têm um balde cada; a partir daí, o bit mais alto escolhe o grupo e os dois bits
+// seguintes o balde dentro dele
+static uint32_t balde(uint32_t us) {
+    if (us > LATENCIA_MAXIMA_US) {
+        return LATENCIA_BALDES - 1;
+    }
+    if (us < LATENCIA_SUBDIVISOES) {
+        return us;
+    }
+    uint32_t bit = 31 - __builtin_clz(us);
+    return (bit - 1) * LATENCIA_SUBDIVISOES + ((us >> (bit - 2)) & (LATENCIA_SUBDIVISOES - 1));
+}
+
+// Maior valor que cai no balde
+static uint32_t limite_superior(uint32_t indice) {
+    if (indice < LATENCIA_SUBDIVISOES) {
+        return indice;
+    }
+    uint32_t bit = indice / LATENCIA_SUBDIVISOES + 1;
+    uint32_t sub = indice % LATENCIA_SUBDIVISOES;
+    return ((LATENCIA_SUBDIVISOES + sub + 1) << (bit - 2)) - 1;
+}
+
+void latencia_init(latencia_histograma_t *histograma) {
+    memset(histograma, 0, sizeof(*histograma));
+}
+
+void latencia_registra(latencia_histograma_t *histograma, uint32_t us) {
+    if (histograma->contagem == 0 || us < histograma->minimo_us) {
+        histograma->minimo_us = us;
+    }
+    if (us > histograma->maximo_us) {
+        histograma->maximo_us = us;
+    }
+    histograma->contagem++;
+    histograma->soma_us += us;
+    histograma->baldes[balde(us)]++;
+}
+
+uint32_t latencia_media_us(const latencia_histograma_t *histograma) {
+    return histograma->contagem ? (uint32_t)(histograma->soma_us / histograma->contagem) : 0;
+}
+
+uint32_t latencia_percentil_us(const latencia_histograma_t *histograma, uint8_t percentil) {
+    if (histograma->contagem == 0) {
+        return 0;
+    }
+    // Posição do percentil, arredondada para cima
+    uint64_t alvo = ((uint64_t)histograma->contagem * percentil + 99) / 100;
+    uint64_t acumulado = 0;
+    for (uint32_t i = 0; i < LATENCIA_BALDES; i++) {
+        acumulado += histograma->baldes[i];
+        if (acumulado >= alvo) {
+            uint32_t limite = limite_superior(i);
+            return limite < histograma->maximo_us ? limite : histograma->maximo_us;
+        }
+    }
+    return histograma->maximo_us;
+}
+
+int latencia_formata(const latencia_histograma_t *histograma, const char *nome, char *destino, size_t tamanho) {
+    return snprintf(destino, tamanho, "%s n=%lu min=%lu media=%lu p99=%lu max=%lu", nome,
+                    (unsigned long)histograma->contagem, (unsigned long)histograma->minimo_us,
+                    (unsigned long)latencia_media_us(histograma), (unsigned long)latencia_percentil_us(histograma, 99),
+                    (unsigned long)histograma->maximo_us);
+}
@@ -0,0 +1,35 @@
+#ifndef LATENCIA_H
+#define LATENCIA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Histograma de latências em microssegundos, com custo constante por registro e sem alocação.
+// Cada potência de 2 é dividida em 4 baldes (erro relativo de até 25% nos percentis); valores acima
+// de LATENCIA_MAXIMA_US ficam no último balde, mas o máximo exato é mantido.
+
+#define LATENCIA_SUBDIVISOES 4
+#define LATENCIA_BALDES 96                          // Até 2^25 us (~33 s)
+#define LATENCIA_MAXIMA_US ((1u << 25) - 1)
+
+typedef struct {
+    uint32_t contagem;
+    uint32_t minimo_us;
+    uint32_t maximo_us;
+    uint64_t soma_us;
+    uint32_t baldes[LATENCIA_BALDES];
+} latencia_histograma_t;
+
+void latencia_init(latencia_histograma_t *histograma);
+
+void latencia_registra(latencia_histograma_t *histograma, uint32_t us);
+
+uint32_t latencia_media_us(const latencia_histograma_t *histograma);
+
+// Limite superior do balde que contém o percentil (1 a 100), sem passar do máximo registrado
+uint32_t latencia_percentil_us(const latencia_histograma_t *histograma, uint8_t percentil);
+
+// Escreve "nome n=... min=... media=... p99=... max=..." (em us); retorna o tamanho como snprintf
+int latencia_formata(const latencia_histograma_t *histograma, const char *nome, char *destino, size_t tamanho);
+
+#endif
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "log.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if LOG_ADIADO
+static const char *const tipos_mensagens[] = {
+#define LOG_X(nome, nivel, tipos, formato) tipos,
+    LOG_MENSAGENS(LOG_X)
+#undef LOG_X
+};
+
+typedef struct {
+    uint32_t instante_us;
+    uint16_t mensagem;
+    uint8_t tamanho;        // Bytes usados em argumentos
+    uint8_t argumentos[LOG_ARGUMENTOS_BYTES];
+} log_registro_t;
+
+// Uma fila por núcleo: os produtores de um núcleo (código comum e interrupções) se excluem com as
+// interrupções desabilitadas; o consumidor é log_drena no núcleo 0, como em eventos.h
+typedef struct {
+    log_registro_t registros[LOG_CAPACIDADE];
+    volatile uint32_t escrita;
+    volatile uint32_t leitura;
+    volatile uint32_t perdidos;
+    uint32_t perdidos_informados;   // Escrito só pelo consumidor
+} fila_log_t;
+
+static fila_log_t filas[2];
+
+// Copia os argumentos crus conforme os tipos da mensagem; cada string fica com o espaço que sobra
+// depois de reservar o dos argumentos seguintes
+static uint8_t copia_argumentos(uint8_t *destino, const char *tipos, va_list args) {
+    size_t n = 0;
+    for (; *tipos; tipos++) {
+        uint32_t valor;
+        switch (*tipos) {
+        case 'd':
+            valor = (uint32_t)va_arg(args, int);
+            break;
+        case 'u':
+            valor = va_arg(args, unsigned);
+            break;
+        case 'l':
+            valor = (uint32_t)va_arg(args, long);
+            break;
+        case 'L':
+            valor = (uint32_t)va_arg(args, unsigned long);
+            break;
+        case 'f': {
+            float f = (float)va_arg(args, double);
+            memcpy(&valor, &f, sizeof(valor));
+            break;
+        }
+        case 's': {
+            const char *texto = va_arg(args, const char *);
+            size_t reserva = 0;
+            for (const char *t = tipos + 1; *t; t++) {
+                reserva += *t == 's' ? 1 : sizeof(uint32_t);
+            }
+            if (n + reserva >= LOG_ARGUMENTOS_BYTES) {
+                return (uint8_t)n;
+            }
+            size_t limite = LOG_ARGUMENTOS_BYTES - reserva - n - 1;
+            size_t len = 0;
+            if (!texto) {
+                texto = "(null)";
+            }
+            while (len < limite && texto[len]) {
+                len++;
+            }
+            memcpy(&destino[n], texto, len);
+            destino[n + len] = '\0';
+            n += len + 1;
+            continue;
+        }
+        default:
+            return (uint8_t)n;
+        }
+        if (n + sizeof(valor) > LOG_ARGUMENTOS_BYTES) {
+            return (uint8_t)n;
+        }
+        memcpy(&destino[n], &valor, sizeof(valor)); // Little-endian no RP2040
+        n += sizeof(valor);
+    }
+    return (uint8_t)n;
+}
+
+static void escreve_quadro(uint16_t mensagem, uint32_t instante_us, const uint8_t *argumentos, uint8_t tamanho) {
+    uint8_t quadro[2 + LOG_QUADRO_CABECALHO + LOG_ARGUMENTOS_BYTES + 1];
+    quadro[0] = LOG_QUADRO_INICIO;
+    quadro[1] = (uint8_t)(LOG_QUADRO_CABECALHO + tamanho);
+    quadro[2] = (uint8_t)mensagem;
+    quadro[3] = (uint8_t)(mensagem >> 8);
+    for (int i = 0; i < 4; i++) {
+        quadro[4 + i] = (uint8_t)(instante_us >> (8 * i));
+    }
+    memcpy(&quadro[2 + LOG_QUADRO_CABECALHO], argumentos, tamanho);
+    size_t fim = 2 + LOG_QUADRO_CABECALHO + tamanho;
+    uint8_t soma = 0;
+    for (size_t i = 1; i < fim; i++) {
+        soma ^= quadro[i];
+    }
+    quadro[fim] = soma;
+    fwrite(quadro, 1, fim + 1, stdout);
+}
+
+// Fila com o registro pendente mais antigo, ou NULL se as duas estiverem vazias
+static fila_log_t *mais_antiga(void) {
+    fila_log_t *escolhida = NULL;
+    uint32_t instante_us = 0;
+    for (size_t i = 0; i < sizeof(filas) / sizeof(filas[0]); i++) {
+        fila_log_t *fila = &filas[i];
+        if (fila->escrita == fila->leitura) {
+            continue;
+        }
+        __dmb();
+        uint32_t instante = fila->registros[fila->leitura % LOG_CAPACIDADE].instante_us;
+        if (!escolhida || (int32_t)(instante - instante_us) < 0) {
+            escolhida = fila;
+            instante_us = instante;
+        }
+    }
+    return escolhida;
+}
+
+static void informa_descartados(void) {
+    for (size_t i = 0; i < sizeof(filas) / sizeof(filas[0]); i++) {
+        fila_log_t *fila = &filas[i];
+        uint32_t perdidos = fila->perdidos;
+        if (perdidos != fila->perdidos_informados) {
+            uint32_t novos = perdidos - fila->perdidos_informados;
+            fila->perdidos_informados = perdidos;
+            escreve_quadro(LOG_DESCARTADOS, time_us_32(), (const uint8_t *)&novos, sizeof(novos));
+        }
+    }
+}
+#else
+static const char *const formatos[] = {
+#define LOG_X(nome, nivel, tipos, formato) formato,
+    LOG_MENSAGENS(LOG_X)
+#undef LOG_X
+};
+#endif
+
+void log_grava(log_mensagem_t mensagem, ...) {
+    va_list args;
+    va_start(args, mensagem);
+#if LOG_ADIADO
+    fila_log_t *fila = &filas[get_core_num()];
+    uint32_t interrupcoes = save_and_disable_interrupts();
+    uint32_t escrita = fila->escrita;
+    if (escrita - fila->leitura >= LOG_CAPACIDADE) {
+        fila->perdidos++;
+    } else {
+        log_registro_t *registro = &fila->registros[escrita % LOG_CAPACIDADE];
+        registro->instante_us = time_us_32();
+        registro->mensagem = (uint16_t)mensagem;
+        registro->tamanho = copia_argumentos(registro->argumentos, tipos_mensagens[mensagem], args);
+        __dmb();
+        fila->escrita = escrita + 1;
+    }
+    restore_interrupts(interrupcoes);
+#else
+    vprintf(formatos[mensagem], args);
+#endif
+    va_end(args);
+}
+
+void log_texto(const char *formato, ...) {
+    log_drena(UINT32_MAX);
+    va_list args;
+    va_start(args, formato);
+    vprintf(formato, args);
+    va_end(args);
+}
+
+bool log_drena(uint32_t max) {
+#if LOG_ADIADO
+    informa_descartados();
+    for (uint32_t n = 0; n < max; n++) {
+        fila_log_t *fila = mais_antiga();
+        if (!fila) {
+            break;
+        }
+        uint32_t leitura = fila->leitura;
+        const log_registro_t *registro = &fila->registros[leitura % LOG_CAPACIDADE];
+        escreve_quadro(registro->mensagem, registro->instante_us, registro->argumentos, registro->tamanho);
+        __dmb();
+        fila->leitura = leitura + 1;
+    }
+    fflush(stdout);
+    return mais_antiga() != NULL;
+#else
+    (void)max;
+    return false;
+#endif
+}
@@ -0,0 +1,78 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "log_mensagens.h"
+
+// Log com filtro de nível em tempo de compilação: LOG(nome, ...) de uma mensagem acima de LOG_NIVEL
+// não gera código. As mensagens ficam em log_mensagens.h.
+//
+// Com LOG_ADIADO, LOG não formata nada: grava um registro binário (identificador, instante e os
+// argumentos crus, com as strings copiadas) na fila do núcleo que chamou, seguro também em
+// interrupções. log_drena, chamada por uma tarefa de baixa prioridade do núcleo 0, escreve os
+// registros no stdio em quadros binários que ferramentas/decodificar_log.c converte de volta em
+// texto; o texto comum do stdio passa pelo decodificador sem alteração.
+// Sem LOG_ADIADO, LOG formata e escreve na hora, como printf.
+
+#ifndef LOG_NIVEL
+#ifdef NDEBUG
+#define LOG_NIVEL LOG_INFO
+#else
+#define LOG_NIVEL LOG_DEPURACAO
+#endif
+#endif
+
+#ifndef LOG_ADIADO
+#define LOG_ADIADO 1
+#endif
+
+// Registros por núcleo (potência de 2); com a fila cheia o registro é descartado e contado
+#ifndef LOG_CAPACIDADE
+#define LOG_CAPACIDADE 32
+#endif
+
+// Bytes para os argumentos de um registro; strings que não cabem são truncadas
+#define LOG_ARGUMENTOS_BYTES 40
+
+// Quadro no stdio: 0x00, tamanho, identificador (2 bytes), instante_us (4 bytes), argumentos e a soma
+// XOR dos bytes entre o tamanho e ela; os inteiros são little-endian. O tamanho conta identificador,
+// instante e argumentos.
+#define LOG_QUADRO_INICIO 0x00
+#define LOG_QUADRO_CABECALHO 6
+
+typedef enum {
+#define LOG_X(nome, nivel, tipos, formato) LOG_##nome,
+    LOG_MENSAGENS(LOG_X)
+#undef LOG_X
+    LOG_MENSAGENS_TOTAL
+} log_mensagem_t;
+
+enum {
+#define LOG_X(nome, nivel, tipos, formato) LOG_NIVEL_DE_##nome = (nivel),
+    LOG_MENSAGENS(LOG_X)
+#undef LOG_X
+};
+
+#define LOG(nome, ...) do { \
+        if (LOG_NIVEL_DE_##nome <= LOG_NIVEL) { \
+            log_grava(LOG_##nome, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Texto já formatado ou de tamanho livre (relatórios periódicos); escreve na hora, depois dos
+// registros pendentes para manter a ordem. Apenas no núcleo 0.
+#define LOG_TEXTO(nivel, ...) do { \
+        if ((nivel) <= LOG_NIVEL) { \
+            log_texto(__VA_ARGS__); \
+        } \
+    } while (0)
+
+void log_grava(log_mensagem_t mensagem, ...);
+void log_texto(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+
+// Escreve até max registros pendentes, dos dois núcleos em ordem de instante; retorna true se ainda
+// restarem registros. Apenas no núcleo 0, que é o único consumidor das filas.
+bool log_drena(uint32_t max);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef LOG_MENSAGENS_H
+#define LOG_MENSAGENS_H
+
+// Tabela das mensagens de log, compartilhada pelo firmware (lib/log.h) e pelo decodificador
+// (ferramentas/decodificar_log.c). O identificador de cada mensagem é a sua posição, então o
+// decodificador deve ser compilado a partir da mesma versão da tabela que o firmware.
+//
+// X(nome, nível, tipos, formato): os tipos descrevem os argumentos, na ordem do formato:
+//   d int, u unsigned, l long, L unsigned long, f double (guardado como float), s string (copiada)
+// O decodificador confere os tipos com as conversões do formato antes de decodificar.
+
+#define LOG_ERRO 1
+#define LOG_AVISO 2
+#define LOG_INFO 3
+#define LOG_DEPURACAO 4
+
+#define LOG_MENSAGENS(X) \
+    X(DESCARTADOS,               LOG_AVISO,     "L",   "Log: %lu records dropped\n") \
+    X(CLIENTE_INICIANDO,         LOG_INFO,      "",    "mqtt client starting\n") \
+    X(BOOT_FASE,                 LOG_INFO,      "sL",  "Boot: %s em %lu us\n") \
+    X(CLIENTE_ENCERRANDO,        LOG_INFO,      "",    "mqtt client exiting\n") \
+    X(NOME_DISPOSITIVO,          LOG_INFO,      "s",   "Device name %s\n") \
+    X(TLS_SEM_VERIFICACAO,       LOG_AVISO,     "",    "Warning: tls without verification is insecure\n") \
+    X(TLS_SEM_CERTIFICADO,       LOG_AVISO,     "",    "Warning: tls without a certificate is insecure\n") \
+    X(USANDO_TLS,                LOG_INFO,      "",    "Using TLS\n") \
+    X(SEM_TLS,                   LOG_INFO,      "",    "Warning: Not using TLS\n") \
+    X(CONECTANDO,                LOG_INFO,      "s",   "Connecting to mqtt server at %s\n") \
+    X(ERRO_CONEXAO,              LOG_ERRO,      "d",   "MQTT broker connection error %d\n") \
+    X(CONECTADO,                 LOG_INFO,      "L",   "MQTT connected in %lu ms\n") \
+    X(CONECTADO_TLS,             LOG_INFO,      "Ls",  "MQTT connected in %lu ms (%s)\n") \
+    X(CONEXAO_PERDIDA,           LOG_ERRO,      "d",   "mqtt connection lost or refused, status %d\n") \
+    X(ALARME_MANUAL,             LOG_INFO,      "s",   "Alarme manual %s\n") \
+    X(ALARME_ATIVADO,            LOG_INFO,      "s",   "Alarme %s ativado!\n") \
+    X(CONDICOES_NORMALIZADAS,    LOG_INFO,      "",    "Condições normalizadas.\n") \
+    X(LED_VERMELHO,              LOG_INFO,      "",    "LED vermelho ligado\n") \
+    X(LED_VERDE,                 LOG_INFO,      "",    "LED verde ligado\n") \
+    X(PUBLICANDO,                LOG_INFO,      "ss",  "Publishing %s to %s\n") \
+    X(PUBLICANDO_ALARME,         LOG_INFO,      "ss",  "Publishing alarm status %s to %s\n") \
+    X(PUBLICADO,                 LOG_INFO,      "usu", "Published %u bytes to %s, %u queued\n") \
+    X(FALHA_PUBLICACAO,          LOG_ERRO,      "d",   "pub_request_cb failed %d\n") \
+    X(FALHA_ALARME,              LOG_ERRO,      "d",   "alarme_request_cb failed %d\n") \
+    X(FALHA_TELEMETRIA,          LOG_ERRO,      "d",   "telemetria_request_cb failed %d, resending\n") \
+    X(FILA_TELEMETRIA_CHEIA,     LOG_ERRO,      "u",   "Telemetry queue full, %u messages dropped\n") \
+    X(MENSAGEM_RECEBIDA,         LOG_DEPURACAO, "ss",  "Topic: %s, Message: %s\n") \
+    X(COMANDO_DESCONHECIDO,      LOG_DEPURACAO, "s",   "Tópico sem comando: %s\n") \
+    X(COMANDO_EXCEDIDO,          LOG_AVISO,     "sLu", "Comando %s descartado: %lu bytes, limite %u\n") \
+    X(COMANDO_INCOMPLETO,        LOG_AVISO,     "sLL", "Comando %s incompleto: %lu de %lu bytes\n") \
+    X(BATIMENTO_INVALIDO,        LOG_ERRO,      "dd",  "Faixa de batimento inválida: %.2d, %.2d\n") \
+    X(BATIMENTO_FILA_CHEIA,      LOG_ERRO,      "",    "Fila de comandos cheia, faixa de batimento ignorada\n") \
+    X(BATIMENTO_ATUALIZADO,      LOG_INFO,      "dd",  "Faixa de batimento atualizada: %d - %d\n") \
+    X(BATIMENTO_FORMATO,         LOG_ERRO,      "s",   "Formato inválido para batimento: %s\n") \
+    X(TEMPERATURA_INVALIDA,      LOG_ERRO,      "s",   "Faixa de temperatura inválida: %s\n") \
+    X(TEMPERATURA_FILA_CHEIA,    LOG_ERRO,      "",    "Fila de comandos cheia, faixa de temperatura ignorada\n") \
+    X(TEMPERATURA_ATUALIZADA,    LOG_INFO,      "dddd", "Faixa de temperatura atualizada: %d.%02d - %d.%02d\n") \
+    X(TEMPERATURA_FORMATO,       LOG_ERRO,      "s",   "Formato inválido para temperatura: %s\n") \
+    X(LOTE_INVALIDO,             LOG_ERRO,      "dl",  "Lote inválido: %d amostras, %ld ms\n") \
+    X(LOTE_ATUALIZADO,           LOG_INFO,      "dl",  "Lote atualizado: %d amostras a cada %ld ms\n") \
+    X(LOTE_FORMATO,              LOG_ERRO,      "s",   "Formato inválido para lote: %s\n") \
+    X(CONEXAO_FALHA,             LOG_AVISO,     "sL",  "Conexão: falha em %s, nova tentativa em %lu ms\n") \
+    X(CONEXAO_DNS_ANTERIOR,      LOG_AVISO,     "s",   "Conexão: DNS falhou, usando o endereço anterior %s\n") \
+    X(CONEXAO_WIFI_PERDIDO,      LOG_AVISO,     "",    "Conexão: Wi-Fi perdido\n") \
+    X(CONEXAO_WIFI_CONECTADO,    LOG_INFO,      "s",   "Conexão: Wi-Fi conectado, IP %s\n") \
+    X(CONEXAO_BROKER,            LOG_INFO,      "L",   "Conexão: broker conectado em %lu ms\n") \
+    X(ASSINATURA_FALHOU,         LOG_AVISO,     "ssd", "%s %s failed %d, retrying\n") \
+    X(PRIMEIRA_TELEMETRIA,       LOG_INFO,      "L",   "Primeira telemetria %lu us após o CONNACK\n") \
+    X(DISPLAY_BLOQUEANTE,        LOG_AVISO,     "",    "Sem canal de DMA livre, display em modo bloqueante\n") \
+    X(DISPLAY_ENVIO_ABORTADO,    LOG_AVISO,     "L",   "Display: envio abortado pelo I2C (%lu no total), a tela inteira segue no próximo\n") \
+    X(MATRIZ_BLOQUEANTE,         LOG_AVISO,     "",    "Sem canal de DMA livre, matriz de LEDs em modo bloqueante\n") \
+    X(MATRIZ_INDISPONIVEL,       LOG_ERRO,      "",    "Sem espaço no PIO para a matriz de LEDs\n")
+
+#endif
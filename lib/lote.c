@@ -0,0 +1,85 @@
+#include "lote.h"
+
+static inline const telemetria_registro_t *lote_amostra(const lote_t *lote, uint8_t i) {
+    return &lote->amostras[(lote->inicio + i) % LOTE_AMOSTRAS_MAX];
+}
+
+// Divisão com arredondamento para o inteiro mais próximo
+static int32_t media_arredondada(int64_t soma, uint8_t n) {
+    return (int32_t)((soma >= 0 ? soma + n / 2 : soma - n / 2) / n);
+}
+
+void lote_init(lote_t *lote) {
+    lote->inicio = 0;
+    lote->contagem = 0;
+    lote->descartadas = 0;
+}
+
+void lote_adiciona(lote_t *lote, const telemetria_registro_t *amostra) {
+    if (lote->contagem == LOTE_AMOSTRAS_MAX) {
+        lote->inicio = (lote->inicio + 1) % LOTE_AMOSTRAS_MAX;
+        lote->contagem--;
+        lote->descartadas++;
+    }
+    lote->amostras[(lote->inicio + lote->contagem) % LOTE_AMOSTRAS_MAX] = *amostra;
+    lote->contagem++;
+}
+
+void lote_resumo(const lote_t *lote, uint8_t n, telemetria_resumo_t *resumo) {
+    if (n > lote->contagem) {
+        n = lote->contagem;
+    }
+    if (n == 0) {
+        *resumo = (telemetria_resumo_t){0};
+        return;
+    }
+
+    const telemetria_registro_t *primeira = lote_amostra(lote, 0);
+    resumo->temperatura_min_c100 = resumo->temperatura_max_c100 = primeira->temperatura_c100;
+    resumo->batimento_min_bpm = resumo->batimento_max_bpm = primeira->batimento_bpm;
+    int64_t soma_temperatura = 0, soma_batimento = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const telemetria_registro_t *amostra = lote_amostra(lote, i);
+        if (amostra->temperatura_c100 < resumo->temperatura_min_c100) resumo->temperatura_min_c100 = amostra->temperatura_c100;
+        if (amostra->temperatura_c100 > resumo->temperatura_max_c100) resumo->temperatura_max_c100 = amostra->temperatura_c100;
+        if (amostra->batimento_bpm < resumo->batimento_min_bpm) resumo->batimento_min_bpm = amostra->batimento_bpm;
+        if (amostra->batimento_bpm > resumo->batimento_max_bpm) resumo->batimento_max_bpm = amostra->batimento_bpm;
+        soma_temperatura += amostra->temperatura_c100;
+        soma_batimento += amostra->batimento_bpm;
+    }
+    resumo->temperatura_media_c100 = media_arredondada(soma_temperatura, n);
+    resumo->batimento_media_bpm = media_arredondada(soma_batimento, n);
+}
+
+size_t lote_codifica(const lote_t *lote, uint8_t n, uint32_t sequencia, uint8_t *buffer, size_t capacidade) {
+    if (n > lote->contagem) {
+        n = lote->contagem;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    telemetria_codificador_t cod;
+    if (!telemetria_inicia(&cod, buffer, capacidade, sequencia, lote_amostra(lote, 0)->instante_ms)) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        if (!telemetria_adiciona(&cod, lote_amostra(lote, i))) {
+            return 0;
+        }
+    }
+    telemetria_resumo_t resumo;
+    lote_resumo(lote, n, &resumo);
+    if (!telemetria_adiciona_resumo(&cod, &resumo)) {
+        return 0;
+    }
+    return telemetria_finaliza(&cod);
+}
+
+void lote_remove(lote_t *lote, uint8_t n) {
+    if (n > lote->contagem) {
+        n = lote->contagem;
+    }
+    lote->inicio = (lote->inicio + n) % LOTE_AMOSTRAS_MAX;
+    lote->contagem -= n;
+}
@@ -0,0 +1,43 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "telemetria.h"
+
+// Maior número de amostras acumuladas entre duas publicações
+#ifndef LOTE_AMOSTRAS_MAX
+#define LOTE_AMOSTRAS_MAX 32
+#endif
+
+// Maior mensagem gerada por lote_codifica
+#define LOTE_MENSAGEM_MAXIMA (TELEMETRIA_CABECALHO_MAXIMO + LOTE_AMOSTRAS_MAX * TELEMETRIA_REGISTRO_MAXIMO + TELEMETRIA_RESUMO_MAXIMO)
+
+// Anel de amostras aguardando publicação; quando cheio, a mais antiga é sobrescrita
+typedef struct {
+    telemetria_registro_t amostras[LOTE_AMOSTRAS_MAX];
+    uint8_t inicio;          // Amostra mais antiga
+    uint8_t contagem;
+    uint32_t descartadas;    // Amostras sobrescritas antes de serem publicadas
+} lote_t;
+
+void lote_init(lote_t *lote);
+
+// Acrescenta uma amostra ao fim do anel
+void lote_adiciona(lote_t *lote, const telemetria_registro_t *amostra);
+
+static inline uint8_t lote_contagem(const lote_t *lote) {
+    return lote->contagem;
+}
+
+// Mínimo, máximo e média das n amostras mais antigas
+void lote_resumo(const lote_t *lote, uint8_t n, telemetria_resumo_t *resumo);
+
+// Codifica as n amostras mais antigas e o resumo delas em uma mensagem de telemetria, sem removê-las.
+// Retorna o tamanho da mensagem ou 0 se o buffer não for suficiente.
+size_t lote_codifica(const lote_t *lote, uint8_t n, uint32_t sequencia, uint8_t *buffer, size_t capacidade);
+
+// Remove as n amostras mais antigas (após a publicação ser aceita)
+void lote_remove(lote_t *lote, uint8_t n);
+
+#endif
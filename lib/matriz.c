@@ -0,0 +1,95 @@
+#include <string.h>
+#include "matriz.h"
+#include "log.h"
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "animacao_matriz.pio.h"
+
+// Duração de um quadro na fita: 24 bits de 1,25 us por LED (10 ciclos do PIO a 8 MHz), mais o nível baixo
+// que faz os LEDs travarem as cores recebidas (no mínimo 50 us)
+#define MATRIZ_RESET_US 80
+#define MATRIZ_QUADRO_US (MATRIZ_LEDS * 24 * 125 / 100 + MATRIZ_RESET_US)
+
+static PIO pio = pio0;
+static int sm = -1;
+static int canal_dma = -1;
+
+static uint32_t montagem[MATRIZ_LEDS];  // Quadro em montagem
+static uint32_t enviado[MATRIZ_LEDS];   // Último quadro enviado, lido pelo DMA durante o envio
+static bool algum_enviado = false;
+static uint32_t inicio_envio_us;
+
+static uint32_t quadros_enviados = 0;
+static uint32_t quadros_iguais = 0;
+
+bool matriz_init(uint8_t pino) {
+    if (!pio_can_add_program(pio, &animacao_matriz_program)) {
+        return false;
+    }
+    sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) {
+        return false;
+    }
+    uint offset = pio_add_program(pio, &animacao_matriz_program);
+    animacao_matriz_program_init(pio, (uint)sm, offset, pino);
+
+    // Palavras de 32 bits do quadro para o FIFO, no ritmo em que a máquina de estados as consome
+    canal_dma = dma_claim_unused_channel(false);
+    if (canal_dma >= 0) {
+        dma_channel_config config = dma_channel_get_default_config(canal_dma);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+        channel_config_set_read_increment(&config, true);
+        channel_config_set_write_increment(&config, false);
+        channel_config_set_dreq(&config, pio_get_dreq(pio, (uint)sm, true));
+        dma_channel_configure(canal_dma, &config, &pio->txf[sm], enviado, MATRIZ_LEDS, false);
+    } else {
+        LOG(MATRIZ_BLOQUEANTE);
+    }
+    matriz_limpa();
+    return true;
+}
+
+void matriz_limpa(void) {
+    memset(montagem, 0, sizeof(montagem));
+}
+
+void matriz_pixel(uint8_t x, uint8_t y, uint32_t cor) {
+    if (x < MATRIZ_LADO && y < MATRIZ_LADO) {
+        montagem[matriz_indice(x, y)] = cor;
+    }
+}
+
+bool matriz_envia(void) {
+    if (sm < 0) {
+        return false;
+    }
+    if (algum_enviado && memcmp(montagem, enviado, sizeof(enviado)) == 0) {
+        quadros_iguais++;
+        return false;
+    }
+    uint32_t agora_us = time_us_32();
+    if (algum_enviado && agora_us - inicio_envio_us < MATRIZ_QUADRO_US) {
+        return false;
+    }
+    memcpy(enviado, montagem, sizeof(enviado));
+    algum_enviado = true;
+    inicio_envio_us = agora_us;
+    quadros_enviados++;
+    if (canal_dma >= 0) {
+        dma_channel_transfer_from_buffer_now(canal_dma, enviado, MATRIZ_LEDS);
+    } else {
+        for (int i = 0; i < MATRIZ_LEDS; i++) {
+            pio_sm_put_blocking(pio, (uint)sm, enviado[i]);
+        }
+    }
+    return true;
+}
+
+uint32_t matriz_quadros_enviados(void) {
+    return quadros_enviados;
+}
+
+uint32_t matriz_quadros_iguais(void) {
+    return quadros_iguais;
+}
@@ -0,0 +1,42 @@
+#ifndef MATRIZ_H
+#define MATRIZ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Matriz 5x5 de LEDs WS2812 alimentada pelo programa lib/animacao_matriz.pio. O quadro é montado em RAM,
+// uma palavra por LED, e enviado por DMA direto ao FIFO da máquina de estados: por quadro, o processador
+// só compara e copia 25 palavras. Um quadro igual ao último enviado não é reenviado.
+
+#define MATRIZ_LADO 5
+#define MATRIZ_LEDS (MATRIZ_LADO * MATRIZ_LADO)
+
+// Cor no formato consumido pelo PIO, que envia 24 bits a partir do bit 31: G, R e B, nessa ordem
+static inline uint32_t matriz_cor(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint32_t)g << 24 | (uint32_t)r << 16 | (uint32_t)b << 8;
+}
+
+// Posição na fita do LED da coluna x e linha y, contadas a partir do canto superior esquerdo. A fita
+// começa no canto inferior direito e percorre as linhas em zigue-zague.
+static inline uint8_t matriz_indice(uint8_t x, uint8_t y) {
+    uint8_t coluna = (y % 2 == 0) ? x : (uint8_t)(MATRIZ_LADO - 1 - x);
+    return (uint8_t)(MATRIZ_LEDS - 1 - (y * MATRIZ_LADO + coluna));
+}
+
+// Carrega o programa em uma máquina de estados livre do pio0 e reserva um canal de DMA; sem canal livre, os
+// quadros são escritos no FIFO de forma bloqueante. Retorna false se o PIO não tiver espaço ou máquina livre.
+bool matriz_init(uint8_t pino);
+
+// Quadro em montagem: apaga todos os LEDs ou define a cor de um deles
+void matriz_limpa(void);
+void matriz_pixel(uint8_t x, uint8_t y, uint32_t cor);
+
+// Envia o quadro em montagem se for diferente do último enviado e retorna true. Enquanto o quadro anterior
+// ainda está na fita (MATRIZ_QUADRO_US desde o início do envio), o novo fica para a próxima chamada.
+bool matriz_envia(void);
+
+// Quadros enviados e quadros iguais ao anterior, que não foram reenviados
+uint32_t matriz_quadros_enviados(void);
+uint32_t matriz_quadros_iguais(void);
+
+#endif
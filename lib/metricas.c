@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include "metricas.h"
+#include "pico/stdlib.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+
+#if PICO_ON_DEVICE
+#include <malloc.h>
+
+// Limites do heap definidos pelo linker script do SDK
+extern char __StackLimit, __bss_end__;
+#endif
+
+metricas_t metricas;
+
+static uint32_t heap_livre(void) {
+#if PICO_ON_DEVICE
+    struct mallinfo info = mallinfo();
+    return (uint32_t)(&__StackLimit - &__bss_end__) - (uint32_t)info.uordblks;
+#else
+    return 0;
+#endif
+}
+
+void metricas_amostra(void) {
+#if LWIP_STATS && MEMP_STATS
+    metricas.pbuf_usados = lwip_stats.memp[MEMP_PBUF_POOL]->used;
+    metricas.pbuf_max = lwip_stats.memp[MEMP_PBUF_POOL]->max;
+    uint32_t erros = 0;
+    for (int i = 0; i < MEMP_MAX; i++) {
+        erros += lwip_stats.memp[i]->err;
+    }
+    metricas.memp_erros = erros;
+#endif
+#if LWIP_STATS && MEM_STATS
+    metricas.mem_usada = lwip_stats.mem.used;
+    metricas.mem_max = lwip_stats.mem.max;
+#endif
+    metricas.heap_livre = heap_livre();
+}
+
+int metricas_formata(char *destino, size_t tamanho) {
+    const metricas_t *m = &metricas;
+    return snprintf(destino, tamanho,
+                    "pub=%lu ok=%lu falha=%lu recusa=%lu perdida=%lu voo=%u voo_max=%u reconexoes=%lu connack_pub_us=%lu "
+                    "botao=%lu adc=%lu descartados=%lu render_us=%lu render_max_us=%lu envio_us=%lu i2c=%lu "
+                    "matriz=%lu matriz_iguais=%lu "
+                    "pbuf=%u pbuf_max=%u memp_err=%lu mem=%lu mem_max=%lu heap=%lu",
+                    (unsigned long)m->publicacoes_tentadas, (unsigned long)m->publicacoes_confirmadas,
+                    (unsigned long)m->publicacoes_falhas, (unsigned long)m->publicacoes_recusadas,
+                    (unsigned long)m->publicacoes_perdidas, m->em_voo, m->em_voo_max,
+                    (unsigned long)(m->conexoes ? m->conexoes - 1 : 0), (unsigned long)m->connack_telemetria_us,
+                    (unsigned long)m->interrupcoes_botao, (unsigned long)m->blocos_adc,
+                    (unsigned long)m->eventos_descartados, (unsigned long)m->renderizacao_us,
+                    (unsigned long)m->renderizacao_max_us, (unsigned long)m->envio_display_us,
+                    (unsigned long)m->bytes_i2c, (unsigned long)m->quadros_matriz,
+                    (unsigned long)m->quadros_matriz_iguais, m->pbuf_usados, m->pbuf_max, (unsigned long)m->memp_erros,
+                    (unsigned long)m->mem_usada, (unsigned long)m->mem_max, (unsigned long)m->heap_livre);
+}
@@ -0,0 +1,90 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Contadores de diagnóstico, baratos o bastante para ficarem ligados em produção: nos caminhos
+// quentes há apenas incrementos e comparações; a formatação acontece só no instantâneo periódico.
+// Cada contador tem um único escritor (o núcleo indicado), então dispensa travas; o leitor do outro
+// núcleo pode ver um valor de um instante antes, o que basta para diagnóstico.
+
+typedef struct {
+    // Núcleo 0: publicações MQTT e conexão
+    uint32_t publicacoes_tentadas;
+    uint32_t publicacoes_recusadas;    // mqtt_publish com erro (sem conexão, anel ou pedidos esgotados)
+    uint32_t publicacoes_confirmadas;  // Callback sem erro (PUBACK no QoS 1)
+    uint32_t publicacoes_falhas;       // Callback com erro (prazo do PUBACK esgotado)
+    uint32_t publicacoes_perdidas;     // Pendentes descartadas na queda da conexão, sem callback
+    uint16_t em_voo;                   // Publicações aguardando callback
+    uint16_t em_voo_max;
+    uint32_t conexoes;                 // CONNACKs aceitos; as reconexões são as seguintes à primeira
+    uint32_t connack_telemetria_us;    // Do último CONNACK à primeira telemetria publicada depois dele
+
+    // Núcleo 1: interrupções e display
+    uint32_t interrupcoes_botao;
+    uint32_t eventos_descartados;      // Fila de eventos cheia na interrupção
+    uint32_t renderizacao_us;          // Duração do último desenho do display
+    uint32_t renderizacao_max_us;
+
+    // Amostrados no instantâneo (metricas_amostra)
+    uint32_t blocos_adc;
+    uint32_t bytes_i2c;
+    uint32_t envio_display_us;
+    uint32_t quadros_matriz;           // Quadros enviados à matriz de LEDs
+    uint32_t quadros_matriz_iguais;    // Quadros iguais ao anterior, não reenviados
+    uint16_t pbuf_usados;
+    uint16_t pbuf_max;
+    uint32_t memp_erros;               // Falhas de alocação em todos os pools do lwIP
+    uint32_t mem_usada;                // Heap do lwIP (MEM_SIZE)
+    uint32_t mem_max;
+    uint32_t heap_livre;               // Heap do C (malloc), 0 fora do alvo
+} metricas_t;
+
+extern metricas_t metricas;
+
+// Resultado de mqtt_publish (0 é ERR_OK); só as aceitas ficam em voo
+static inline void metricas_publicacao(int erro) {
+    metricas.publicacoes_tentadas++;
+    if (erro) {
+        metricas.publicacoes_recusadas++;
+        return;
+    }
+    if (++metricas.em_voo > metricas.em_voo_max) {
+        metricas.em_voo_max = metricas.em_voo;
+    }
+}
+
+// Callback de uma publicação aceita
+static inline void metricas_publicacao_concluida(int erro) {
+    if (metricas.em_voo) {
+        metricas.em_voo--;
+    }
+    if (erro) {
+        metricas.publicacoes_falhas++;
+    } else {
+        metricas.publicacoes_confirmadas++;
+    }
+}
+
+// Queda da conexão: o lwIP descarta os pedidos pendentes sem chamar os callbacks
+static inline void metricas_conexao_perdida(void) {
+    metricas.publicacoes_perdidas += metricas.em_voo;
+    metricas.em_voo = 0;
+}
+
+static inline void metricas_renderizacao(uint32_t us) {
+    metricas.renderizacao_us = us;
+    if (us > metricas.renderizacao_max_us) {
+        metricas.renderizacao_max_us = us;
+    }
+}
+
+// Lê os pools do lwIP e o heap; chamar no núcleo 0 (contexto do lwIP)
+void metricas_amostra(void);
+
+// Escreve o instantâneo em uma linha "chave=valor"; retorna o tamanho como snprintf
+int metricas_formata(char *destino, size_t tamanho);
+
+#endif
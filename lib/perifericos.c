@@ -1,7 +1,33 @@
+#include <string.h>
 #include "perifericos.h"
+#include "log.h"
 
 // Declaração de variáveis globais
 ssd1306_t ssd;
+static volatile uint32_t inicio_envio_us = 0;  // Início do envio assíncrono em andamento
+static volatile uint32_t duracao_envio_us = 0; // Duração do último envio do display
+static uint32_t abortos_registrados = 0;        // Envios abortados já registrados no log
+
+#define CAMPO_MAX_CARACTERES 12
+
+// Campo de valor com posição e largura fixas sobre o modelo estático da tela
+typedef struct {
+    uint8_t x, y;
+    uint8_t largura;                          // Largura em caracteres
+    char texto[CAMPO_MAX_CARACTERES + 1];     // Último texto desenhado
+} campo_display_t;
+
+static campo_display_t campo_temperatura = { .x = 56, .y = 32, .largura = 6 }; // Após "Temp: "
+static campo_display_t campo_batimento = { .x = 48, .y = 42, .largura = 3 };   // Após "BPM: "
+
+static void desenhar_modelo();
+
+// Fim do envio do quadro pelo DMA (contexto de interrupção); um envio abortado não conta como duração
+static void display_envio_concluido(ssd1306_t *display, bool ok, void *user_data) {
+    if (ok) {
+        duracao_envio_us = time_us_32() - inicio_envio_us;
+    }
+}
 
 // Inicialização do display OLED SSD1306
 void init_ssd(){
@@ -13,13 +39,31 @@ void init_ssd(){
     gpio_pull_up(I2C_SCL);
     ssd1306_init(&ssd, WIDTH, HEIGHT, false, ENDERECO, I2C_PORT);
     ssd1306_config(&ssd);
+
+    // A moldura é desenhada uma única vez; depois só os campos de valor são atualizados
+    desenhar_modelo();
     ssd1306_send_data(&ssd);
+
+    // A partir daqui os quadros seguem por DMA, sem bloquear o laço principal
+    if (ssd1306_init_dma(&ssd)) {
+        ssd1306_set_flush_callback(&ssd, display_envio_concluido, NULL);
+    } else {
+        LOG(DISPLAY_BLOQUEANTE);
+    }
 }
 
-// Mostra informações no display OLED
-void display_info(float temperatura, int batimento) {
-    char buffer[32]; // Buffer para formatação de strings
-    
+// Duração, em microssegundos, do último envio assíncrono do display
+uint32_t display_tempo_envio_us() {
+    return duracao_envio_us;
+}
+
+// Bytes enviados ao display pelo I2C desde a inicialização
+uint32_t display_bytes_enviados() {
+    return ssd.bytes_sent;
+}
+
+// Desenha a parte estática da tela: borda, título, divisória, rótulos e cruz médica
+static void desenhar_modelo() {
     ssd1306_fill(&ssd, 1);
 
     // Borda do display
@@ -31,14 +75,10 @@ void display_info(float temperatura, int batimento) {
     
     // Linha divisória
     ssd1306_hline(&ssd, 8, 119, 26, true);
-    
-    // Exibir temperatura
-    sprintf(buffer, "Temp: %.1f C", temperatura);
-    ssd1306_draw_string(&ssd, buffer, 8, 32);
-    
-    // Exibir batimento
-    sprintf(buffer, "BPM: %d", batimento);
-    ssd1306_draw_string(&ssd, buffer, 8, 42);
+
+    // Rótulos dos campos de valor
+    ssd1306_draw_string(&ssd, "Temp:", 8, 32);
+    ssd1306_draw_string(&ssd, "BPM:", 8, 42);
 
     // Cruz médica
     // Barra vertical da cruz (3 pixels de largura)
@@ -46,8 +86,45 @@ void display_info(float temperatura, int batimento) {
     
     // Barra horizontal da cruz (3 pixels de altura)
     ssd1306_rect(&ssd, 10, 108, 11, 3, true, true);
+}
 
-    ssd1306_send_data(&ssd);
+// Redesenha o campo apenas se o texto formatado mudou.
+// O texto é completado com espaços até a largura do campo para apagar restos do valor anterior.
+static void atualizar_campo(campo_display_t *campo, const char *texto) {
+    char novo[CAMPO_MAX_CARACTERES + 1];
+    snprintf(novo, sizeof(novo), "%-*.*s", campo->largura, campo->largura, texto);
+    if (strcmp(novo, campo->texto) == 0) {
+        return;
+    }
+    ssd1306_draw_string(&ssd, novo, campo->x, campo->y);
+    strcpy(campo->texto, novo);
+}
+
+// Mostra informações no display OLED
+void display_info(float temperatura, int batimento) {
+    char buffer[CAMPO_MAX_CARACTERES + 1]; // Buffer para formatação de strings
+
+    // Exibir temperatura
+    snprintf(buffer, sizeof(buffer), "%.1f C", temperatura);
+    atualizar_campo(&campo_temperatura, buffer);
+
+    // Exibir batimento
+    snprintf(buffer, sizeof(buffer), "%d", batimento);
+    atualizar_campo(&campo_batimento, buffer);
+
+    // O tratador de interrupção só conta os abortos; o registro fica para fora dele
+    if (ssd.aborts != abortos_registrados) {
+        abortos_registrados = ssd.aborts;
+        LOG(DISPLAY_ENVIO_ABORTADO, (unsigned long)abortos_registrados);
+    }
+
+    // Envia somente as regiões que mudaram desde o último quadro, sem bloquear.
+    // Se o quadro anterior ainda estiver em trânsito, as alterações seguem no próximo envio.
+    uint32_t agora = time_us_32();
+    if (!ssd1306_busy(&ssd)) {
+        inicio_envio_us = agora;
+    }
+    ssd1306_send_dirty_async(&ssd);
 }
 
 
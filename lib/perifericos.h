@@ -28,6 +28,8 @@
 // Cabeçalho para funções de controle de periféricos
 void init_ssd();
 void display_info(float temperatura, int batimento);
+uint32_t display_tempo_envio_us();
+uint32_t display_bytes_enviados();
 void pwm_setup(uint pino);
 void iniciar_buzzer(uint pin);
 void parar_buzzer(uint pin);
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "sinais.h"
+#include "hardware/sync.h"
+
+// Conversão do valor do joystick (Q4, 16 a 4081) para as faixas simuladas, com fatores em Q16
+#define SINAIS_ADC_MINIMO_Q4 (16 << 4)
+#define SINAIS_K_TEMPERATURA 32244   // 2000 centésimos de grau / 4065 contagens, em Q16 (faixa de 26 a 46 °C)
+#define SINAIS_K_BATIMENTO 1290      // 80 BPM / 4065 contagens, em Q16 (faixa de 40 a 120 BPM)
+
+// Limites do detector de pulso
+#define SINAIS_AMPLITUDE_MINIMA 8            // Abaixo disso (em contagens do ADC) não há pulso detectável
+#define SINAIS_INTERVALO_MINIMO_US 272727    // 220 BPM: picos mais próximos são descartados (período refratário)
+#define SINAIS_INTERVALO_MAXIMO_US 2000000   // 30 BPM: intervalos maiores não entram na média
+#define SINAIS_SEM_PULSO_US 3000000          // Sem picos por esse tempo, o BPM volta a 0
+#define SINAIS_ALFA_LINHA_BASE_Q15 1638      // ~0,05: segue só a componente lenta do sinal
+
+static passa_baixa_t filtro_temperatura;
+static media_movel_t media_temperatura;
+#if SINAIS_BATIMENTO_POR_PULSO
+static detector_pulso_t detector_batimento;
+#else
+static media_movel_t media_batimento;
+#endif
+
+// Último resultado, protegido por um contador de versão (ímpar durante a escrita)
+static sinais_leitura_t ultima;
+static volatile uint32_t versao = 0;
+
+void media_movel_init(media_movel_t *media, uint8_t tamanho) {
+    if (tamanho == 0) {
+        tamanho = 1;
+    } else if (tamanho > SINAIS_JANELA_MAX) {
+        tamanho = SINAIS_JANELA_MAX;
+    }
+    media->tamanho = tamanho;
+    media->indice = 0;
+    media->contagem = 0;
+    media->soma = 0;
+}
+
+int32_t media_movel_atualiza(media_movel_t *media, int32_t amostra) {
+    if (media->contagem == media->tamanho) {
+        media->soma -= media->amostras[media->indice];
+    } else {
+        media->contagem++;
+    }
+    media->amostras[media->indice] = amostra;
+    media->soma += amostra;
+    media->indice = (media->indice + 1 == media->tamanho) ? 0 : media->indice + 1;
+    return media->soma / media->contagem;
+}
+
+void passa_baixa_init(passa_baixa_t *filtro, uint16_t alfa_q15) {
+    filtro->estado = 0;
+    filtro->alfa_q15 = alfa_q15;
+    filtro->iniciado = false;
+}
+
+// O estado guarda 8 bits fracionários para não perder passos pequenos; amostras de até 23 bits
+int32_t passa_baixa_atualiza(passa_baixa_t *filtro, int32_t amostra) {
+    int32_t entrada = amostra * 256;
+    if (!filtro->iniciado) {
+        filtro->estado = entrada;
+        filtro->iniciado = true;
+    } else {
+        int32_t erro = entrada - filtro->estado;
+        filtro->estado += (int32_t)(((int64_t)erro * filtro->alfa_q15) >> 15);
+    }
+    return (filtro->estado + 128) >> 8;
+}
+
+void detector_pulso_init(detector_pulso_t *detector, uint8_t janela, uint8_t intervalos) {
+    passa_baixa_init(&detector->linha_base, SINAIS_ALFA_LINHA_BASE_Q15);
+    media_movel_init(&detector->suavizacao, janela);
+    if (intervalos == 0) {
+        intervalos = 1;
+    } else if (intervalos > SINAIS_INTERVALOS_MAX) {
+        intervalos = SINAIS_INTERVALOS_MAX;
+    }
+    detector->num_intervalos = intervalos;
+    detector->indice_intervalo = 0;
+    detector->contagem_intervalos = 0;
+    detector->soma_intervalos = 0;
+    detector->envoltoria = 0;
+    detector->maximo = 0;
+    detector->acima = false;
+    detector->tem_pico = false;
+}
+
+// Registra um pico e atualiza a média dos intervalos
+static void detector_registra_pico(detector_pulso_t *detector, uint32_t instante_us) {
+    if (detector->tem_pico) {
+        uint32_t intervalo = instante_us - detector->ultimo_pico_us;
+        if (intervalo < SINAIS_INTERVALO_MINIMO_US) {
+            return; // Pico dentro do período refratário: provavelmente a onda dicrótica
+        }
+        if (intervalo <= SINAIS_INTERVALO_MAXIMO_US) {
+            if (detector->contagem_intervalos == detector->num_intervalos) {
+                detector->soma_intervalos -= detector->intervalos[detector->indice_intervalo];
+            } else {
+                detector->contagem_intervalos++;
+            }
+            detector->intervalos[detector->indice_intervalo] = intervalo;
+            detector->soma_intervalos += intervalo;
+            detector->indice_intervalo = (detector->indice_intervalo + 1 == detector->num_intervalos) ? 0 : detector->indice_intervalo + 1;
+        }
+    }
+    detector->ultimo_pico_us = instante_us;
+    detector->tem_pico = true;
+}
+
+// Remove a linha de base, suaviza e procura picos acima de metade da envoltória.
+// Retorna o BPM médio dos últimos intervalos, ou 0 sem pulso recente.
+int32_t detector_pulso_atualiza(detector_pulso_t *detector, int32_t amostra, uint32_t instante_us) {
+    int32_t base = passa_baixa_atualiza(&detector->linha_base, amostra);
+    int32_t alternada = media_movel_atualiza(&detector->suavizacao, amostra - base);
+
+    // A envoltória acompanha os picos na subida e decai cerca de 1,5% por amostra
+    if (alternada > detector->envoltoria) {
+        detector->envoltoria = alternada;
+    } else {
+        detector->envoltoria -= detector->envoltoria >> 6;
+    }
+
+    int32_t limiar = detector->envoltoria >> 1;
+    if (limiar < SINAIS_AMPLITUDE_MINIMA) {
+        detector->acima = false;
+    } else if (!detector->acima) {
+        if (alternada > limiar) {
+            detector->acima = true;
+            detector->maximo = alternada;
+            detector->instante_maximo_us = instante_us;
+        }
+    } else if (alternada > detector->maximo) {
+        detector->maximo = alternada;
+        detector->instante_maximo_us = instante_us;
+    } else if (alternada < limiar) {
+        // Fim do pulso: o pico é o máximo visto acima do limiar
+        detector->acima = false;
+        detector_registra_pico(detector, detector->instante_maximo_us);
+    }
+
+    if (!detector->tem_pico || instante_us - detector->ultimo_pico_us > SINAIS_SEM_PULSO_US) {
+        detector->contagem_intervalos = 0;
+        detector->soma_intervalos = 0;
+        detector->indice_intervalo = 0;
+        return 0;
+    }
+    if (detector->contagem_intervalos == 0) {
+        return 0;
+    }
+    return (60000000u * detector->contagem_intervalos + detector->soma_intervalos / 2) / detector->soma_intervalos;
+}
+
+void sinais_config_padrao(sinais_config_t *config) {
+    config->janela_temperatura = 8;
+    config->alfa_temperatura_q15 = 1638;  // ~0,05 por amostra decimada
+    config->janela_batimento = SINAIS_BATIMENTO_POR_PULSO ? 4 : 16;
+    config->intervalos_batimento = 4;
+}
+
+void sinais_init(const sinais_config_t *config) {
+    passa_baixa_init(&filtro_temperatura, config->alfa_temperatura_q15);
+    media_movel_init(&media_temperatura, config->janela_temperatura);
+#if SINAIS_BATIMENTO_POR_PULSO
+    detector_pulso_init(&detector_batimento, config->janela_batimento, config->intervalos_batimento);
+#else
+    media_movel_init(&media_batimento, config->janela_batimento);
+#endif
+}
+
+// Processa uma leitura decimada do ADC
+void sinais_processa(const aq_leitura_t *leitura) {
+    // Temperatura: passa-baixa seguido de média móvel, com 4 bits fracionários até a conversão
+    int32_t temperatura_q4 = passa_baixa_atualiza(&filtro_temperatura, leitura->valor[AQ_CANAL_TEMPERATURA] << 4);
+    temperatura_q4 = media_movel_atualiza(&media_temperatura, temperatura_q4);
+    int32_t temperatura_c100 = 2600 + (((temperatura_q4 - SINAIS_ADC_MINIMO_Q4) * SINAIS_K_TEMPERATURA) >> 20);
+
+#if SINAIS_BATIMENTO_POR_PULSO
+    int32_t batimento_bpm = detector_pulso_atualiza(&detector_batimento, leitura->valor[AQ_CANAL_BATIMENTO], leitura->instante_us);
+#else
+    int32_t batimento_q4 = media_movel_atualiza(&media_batimento, leitura->valor[AQ_CANAL_BATIMENTO] << 4);
+    int32_t batimento_bpm = 40 + (((batimento_q4 - SINAIS_ADC_MINIMO_Q4) * SINAIS_K_BATIMENTO) >> 20);
+#endif
+
+    versao++;
+    __dmb();
+    ultima.temperatura_c100 = temperatura_c100;
+    ultima.batimento_bpm = batimento_bpm;
+    ultima.sequencia = leitura->sequencia;
+    ultima.instante_us = leitura->instante_us;
+    __dmb();
+    versao++;
+}
+
+// Cópia consistente do último resultado
+void sinais_leitura(sinais_leitura_t *leitura) {
+    uint32_t inicio;
+    do {
+        inicio = versao;
+        __dmb();
+        *leitura = ultima;
+        __dmb();
+    } while ((inicio & 1) || inicio != versao);
+}
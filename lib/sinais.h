@@ -0,0 +1,88 @@
+#ifndef SINAIS_H
+#define SINAIS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "aquisicao.h"
+
+// Processamento dos sinais vitais em ponto fixo (o M0+ não tem FPU).
+// Todas as etapas têm custo constante por amostra decimada.
+
+#define SINAIS_JANELA_MAX 32        // Maior janela de média móvel
+#define SINAIS_INTERVALOS_MAX 8     // Maior número de intervalos entre batimentos na média
+
+// 1 usa o canal de batimento como forma de onda de pulso (sensor óptico) e estima o BPM pelos picos.
+// 0 trata o canal como valor direto de BPM (joystick da BitDogLab).
+#ifndef SINAIS_BATIMENTO_POR_PULSO
+#define SINAIS_BATIMENTO_POR_PULSO 0
+#endif
+
+// Média móvel com soma acumulada
+typedef struct {
+    int32_t amostras[SINAIS_JANELA_MAX];
+    int32_t soma;
+    uint8_t tamanho;    // Tamanho da janela
+    uint8_t indice;     // Próxima posição a ser sobrescrita
+    uint8_t contagem;   // Amostras válidas (até preencher a janela)
+} media_movel_t;
+
+// Passa-baixa IIR de primeira ordem: y += alfa * (x - y), alfa em Q15 e estado em Q8 (amostra * 256)
+typedef struct {
+    int32_t estado;
+    uint16_t alfa_q15;
+    bool iniciado;
+} passa_baixa_t;
+
+// Estimador de frequência cardíaca por detecção de picos na forma de onda de pulso
+typedef struct {
+    passa_baixa_t linha_base;    // Componente contínua, removida antes da detecção
+    media_movel_t suavizacao;    // Suavização da componente alternada
+    int32_t envoltoria;          // Amplitude recente dos picos, com decaimento
+    int32_t maximo;              // Maior valor desde que o sinal cruzou o limiar
+    uint32_t instante_maximo_us;
+    uint32_t ultimo_pico_us;
+    bool acima;                  // Sinal acima do limiar
+    bool tem_pico;               // Já houve um pico de referência
+    uint32_t intervalos[SINAIS_INTERVALOS_MAX];
+    uint32_t soma_intervalos;
+    uint8_t num_intervalos;      // Tamanho da média de intervalos
+    uint8_t indice_intervalo;
+    uint8_t contagem_intervalos;
+} detector_pulso_t;
+
+// Parâmetros do processamento
+typedef struct {
+    uint8_t janela_temperatura;      // Média móvel aplicada após o passa-baixa
+    uint16_t alfa_temperatura_q15;   // Corte do passa-baixa da temperatura
+    uint8_t janela_batimento;        // Média móvel do BPM (modo direto) ou da forma de onda (modo pulso)
+    uint8_t intervalos_batimento;    // Intervalos entre picos usados na média do BPM
+} sinais_config_t;
+
+// Resultado do processamento, publicado a cada bloco decimado
+typedef struct {
+    int32_t temperatura_c100;   // Temperatura em centésimos de grau Celsius
+    int32_t batimento_bpm;      // Batimentos por minuto (0 enquanto não houver estimativa)
+    uint32_t sequencia;
+    uint32_t instante_us;
+} sinais_leitura_t;
+
+void media_movel_init(media_movel_t *media, uint8_t tamanho);
+int32_t media_movel_atualiza(media_movel_t *media, int32_t amostra);
+
+void passa_baixa_init(passa_baixa_t *filtro, uint16_t alfa_q15);
+int32_t passa_baixa_atualiza(passa_baixa_t *filtro, int32_t amostra);
+
+void detector_pulso_init(detector_pulso_t *detector, uint8_t janela, uint8_t intervalos);
+int32_t detector_pulso_atualiza(detector_pulso_t *detector, int32_t amostra, uint32_t instante_us);
+
+// Configuração padrão e inicialização dos filtros
+void sinais_config_padrao(sinais_config_t *config);
+void sinais_init(const sinais_config_t *config);
+
+// Processa uma leitura decimada do ADC (chamada a cada bloco, em contexto de interrupção)
+void sinais_processa(const aq_leitura_t *leitura);
+
+// Cópia consistente do último resultado
+void sinais_leitura(sinais_leitura_t *leitura);
+
+#endif
@@ -1,5 +1,14 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+// Tamanho do fluxo de DMA: quadro completo mais o cabeçalho de cada janela
+#define SSD1306_DMA_WORDS(ssd) ((ssd)->bufsize + SSD1306_MAX_PAGES * 8)
+
+// Display associado a cada controlador I2C, usado pelo tratador de interrupção
+static ssd1306_t *i2c_display[NUM_I2CS];
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -11,6 +20,17 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->tx_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->tx_buffer[0] = 0x40;
+  ssd->dma_channel = -1;
+  ssd->dma_buffer = NULL;
+  ssd->busy = false;
+  ssd->failed = false;
+  ssd->aborts = 0;
+  ssd->bytes_sent = 0;
+  ssd->flush_cb = NULL;
+  ssd->flush_cb_data = NULL;
+  ssd1306_clear_dirty(ssd);
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -42,6 +62,7 @@ void ssd1306_config(ssd1306_t *ssd) {
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_wait_idle(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -50,6 +71,7 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
     2,
     false
   );
+  ssd->bytes_sent += 2;
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
@@ -59,6 +81,7 @@ void ssd1306_send_data(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_PAGE_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->pages - 1);
+  ssd1306_wait_idle(ssd);
   i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
@@ -66,52 +89,354 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     ssd->bufsize,
     false
   );
+  ssd->bytes_sent += ssd->bufsize;
+  ssd1306_clear_dirty(ssd);
+}
+
+// Marca todas as páginas como limpas
+void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  for (uint8_t page = 0; page < SSD1306_MAX_PAGES; ++page) {
+    ssd->dirty_x0[page] = 0xFF;
+    ssd->dirty_x1[page] = 0;
+  }
+}
+
+// Registra a alteração de um byte (coluna x, página page) desde o último envio
+static inline void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x, uint8_t page) {
+  if (x < ssd->dirty_x0[page])
+    ssd->dirty_x0[page] = x;
+  if (x > ssd->dirty_x1[page])
+    ssd->dirty_x1[page] = x;
+}
+
+// Agrupa as páginas alteradas em janelas. Páginas vizinhas são unidas numa só janela
+// quando enviar a união custa menos do que abrir uma janela a mais no barramento.
+uint8_t ssd1306_dirty_windows(const ssd1306_t *ssd, ssd1306_window_t *windows, uint8_t max_windows) {
+  uint8_t count = 0;
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    uint8_t x0 = ssd->dirty_x0[page];
+    uint8_t x1 = ssd->dirty_x1[page];
+    if (x0 > x1)
+      continue;
+
+    if (count > 0) {
+      ssd1306_window_t *last = &windows[count - 1];
+      if (last->page1 + 1 == page) {
+        uint8_t ux0 = x0 < last->x0 ? x0 : last->x0;
+        uint8_t ux1 = x1 > last->x1 ? x1 : last->x1;
+        uint8_t pages = last->page1 - last->page0 + 1;
+        size_t separate = (size_t)(last->x1 - last->x0 + 1) * pages + (x1 - x0 + 1) + SSD1306_WINDOW_OVERHEAD;
+        size_t merged = (size_t)(ux1 - ux0 + 1) * (pages + 1);
+        if (merged <= separate) {
+          last->x0 = ux0;
+          last->x1 = ux1;
+          last->page1 = page;
+          continue;
+        }
+      }
+    }
+
+    if (count == max_windows) {
+      // Sem espaço: estende a última janela até esta página
+      ssd1306_window_t *last = &windows[count - 1];
+      if (x0 < last->x0) last->x0 = x0;
+      if (x1 > last->x1) last->x1 = x1;
+      last->page1 = page;
+      continue;
+    }
+    windows[count++] = (ssd1306_window_t){ .x0 = x0, .x1 = x1, .page0 = page, .page1 = page };
+  }
+  return count;
+}
+
+// Envia apenas as janelas alteradas desde o último envio. Retorna o número de bytes de imagem enviados.
+size_t ssd1306_send_dirty(ssd1306_t *ssd) {
+  ssd1306_wait_idle(ssd);
+  ssd1306_window_t windows[SSD1306_MAX_PAGES];
+  uint8_t count = ssd1306_dirty_windows(ssd, windows, SSD1306_MAX_PAGES);
+  size_t total = 0;
+
+  for (uint8_t w = 0; w < count; ++w) {
+    const ssd1306_window_t *win = &windows[w];
+
+    // Endereçamento da janela em uma única transação (Co = 0, vários comandos seguidos)
+    uint8_t prelude[7] = {
+      0x00,
+      SET_COL_ADDR, win->x0, win->x1,
+      SET_PAGE_ADDR, win->page0, win->page1
+    };
+    i2c_write_blocking(ssd->i2c_port, ssd->address, prelude, sizeof(prelude), false);
+
+    // No modo de endereçamento vertical os dados seguem coluna a coluna
+    size_t len = 1;
+    for (uint16_t x = win->x0; x <= win->x1; ++x) {
+      const uint8_t *column = &ssd->ram_buffer[x * ssd->pages + 1];
+      for (uint8_t page = win->page0; page <= win->page1; ++page)
+        ssd->tx_buffer[len++] = column[page];
+    }
+    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->tx_buffer, len, false);
+    ssd->bytes_sent += sizeof(prelude) + len;
+    total += len - 1;
+  }
+
+  ssd1306_clear_dirty(ssd);
+  return total;
+}
+
+// Fim de um envio assíncrono: desliga as interrupções do I2C, libera o buffer de transmissão e avisa o
+// usuário. Um envio abortado deixa o quadro incompleto no display, então o próximo manda a tela inteira.
+static void ssd1306_finish(ssd1306_t *ssd, bool ok) {
+  i2c_get_hw(ssd->i2c_port)->intr_mask = 0;
+  if (!ok) {
+    ssd->failed = true;
+    ssd->aborts++;
+  }
+  ssd->busy = false;
+  if (ssd->flush_cb)
+    ssd->flush_cb(ssd, ok, ssd->flush_cb_data);
+}
+
+// Cancela o envio: para o DMA e limpa o aborto, que mantém o FIFO de transmissão descartando dados
+static void ssd1306_abort(ssd1306_t *ssd) {
+  dma_channel_abort(ssd->dma_channel);
+  (void)i2c_get_hw(ssd->i2c_port)->clr_tx_abrt;
+  ssd1306_finish(ssd, false);
+}
+
+// Cada janela termina com um STOP. O envio acaba no STOP em que o DMA já entregou todo o quadro e o FIFO
+// esvaziou; um NACK ou perda de arbitragem aborta a transmissão (TX_ABRT) e o DMA ficaria parado no DREQ.
+static void ssd1306_i2c_irq_handler(void) {
+  for (uint index = 0; index < NUM_I2CS; ++index) {
+    ssd1306_t *ssd = i2c_display[index];
+    if (!ssd || !ssd->busy)
+      continue;
+    i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+    uint32_t status = hw->intr_stat;
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+      ssd1306_abort(ssd);
+    } else if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+      (void)hw->clr_stop_det;
+      if (!dma_channel_is_busy(ssd->dma_channel) && (hw->status & I2C_IC_STATUS_TFE_BITS))
+        ssd1306_finish(ssd, true);
+    }
+  }
+}
+
+// Prepara um canal de DMA que alimenta o FIFO de transmissão do I2C
+bool ssd1306_init_dma(ssd1306_t *ssd) {
+  int channel = dma_claim_unused_channel(false);
+  if (channel < 0)
+    return false;
+
+  ssd->dma_buffer = calloc(SSD1306_DMA_WORDS(ssd), sizeof(uint16_t));
+  if (!ssd->dma_buffer) {
+    dma_channel_unclaim(channel);
+    return false;
+  }
+
+  // Cada palavra de 16 bits carrega o byte e os bits de controle (STOP) do IC_DATA_CMD
+  dma_channel_config config = dma_channel_get_default_config(channel);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+  channel_config_set_read_increment(&config, true);
+  channel_config_set_write_increment(&config, false);
+  channel_config_set_dreq(&config, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(channel, &config, &i2c_get_hw(ssd->i2c_port)->data_cmd, ssd->dma_buffer, 0, false);
+
+  // As interrupções do I2C só ficam habilitadas durante um envio assíncrono: as escritas bloqueantes do
+  // SDK consultam e limpam os mesmos bits (STOP_DET, TX_ABRT) por conta própria
+  uint index = i2c_hw_index(ssd->i2c_port);
+  uint irq = I2C0_IRQ + index;
+  i2c_get_hw(ssd->i2c_port)->intr_mask = 0;
+  ssd->dma_channel = channel;
+  i2c_display[index] = ssd;
+  irq_add_shared_handler(irq, ssd1306_i2c_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(irq, true);
+  return true;
+}
+
+void ssd1306_set_flush_callback(ssd1306_t *ssd, ssd1306_flush_cb_t cb, void *user_data) {
+  ssd->flush_cb = cb;
+  ssd->flush_cb_data = user_data;
+}
+
+bool ssd1306_busy(const ssd1306_t *ssd) {
+  return ssd->busy;
+}
+
+// Aguarda o fim do envio assíncrono e o esvaziamento do FIFO do I2C.
+// As escritas bloqueantes do SDK reprogramam o endereço do alvo, o que abortaria bytes ainda no FIFO.
+// Se o prazo esgotar (barramento preso), o envio é cancelado e o controlador reiniciado, o que descarta o
+// FIFO. Retorna false nesse caso ou se o último envio assíncrono foi abortado.
+bool ssd1306_wait_idle(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0)
+    return true;
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  uint32_t start = time_us_32();
+  while (ssd->busy || !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+    if (time_us_32() - start >= SSD1306_TIMEOUT_US) {
+      uint32_t interrupts = save_and_disable_interrupts();
+      if (ssd->busy)
+        ssd1306_abort(ssd);
+      restore_interrupts(interrupts);
+      hw->enable = 0;
+      hw->enable = 1;
+      return false;
+    }
+    tight_loop_contents();
+  }
+  return !ssd->failed;
+}
+
+// Copia as janelas alteradas para o buffer de DMA e inicia o envio sem bloquear.
+// O quadro é copiado no momento da chamada, então o desenho em ram_buffer pode continuar
+// enquanto o envio anterior está no barramento. Retorna false se ainda houver um envio
+// em andamento; nesse caso as marcações são mantidas para a próxima chamada.
+bool ssd1306_send_dirty_async(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0) {
+    ssd1306_send_dirty(ssd);
+    return true;
+  }
+  if (ssd->busy)
+    return false;
+
+  if (ssd->failed) {
+    ssd->failed = false;
+    for (uint8_t page = 0; page < ssd->pages; ++page) {
+      ssd1306_mark_dirty(ssd, 0, page);
+      ssd1306_mark_dirty(ssd, ssd->width - 1, page);
+    }
+  }
+
+  ssd1306_window_t windows[SSD1306_MAX_PAGES];
+  uint8_t count = ssd1306_dirty_windows(ssd, windows, SSD1306_MAX_PAGES);
+  if (count == 0)
+    return true;
+
+  uint16_t *out = ssd->dma_buffer;
+  for (uint8_t w = 0; w < count; ++w) {
+    const ssd1306_window_t *win = &windows[w];
+
+    // Transação de comandos, encerrada com STOP no último byte
+    *out++ = 0x00;
+    *out++ = SET_COL_ADDR;
+    *out++ = win->x0;
+    *out++ = win->x1;
+    *out++ = SET_PAGE_ADDR;
+    *out++ = win->page0;
+    *out++ = win->page1 | I2C_IC_DATA_CMD_STOP_BITS;
+
+    // Transação de dados; o controlador gera um novo START ao encontrar o FIFO com dados após o STOP
+    *out++ = 0x40;
+    for (uint16_t x = win->x0; x <= win->x1; ++x) {
+      const uint8_t *column = &ssd->ram_buffer[x * ssd->pages + 1];
+      for (uint8_t page = win->page0; page <= win->page1; ++page)
+        *out++ = column[page];
+    }
+    out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  }
+  ssd1306_clear_dirty(ssd);
+
+  // O endereço do alvo só pode ser trocado com o controlador desabilitado e ocioso
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if ((hw->tar & I2C_IC_TAR_IC_TAR_BITS) != ssd->address) {
+    ssd1306_wait_idle(ssd);
+    hw->enable = 0;
+    hw->tar = ssd->address;
+    hw->enable = 1;
+  }
+
+  // Descarta eventos das escritas bloqueantes anteriores antes de habilitar as interrupções
+  (void)hw->clr_intr;
+  ssd->busy = true;
+  hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+  ssd->bytes_sent += out - ssd->dma_buffer;
+  dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->dma_buffer, out - ssd->dma_buffer);
+  return true;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
+  uint8_t old = ssd->ram_buffer[index];
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
+  if (ssd->ram_buffer[index] != old)
+    ssd1306_mark_dirty(ssd, x, y >> 3);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+// Escreve em um byte da memória os bits selecionados por mask, marcando a coluna se o byte mudar.
+// No modo de endereçamento vertical cada coluna ocupa pages bytes consecutivos.
+static inline void ssd1306_put_byte(ssd1306_t *ssd, uint8_t x, uint8_t page, uint8_t mask, uint8_t bits) {
+  uint8_t *byte = &ssd->ram_buffer[x * ssd->pages + page + 1];
+  uint8_t value = (*byte & ~mask) | (bits & mask);
+  if (value != *byte) {
+    *byte = value;
+    ssd1306_mark_dirty(ssd, x, page);
+  }
+}
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+// Preenche a área x0..x1, y0..y1 (inclusive) página a página, com uma máscara de coluna por página
+static void ssd1306_fill_area(ssd1306_t *ssd, uint16_t x0, uint16_t x1, uint16_t y0, uint16_t y1, bool value) {
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+
+  uint8_t bits = value ? 0xFF : 0x00;
+  uint8_t first_page = y0 >> 3;
+  uint8_t last_page = y1 >> 3;
+  for (uint8_t page = first_page; page <= last_page; ++page) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (y0 & 7);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (y1 & 7));
+    for (uint16_t x = x0; x <= x1; ++x)
+      ssd1306_put_byte(ssd, x, page, mask, bits);
+  }
 }
 
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  uint8_t byte = value ? 0xFF : 0x00;
+  uint8_t *buffer = ssd->ram_buffer + 1;
 
+  // Procura, pelas duas pontas de cada página, o trecho que realmente muda
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    int16_t first = 0;
+    while (first < ssd->width && buffer[first * ssd->pages + page] == byte)
+      ++first;
+    if (first == ssd->width)
+      continue;
+    int16_t last = ssd->width - 1;
+    while (buffer[last * ssd->pages + page] == byte)
+      --last;
+    ssd1306_mark_dirty(ssd, first, page);
+    ssd1306_mark_dirty(ssd, last, page);
+  }
+
+  memset(buffer, byte, ssd->bufsize - 1);
+}
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (width == 0 || height == 0)
+    return;
 
+  uint16_t right = left + width - 1;
+  uint16_t bottom = top + height - 1;
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    // Borda e interior recebem o mesmo valor
+    ssd1306_fill_area(ssd, left, right, top, bottom, value);
+    return;
   }
+
+  ssd1306_fill_area(ssd, left, right, top, top, value);
+  ssd1306_fill_area(ssd, left, right, bottom, bottom, value);
+  ssd1306_fill_area(ssd, left, left, top, bottom, value);
+  ssd1306_fill_area(ssd, right, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -144,13 +469,11 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_fill_area(ssd, x0, x1, y, y, value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_fill_area(ssd, x, x, y0, y1, value);
 }
 
 // Função para desenhar um caractere
@@ -169,14 +492,21 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
   }
 
-  // Desenha o caractere na tela
+  // Cada byte da fonte é uma coluna de 8 pixels, no mesmo formato de uma página do display.
+  // Com y alinhado a coluna cabe em uma página; caso contrário é deslocada entre duas páginas.
+  const uint8_t *glyph = &font[index];
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 7;
   for (uint8_t i = 0; i < 8; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
+    uint16_t column = x + i;
+    if (column >= ssd->width)
+      break;
+    uint8_t line = glyph[i];
+    if (page < ssd->pages)
+      ssd1306_put_byte(ssd, column, page, 0xFF << shift, line << shift);
+    if (shift && page + 1 < ssd->pages)
+      ssd1306_put_byte(ssd, column, page + 1, 0xFF >> (8 - shift), line >> (8 - shift));
   }
 }
 
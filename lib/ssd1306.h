@@ -1,10 +1,15 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
 #define WIDTH 128
 #define HEIGHT 64
 
+#define SSD1306_MAX_PAGES 8          // Maior número de páginas suportado (altura de 64 pixels)
+#define SSD1306_WINDOW_OVERHEAD 10   // Custo aproximado, em bytes, de abrir uma janela extra no barramento
+#define SSD1306_TIMEOUT_US 100000    // Prazo de um envio assíncrono (um quadro inteiro leva ~25 ms a 400 kHz)
+
 typedef enum {
   SET_CONTRAST = 0x81,
   SET_ENTIRE_ON = 0xA4,
@@ -25,19 +30,50 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
-typedef struct {
+typedef struct ssd1306 ssd1306_t;
+
+// Chamada ao término de um envio assíncrono (executa em contexto de interrupção do I2C, ou em
+// ssd1306_wait_idle se o prazo esgotar). ok é false se o envio foi abortado.
+typedef void (*ssd1306_flush_cb_t)(ssd1306_t *ssd, bool ok, void *user_data);
+
+struct ssd1306 {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
-} ssd1306_t;
+  uint8_t *tx_buffer;                    // Janela recolhida para o envio parcial
+  uint8_t dirty_x0[SSD1306_MAX_PAGES];   // Primeira coluna alterada em cada página
+  uint8_t dirty_x1[SSD1306_MAX_PAGES];   // Última coluna alterada (x0 > x1 indica página limpa)
+  int dma_channel;                       // Canal de DMA do envio assíncrono (-1 se não configurado)
+  uint16_t *dma_buffer;                  // Quadro em trânsito, já no formato do registrador IC_DATA_CMD
+  volatile bool busy;                    // Há um envio assíncrono em andamento
+  volatile bool failed;                  // O último envio assíncrono foi abortado; o próximo manda a tela inteira
+  volatile uint32_t aborts;              // Envios assíncronos abortados desde a inicialização
+  uint32_t bytes_sent;                   // Bytes entregues ao I2C desde a inicialização
+  ssd1306_flush_cb_t flush_cb;
+  void *flush_cb_data;
+};
+
+// Janela retangular da memória do display: colunas x0..x1 e páginas page0..page1
+typedef struct {
+  uint8_t x0, x1, page0, page1;
+} ssd1306_window_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+size_t ssd1306_send_dirty(ssd1306_t *ssd);
+uint8_t ssd1306_dirty_windows(const ssd1306_t *ssd, ssd1306_window_t *windows, uint8_t max_windows);
+void ssd1306_clear_dirty(ssd1306_t *ssd);
+
+bool ssd1306_init_dma(ssd1306_t *ssd);
+void ssd1306_set_flush_callback(ssd1306_t *ssd, ssd1306_flush_cb_t cb, void *user_data);
+bool ssd1306_send_dirty_async(ssd1306_t *ssd);
+bool ssd1306_busy(const ssd1306_t *ssd);
+bool ssd1306_wait_idle(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -0,0 +1,189 @@
+#include "telemetria.h"
+
+#define TELEMETRIA_POSICAO_FLAGS 1
+#define TELEMETRIA_POSICAO_CONTAGEM 2
+
+// Escreve um varint; retorna o número de bytes ou 0 se não couber
+static size_t escreve_varint(uint8_t *destino, size_t disponivel, uint32_t valor) {
+    size_t n = 0;
+    do {
+        if (n == disponivel) {
+            return 0;
+        }
+        uint8_t byte = valor & 0x7F;
+        valor >>= 7;
+        destino[n++] = valor ? (byte | 0x80) : byte;
+    } while (valor);
+    return n;
+}
+
+// Lê um varint de até 5 bytes; retorna false se a mensagem acabar antes
+static bool le_varint(telemetria_decodificador_t *dec, uint32_t *valor) {
+    uint32_t resultado = 0;
+    for (uint8_t deslocamento = 0; deslocamento < 35; deslocamento += 7) {
+        if (dec->posicao >= dec->tamanho) {
+            return false;
+        }
+        uint8_t byte = dec->dados[dec->posicao++];
+        resultado |= (uint32_t)(byte & 0x7F) << deslocamento;
+        if (!(byte & 0x80)) {
+            *valor = resultado;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Zigzag: valores pequenos, positivos ou negativos, ficam com poucos bytes
+static inline uint32_t zigzag(int32_t valor) {
+    return ((uint32_t)valor << 1) ^ (uint32_t)(valor >> 31);
+}
+
+static inline int32_t dezigzag(uint32_t valor) {
+    return (int32_t)(valor >> 1) ^ -(int32_t)(valor & 1);
+}
+
+bool telemetria_inicia(telemetria_codificador_t *cod, uint8_t *buffer, size_t capacidade,
+                       uint32_t sequencia, uint32_t instante_base_ms) {
+    cod->buffer = buffer;
+    cod->capacidade = capacidade;
+    cod->contagem = 0;
+    cod->ultimo_ms = instante_base_ms;
+    cod->tamanho = 0;
+    if (capacidade < 3) {
+        return false;
+    }
+    buffer[0] = TELEMETRIA_VERSAO;
+    buffer[TELEMETRIA_POSICAO_FLAGS] = 0;
+    buffer[TELEMETRIA_POSICAO_CONTAGEM] = 0;
+    size_t n = 3;
+    size_t escrito = escreve_varint(buffer + n, capacidade - n, sequencia);
+    if (!escrito) {
+        return false;
+    }
+    n += escrito;
+    escrito = escreve_varint(buffer + n, capacidade - n, instante_base_ms);
+    if (!escrito) {
+        return false;
+    }
+    cod->tamanho = n + escrito;
+    return true;
+}
+
+bool telemetria_adiciona(telemetria_codificador_t *cod, const telemetria_registro_t *registro) {
+    if (cod->tamanho == 0 || cod->contagem == UINT8_MAX || (cod->buffer[TELEMETRIA_POSICAO_FLAGS] & TELEMETRIA_FLAG_RESUMO)) {
+        return false;
+    }
+
+    uint8_t *destino = cod->buffer + cod->tamanho;
+    size_t disponivel = cod->capacidade - cod->tamanho;
+    size_t n = 0, escrito;
+
+    if (!(escrito = escreve_varint(destino + n, disponivel - n, registro->instante_ms - cod->ultimo_ms))) return false;
+    n += escrito;
+    if (!(escrito = escreve_varint(destino + n, disponivel - n, zigzag(registro->temperatura_c100)))) return false;
+    n += escrito;
+    if (!(escrito = escreve_varint(destino + n, disponivel - n, zigzag(registro->batimento_bpm)))) return false;
+    n += escrito;
+    if (n == disponivel) {
+        return false;
+    }
+    destino[n++] = registro->estado;
+
+    cod->tamanho += n;
+    cod->contagem++;
+    cod->ultimo_ms = registro->instante_ms;
+    return true;
+}
+
+bool telemetria_adiciona_resumo(telemetria_codificador_t *cod, const telemetria_resumo_t *resumo) {
+    if (cod->tamanho == 0 || (cod->buffer[TELEMETRIA_POSICAO_FLAGS] & TELEMETRIA_FLAG_RESUMO)) {
+        return false;
+    }
+
+    const int32_t campos[] = {
+        resumo->temperatura_min_c100, resumo->temperatura_max_c100, resumo->temperatura_media_c100,
+        resumo->batimento_min_bpm, resumo->batimento_max_bpm, resumo->batimento_media_bpm,
+    };
+    uint8_t *destino = cod->buffer + cod->tamanho;
+    size_t disponivel = cod->capacidade - cod->tamanho;
+    size_t n = 0;
+    for (size_t i = 0; i < sizeof(campos) / sizeof(campos[0]); i++) {
+        size_t escrito = escreve_varint(destino + n, disponivel - n, zigzag(campos[i]));
+        if (!escrito) {
+            return false;
+        }
+        n += escrito;
+    }
+
+    cod->tamanho += n;
+    cod->buffer[TELEMETRIA_POSICAO_FLAGS] |= TELEMETRIA_FLAG_RESUMO;
+    return true;
+}
+
+size_t telemetria_finaliza(telemetria_codificador_t *cod) {
+    if (cod->tamanho) {
+        cod->buffer[TELEMETRIA_POSICAO_CONTAGEM] = cod->contagem;
+    }
+    return cod->tamanho;
+}
+
+bool telemetria_decodifica_cabecalho(telemetria_decodificador_t *dec, const uint8_t *dados, size_t tamanho,
+                                     telemetria_cabecalho_t *cabecalho) {
+    dec->dados = dados;
+    dec->tamanho = tamanho;
+    dec->posicao = 3;
+    dec->restantes = 0;
+    dec->flags = 0;
+    if (tamanho < 3 || dados[0] != TELEMETRIA_VERSAO) {
+        return false;
+    }
+    cabecalho->versao = dados[0];
+    cabecalho->flags = dados[1];
+    cabecalho->contagem = dados[TELEMETRIA_POSICAO_CONTAGEM];
+    if (!le_varint(dec, &cabecalho->sequencia) || !le_varint(dec, &cabecalho->instante_base_ms)) {
+        return false;
+    }
+    dec->restantes = cabecalho->contagem;
+    dec->flags = cabecalho->flags;
+    dec->ultimo_ms = cabecalho->instante_base_ms;
+    return true;
+}
+
+bool telemetria_proximo(telemetria_decodificador_t *dec, telemetria_registro_t *registro) {
+    if (dec->restantes == 0) {
+        return false;
+    }
+    uint32_t delta, temperatura, batimento;
+    if (!le_varint(dec, &delta) || !le_varint(dec, &temperatura) || !le_varint(dec, &batimento) ||
+        dec->posicao >= dec->tamanho) {
+        dec->restantes = 0;
+        return false;
+    }
+    dec->ultimo_ms += delta;
+    registro->instante_ms = dec->ultimo_ms;
+    registro->temperatura_c100 = dezigzag(temperatura);
+    registro->batimento_bpm = dezigzag(batimento);
+    registro->estado = dec->dados[dec->posicao++];
+    dec->restantes--;
+    return true;
+}
+
+bool telemetria_decodifica_resumo(telemetria_decodificador_t *dec, telemetria_resumo_t *resumo) {
+    if (!(dec->flags & TELEMETRIA_FLAG_RESUMO) || dec->restantes != 0) {
+        return false;
+    }
+    int32_t *campos[] = {
+        &resumo->temperatura_min_c100, &resumo->temperatura_max_c100, &resumo->temperatura_media_c100,
+        &resumo->batimento_min_bpm, &resumo->batimento_max_bpm, &resumo->batimento_media_bpm,
+    };
+    for (size_t i = 0; i < sizeof(campos) / sizeof(campos[0]); i++) {
+        uint32_t valor;
+        if (!le_varint(dec, &valor)) {
+            return false;
+        }
+        *campos[i] = dezigzag(valor);
+    }
+    dec->flags &= ~TELEMETRIA_FLAG_RESUMO;
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Formato binário dos registros de telemetria (versão 1), sem alocação e sem ponto flutuante.
+//
+// Cabeçalho:
+//   versão (1 byte) | flags (1 byte) | número de registros (1 byte)
+//   sequência (varint) | instante base em ms (varint)
+// Cada registro:
+//   delta do instante em ms em relação ao registro anterior, ou à base no primeiro (varint)
+//   temperatura em centésimos de grau (varint zigzag) | batimento em BPM (varint zigzag) | estado (1 byte)
+//
+// Resumo (presente quando flags contém TELEMETRIA_FLAG_RESUMO), após o último registro:
+//   temperatura mínima, máxima e média | batimento mínimo, máximo e médio (varints zigzag)
+//
+// Varint: 7 bits por byte, menos significativos primeiro, bit 7 indica continuação.
+
+#define TELEMETRIA_VERSAO 1
+
+// Maior registro codificado: delta (5) + temperatura (5) + batimento (5) + estado (1)
+#define TELEMETRIA_REGISTRO_MAXIMO 16
+#define TELEMETRIA_CABECALHO_MAXIMO 13
+#define TELEMETRIA_RESUMO_MAXIMO 30
+
+// Bits do campo de flags do cabeçalho
+#define TELEMETRIA_FLAG_RESUMO 0x01
+
+// Bits do campo de estado
+#define TELEMETRIA_ALARME_ATIVO  0x01
+#define TELEMETRIA_ALARME_MEDICO 0x02
+#define TELEMETRIA_ALARME_MANUAL 0x04
+
+typedef struct {
+    uint32_t instante_ms;
+    int32_t temperatura_c100;
+    int32_t batimento_bpm;
+    uint8_t estado;
+} telemetria_registro_t;
+
+// Estatísticas de um lote de registros
+typedef struct {
+    int32_t temperatura_min_c100;
+    int32_t temperatura_max_c100;
+    int32_t temperatura_media_c100;
+    int32_t batimento_min_bpm;
+    int32_t batimento_max_bpm;
+    int32_t batimento_media_bpm;
+} telemetria_resumo_t;
+
+typedef struct {
+    uint8_t versao;
+    uint8_t flags;
+    uint8_t contagem;
+    uint32_t sequencia;
+    uint32_t instante_base_ms;
+} telemetria_cabecalho_t;
+
+// Codificador sobre um buffer fornecido pelo chamador
+typedef struct {
+    uint8_t *buffer;
+    size_t capacidade;
+    size_t tamanho;
+    uint8_t contagem;
+    uint32_t ultimo_ms;
+} telemetria_codificador_t;
+
+// Decodificador sobre uma mensagem recebida
+typedef struct {
+    const uint8_t *dados;
+    size_t tamanho;
+    size_t posicao;
+    uint8_t restantes;
+    uint8_t flags;
+    uint32_t ultimo_ms;
+} telemetria_decodificador_t;
+
+// Inicia uma mensagem; retorna false se o buffer não comporta o cabeçalho
+bool telemetria_inicia(telemetria_codificador_t *cod, uint8_t *buffer, size_t capacidade,
+                       uint32_t sequencia, uint32_t instante_base_ms);
+
+// Acrescenta um registro; retorna false (sem alterar a mensagem) se não couber.
+// Os instantes devem ser crescentes e não anteriores à base.
+bool telemetria_adiciona(telemetria_codificador_t *cod, const telemetria_registro_t *registro);
+
+// Acrescenta o resumo após o último registro; nenhum registro pode ser adicionado depois
+bool telemetria_adiciona_resumo(telemetria_codificador_t *cod, const telemetria_resumo_t *resumo);
+
+// Fecha a mensagem e retorna o seu tamanho em bytes
+size_t telemetria_finaliza(telemetria_codificador_t *cod);
+
+// Lê o cabeçalho; retorna false se a mensagem estiver truncada ou for de outra versão
+bool telemetria_decodifica_cabecalho(telemetria_decodificador_t *dec, const uint8_t *dados, size_t tamanho,
+                                     telemetria_cabecalho_t *cabecalho);
+
+// Lê o próximo registro; retorna false ao fim da mensagem ou se ela estiver malformada
+bool telemetria_proximo(telemetria_decodificador_t *dec, telemetria_registro_t *registro);
+
+// Lê o resumo depois de todos os registros; retorna false se a mensagem não tiver resumo
+bool telemetria_decodifica_resumo(telemetria_decodificador_t *dec, telemetria_resumo_t *resumo);
+
+#endif
@@ -0,0 +1,42 @@
+#include <string.h>
+#include "topicos.h"
+
+int topicos_prefixo(char *destino, size_t tamanho, const char *const niveis[], size_t total) {
+    if (!tamanho) {
+        return -1;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < total; i++) {
+        const char *nivel = niveis[i];
+        if (!nivel || !*nivel) {
+            continue;
+        }
+        size_t n = strlen(nivel);
+        if (strpbrk(nivel, "+#") || len + 1 + n >= tamanho) {
+            return -1;
+        }
+        destino[len++] = '/';
+        memcpy(&destino[len], nivel, n);
+        len += n;
+    }
+    destino[len] = '\0';
+    return (int)len;
+}
+
+bool topicos_monta(const char *tabela[], const char *const nomes[], size_t total, const char *prefixo,
+                   char *armazenamento, size_t tamanho) {
+    size_t tamanho_prefixo = strlen(prefixo);
+    size_t usado = 0;
+    for (size_t i = 0; i < total; i++) {
+        size_t n = strlen(nomes[i]);
+        if (usado + tamanho_prefixo + n + 1 > tamanho) {
+            return false;
+        }
+        char *texto = &armazenamento[usado];
+        memcpy(texto, prefixo, tamanho_prefixo);
+        memcpy(&texto[tamanho_prefixo], nomes[i], n + 1);
+        tabela[i] = texto;
+        usado += tamanho_prefixo + n + 1;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef TOPICOS_H
+#define TOPICOS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Tabela dos tópicos MQTT, montada uma única vez na partida. Cada tópico é o prefixo do dispositivo seguido
+// do nome, guardado em uma área contígua. Depois de montada, a tabela só é lida, então serve a qualquer
+// tarefa, callback ou núcleo sem buffer compartilhado.
+
+// Monta em destino o prefixo "/nivel1/nivel2/...", omitindo os níveis NULL ou vazios (sem nenhum, o prefixo
+// é ""). Retorna o tamanho, ou -1 se não couber ou se um nível tiver os curingas '+' ou '#'.
+int topicos_prefixo(char *destino, size_t tamanho, const char *const niveis[], size_t total);
+
+// Preenche tabela[i] com prefixo + nomes[i], guardados em armazenamento; retorna false se não couber
+bool topicos_monta(const char *tabela[], const char *const nomes[], size_t total, const char *prefixo,
+                   char *armazenamento, size_t tamanho);
+
+#endif
@@ -14,6 +14,12 @@
 
 #define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL+1)
 
+// Uso dos pools e do heap do lwIP, lidos pelas métricas (lib/metricas.c)
+#undef MEM_STATS
+#define MEM_STATS                   1
+#undef MEMP_STATS
+#define MEMP_STATS                  1
+
 #ifdef MQTT_CERT_INC
 #define LWIP_ALTCP               1
 #define LWIP_ALTCP_TLS           1
@@ -30,4 +36,7 @@
 // This defaults to 4
 #define MQTT_REQ_MAX_IN_FLIGHT 5
 
+// This defaults to 256; batched telemetry messages (MQTT_COMBINED_TELEMETRY) can reach about 560 bytes
+#define MQTT_OUTPUT_RINGBUF_SIZE 1024
+
 #endif
@@ -3,4 +3,28 @@
 
 #include "mbedtls_config_examples_common.h"
 
+// Retomada de sessão entre reconexões ao broker (MQTT_TLS_SESSION_RESUMPTION): além do session ID,
+// aceita session tickets, que não dependem de cache no servidor
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+// Definir MQTT_TLS_SINGLE_SUITE como 1 para negociar apenas ECDHE-ECDSA com AES-128-GCM na curva P-256.
+// O ClientHello fica menor, o código das outras curvas e da troca de chaves RSA sai do binário e o
+// handshake completo usa o caminho otimizado da P-256. O certificado do broker precisa ser ECDSA P-256.
+#if MQTT_TLS_SINGLE_SUITE
+#undef MBEDTLS_ECP_DP_SECP192R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP224R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP384R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP521R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP192K1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP224K1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP256K1_ENABLED
+#undef MBEDTLS_ECP_DP_BP256R1_ENABLED
+#undef MBEDTLS_ECP_DP_BP384R1_ENABLED
+#undef MBEDTLS_ECP_DP_BP512R1_ENABLED
+#undef MBEDTLS_ECP_DP_CURVE25519_ENABLED
+#undef MBEDTLS_KEY_EXCHANGE_RSA_ENABLED
+#undef MBEDTLS_CIPHER_MODE_CBC
+#define MBEDTLS_SSL_CIPHERSUITES MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256
+#endif
+
 #endif
\ No newline at end of file
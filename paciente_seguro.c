@@ -1,6 +1,9 @@
 #include "pico/stdlib.h"            // Biblioteca da Raspberry Pi Pico para funções padrão (GPIO, temporização, etc.)
 #include "pico/cyw43_arch.h"        // Biblioteca para arquitetura Wi-Fi da Pico com CYW43
 #include "pico/unique_id.h"         // Biblioteca com recursos para trabalhar com os pinos GPIO do Raspberry Pi Pico
+#include "pico/multicore.h"         // Biblioteca para executar código no núcleo 1
+#include "pico/async_context_poll.h" // Async context do núcleo 1, atendido no próprio laço
+#include "pico/flash.h"             // Escrita na flash com o outro núcleo em espera
 
 #include "hardware/gpio.h"          // Biblioteca de hardware de GPIO
 #include "hardware/irq.h"           // Biblioteca de hardware de interrupções
@@ -8,18 +11,36 @@
 
 #include "lwip/apps/mqtt.h"         // Biblioteca LWIP MQTT -  fornece funções e recursos para conexão MQTT
 #include "lwip/apps/mqtt_priv.h"    // Biblioteca que fornece funções e recursos para Geração de Conexões
-#include "lwip/dns.h"               // Biblioteca que fornece funções e recursos suporte DNS:
 #include "lwip/altcp_tls.h"         // Biblioteca que fornece funções e recursos para conexões seguras usando TLS:
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#include "lwip/apps/altcp_tls_mbedtls_structs.h" // Sessão TLS guardada entre conexões
+#endif
 
 #include "credenciais_mqtt.h" // Altere o arquivo de exemplo dentro do lib para suas credenciais e retire example do nome
 #include "perifericos.h"
-
-float temp_max = 37.0; // Temperatura máxima em graus Celsius
-float temp_min = 34.0; // Temperatura mínima em graus Celsius
-int bpm_max = 100; // Batimento cardíaco máximo
-int bpm_min = 60;  // Batimento cardíaco mínimo
-bool alarme_medico = false; // Variável para controlar o alarme médico
-bool alarme_manual = false; // Variável para controlar o alarme manual
+#include "aquisicao.h"
+#include "sinais.h"
+#include "alarme.h"
+#include "telemetria.h"
+#include "lote.h"
+#include "fila_envio.h"
+#include "conexao.h"
+#include "eventos.h"
+#include "agendador.h"
+#include "latencia.h"
+#include "metricas.h"
+#include "log.h"
+#include "comandos.h"
+#include "topicos.h"
+#include "matriz.h"
+
+#define TEMP_MAX_C100 3700 // Temperatura máxima em centésimos de grau Celsius
+#define TEMP_MIN_C100 3400 // Temperatura mínima em centésimos de grau Celsius
+#define BPM_MAX 100 // Batimento cardíaco máximo
+#define BPM_MIN 60  // Batimento cardíaco mínimo
+static alarme_t alarme; // Estado do alarme médico e manual, usado apenas no núcleo 1
+static volatile uint32_t estado_alarme; // Bits TELEMETRIA_ALARME_* publicados pelo núcleo 1 para o núcleo 0
+static volatile bool aviso_alarme_perdido; // Uma mudança do alarme não coube na fila para o núcleo 0
 
 
 #ifndef MQTT_SERVER
@@ -35,40 +56,78 @@ bool alarme_manual = false; // Variável para controlar o alarme manual
 #define MQTT_TOPIC_LEN 100
 #endif
 
+// Definir como 0 para sempre fazer o handshake TLS completo. Com 1, a sessão da última conexão é
+// oferecida ao broker (session ID ou session ticket) e, se aceita, dispensa a troca de chaves e a
+// verificação de certificados na reconexão.
+#ifndef MQTT_TLS_SESSION_RESUMPTION
+#define MQTT_TLS_SESSION_RESUMPTION 1
+#endif
+
 //Dados do cliente MQTT
 typedef struct {
     mqtt_client_t* mqtt_client_inst;
     struct mqtt_connect_client_info_t mqtt_client_info;
-    char data[MQTT_OUTPUT_RINGBUF_SIZE];
-    char topic[MQTT_TOPIC_LEN];
-    uint32_t len;
+    comandos_t comandos;          // Remontagem e despacho das mensagens de comando recebidas
     ip_addr_t mqtt_server_address;
     bool connect_done;
-    int subscribe_count;
+    bool connected;               // A tentativa atual recebeu o CONNACK
+    uint64_t connect_start_us;    // Início da tentativa atual
+    uint32_t connect_time_ms;     // Da abertura da conexão até o CONNACK, com o handshake TLS
+    uint8_t pedidos_pendentes;    // Bits de pedido_conexao_t ainda não aceitos pelo lwIP
+    uint8_t assinados;            // Bits das assinaturas confirmadas pelo broker
+    bool alarme_pendente;         // O estado atual do alarme ainda não teve PUBACK
+    uint32_t connack_us;          // CONNACK da conexão atual
+    bool aguardando_telemetria;   // Nenhuma telemetria publicada desde o CONNACK
     bool stop_client;
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_TLS_SESSION_RESUMPTION
+    struct altcp_tls_session tls_session;
+    bool tls_session_valid;
+    bool tls_session_offered;     // A tentativa atual ofereceu a sessão guardada
+#endif
 } MQTT_CLIENT_DATA_T;
 
 // Cria registro com os dados do cliente
 static MQTT_CLIENT_DATA_T state;
 
-#ifndef DEBUG_printf
-#ifndef NDEBUG
-#define DEBUG_printf printf
-#else
-#define DEBUG_printf(...)
+// Intervalo entre as drenagens do log adiado (lib/log.h) e registros escritos por drenagem; com mais
+// registros pendentes a próxima drenagem vem logo em seguida
+#ifndef LOG_DRENAGEM_MS
+#define LOG_DRENAGEM_MS 50
 #endif
+#define LOG_DRENAGEM_POR_RODADA 16
+
+// Temporização da coleta de saúde - how often to measure our health
+#ifndef HEALTH_WORKER_TIME_S
+#define HEALTH_WORKER_TIME_S 5
 #endif
 
-#ifndef INFO_printf
-#define INFO_printf printf
+// Intervalo de avaliação do alarme; os tempos mínimos de disparo e liberação ficam em alarme.h
+#ifndef ALARM_WORKER_TIME_MS
+#define ALARM_WORKER_TIME_MS 250
 #endif
 
-#ifndef ERROR_printf
-#define ERROR_printf printf
+// Nova tentativa da primeira avaliação enquanto a aquisição ainda não entregou um bloco
+#define ALARME_PRIMEIRA_LEITURA_MS 5
+
+// Intervalo de atualização do display; uma mudança do alarme atualiza o display na hora
+#ifndef DISPLAY_WORKER_TIME_MS
+#define DISPLAY_WORKER_TIME_MS 500
 #endif
 
-// Temporização da coleta de saúde - how often to measure our health
-#define HEALTH_WORKER_TIME_S 5
+// Intensidade de cada cor na matriz de LEDs, de 0 a 255, atualizada junto com o display
+#ifndef MATRIZ_BRILHO
+#define MATRIZ_BRILHO 16
+#endif
+
+// Intervalo entre os relatórios das tarefas (execuções e piores tempos) no stdio; 0 desativa
+#ifndef RELATORIO_TAREFAS_S
+#define RELATORIO_TAREFAS_S 60
+#endif
+
+// Intervalo entre os instantâneos das métricas em /metrics; 0 desativa
+#ifndef METRICAS_S
+#define METRICAS_S 30
+#endif
 
 // Manter o programa ativo - keep alive in seconds
 #define MQTT_KEEP_ALIVE_S 60
@@ -95,43 +154,230 @@ static MQTT_CLIENT_DATA_T state;
 #define MQTT_UNIQUE_TOPIC 0
 #endif
 
+// Níveis opcionais antes do nome do cliente, para frotas grandes; os vazios são omitidos. Ex.: com
+// MQTT_TOPIC_SITE "hc", MQTT_TOPIC_WARD "uti2", MQTT_TOPIC_BED "07" e MQTT_UNIQUE_TOPIC, o alarme é
+// publicado em /hc/uti2/07/pico1234/alarme e os comandos são esperados em /hc/uti2/07/pico1234/comando/...
+#ifndef MQTT_TOPIC_SITE
+#define MQTT_TOPIC_SITE ""
+#endif
+#ifndef MQTT_TOPIC_WARD
+#define MQTT_TOPIC_WARD ""
+#endif
+#ifndef MQTT_TOPIC_BED
+#define MQTT_TOPIC_BED ""
+#endif
+
+// Espaço para todos os tópicos, com o prefixo e o terminador de cada um
+#ifndef MQTT_TOPICS_BYTES
+#define MQTT_TOPICS_BYTES 768
+#endif
+
+// Definir como 1 para publicar temperatura, batimento e alarme em uma única mensagem binária no tópico
+// /telemetria (formato em lib/telemetria.h), em vez das publicações separadas em texto
+#ifndef MQTT_COMBINED_TELEMETRY
+#define MQTT_COMBINED_TELEMETRY 0
+#endif
+
+// Telemetria combinada em lotes: as amostras são coletadas ao longo do intervalo e publicadas juntas, com resumo.
+// Amostras por mensagem e intervalo entre publicações são ajustáveis pelo tópico /comando/lote.
+#define LOTE_TAMANHO_PADRAO 10
+#define LOTE_INTERVALO_PADRAO_MS (HEALTH_WORKER_TIME_S * 1000)
+#define LOTE_PERIODO_MINIMO_MS 20     // Menor intervalo entre amostras
+#define LOTE_INTERVALO_MAXIMO_MS 3600000
+
+// Reenvio da fila de telemetria: publicações por rodada, intervalo entre rodadas e publicações aguardando
+// PUBACK, deixando vagas de MQTT_REQ_MAX_IN_FLIGHT para o alarme e as assinaturas
+#define FILA_REENVIO_POR_RODADA 2
+#define FILA_REENVIO_INTERVALO_MS 100
+#define FILA_EM_VOO_MAX 2
+
 /* References for this implementation:
  * raspberry-pi-pico-c-sdk.pdf, Section '4.1.1. hardware_adc'
  * pico-examples/adc/adc_console/adc_console.c */
 
 
+// Tópicos publicados e assinados, montados na partida com o prefixo do dispositivo (lib/topicos.h)
+typedef enum {
+    TOPICO_ONLINE,
+    TOPICO_ALARME,
+    TOPICO_TEMPERATURA,
+    TOPICO_BATIMENTO,
+    TOPICO_TELEMETRIA,
+    TOPICO_UPTIME,
+    TOPICO_METRICAS,
+    TOPICO_LATENCIA,
+    TOPICO_BOOT,
+    TOPICO_COMANDOS,
+    TOPICO_EXIT,
+    TOPICO_PING,
+    TOPICO_PRINT,
+    TOPICOS
+} topico_id_t;
+static const char *const nomes_topicos[TOPICOS] = {
+    [TOPICO_ONLINE] = MQTT_WILL_TOPIC,
+    [TOPICO_ALARME] = "/alarme",
+    [TOPICO_TEMPERATURA] = "/temperatura",
+    [TOPICO_BATIMENTO] = "/batimento",
+    [TOPICO_TELEMETRIA] = "/telemetria",
+    [TOPICO_UPTIME] = "/uptime",
+    [TOPICO_METRICAS] = "/metrics",
+    [TOPICO_LATENCIA] = "/diagnostico/latencia",
+    [TOPICO_BOOT] = "/diagnostico/boot",
+    [TOPICO_COMANDOS] = "/comando/#",
+    [TOPICO_EXIT] = "/exit",
+    [TOPICO_PING] = "/ping",
+    [TOPICO_PRINT] = "/print",
+};
+static const char *topicos[TOPICOS];
+static char armazenamento_topicos[MQTT_TOPICS_BYTES];
+
 // Requisição para publicar
 static void pub_request_cb(__unused void *arg, err_t err);
 
-// Topico MQTT
-static const char *full_topic(MQTT_CLIENT_DATA_T *state, const char *name);
+// Publica e registra o resultado nas métricas; todas as publicações passam por aqui
+static err_t publica(MQTT_CLIENT_DATA_T *state, topico_id_t topico, const void *dados, size_t len, u8_t qos,
+                     u8_t retain, mqtt_request_cb_t cb, void *arg);
 
 // Controle do LED
 static void control_led(bool on);
 
 // Leitura de temperatura do sensor
-static float read_temperatura();
+static float read_temperatura(const sinais_leitura_t *leitura);
 
 // Leitura de batimento cardíaco do sensor
-static int read_batimento();
+static int read_batimento(const sinais_leitura_t *leitura);
+
+// Estado do alarme e barras dos sinais na matriz de LEDs
+static void mostra_matriz(const sinais_leitura_t *leitura);
 
 // Publicar temperatura
 static void publish_health(MQTT_CLIENT_DATA_T *state);
 
-// Verifica se há uma condição de alarme
-static bool verifica_condicao_alarme(float temperatura, int batimento);
+#if MQTT_COMBINED_TELEMETRY
+// Amostras aguardando publicação e parâmetros do lote
+static lote_t lote;
+static uint8_t lote_tamanho = LOTE_TAMANHO_PADRAO;
 
-// Gerencia o alarme médico e manual
-static bool gerenciar_alarme(float temperatura, int batimento);
+// Publicar as amostras acumuladas em mensagens de telemetria
+static void publish_telemetria(MQTT_CLIENT_DATA_T *state);
 
-// Requisição de Assinatura - subscribe
-static void sub_request_cb(void *arg, err_t err);
+// Coleta periódica das amostras do lote
+static void coleta_amostra(void);
+static void amostra_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_amostra =
+    AGENDADOR_TAREFA("amostra", amostra_worker_fn, LOTE_INTERVALO_PADRAO_MS / LOTE_TAMANHO_PADRAO);
+
+// Mensagens de telemetria aguardando confirmação do broker, inclusive enquanto desconectado
+static fila_envio_t fila;
+static uint8_t fila_em_voo;     // Publicações da fila aguardando PUBACK
+static uint8_t fila_geracao;    // Muda a cada reenvio; confirmações de gerações anteriores são ignoradas
+
+// Envio das mensagens da fila, com limite por rodada; executada sob demanda
+static void envio_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_envio = AGENDADOR_TAREFA("envio", envio_worker_fn, 0);
 
-// Requisição para encerrar a assinatura
+// Confirmação das publicações da fila
+static void telemetria_request_cb(void *arg, err_t err);
+#endif
+
+#if !MQTT_COMBINED_TELEMETRY
+// Formata centésimos com duas casas decimais
+static int formata_centesimos(char *destino, size_t tamanho, int32_t centesimos);
+#endif
+
+// Aciona buzzer e LED e avisa o núcleo 0, apenas nas mudanças do alarme. origem_us é o instante da
+// amostra avaliada ou da interrupção do botão e avaliacao_us o início do tratamento, para as latências.
+static void gerenciar_alarme(alarme_evento_t evento, uint32_t origem_us, uint32_t avaliacao_us);
+
+// Publica o estado do alarme; aviso é a mudança vinda do núcleo 1 (NULL para o estado na reconexão)
+static err_t publish_alarme(MQTT_CLIENT_DATA_T *state, bool ativo, const evento_t *aviso);
+
+// Latências de cada etapa entre a origem de uma mudança do alarme e a confirmação do broker, em us.
+// As duas primeiras etapas e a origem-acionamento são registradas pelo núcleo 1, as demais pelo núcleo 0.
+// O tempo mínimo de disparo do alarme (alarme.h) é proposital e não entra na medição.
+typedef enum {
+    ETAPA_AMOSTRA_AVALIACAO = 0,    // Bloco do ADC (ou interrupção do botão) até a avaliação
+    ETAPA_AVALIACAO_ACIONAMENTO,    // Avaliação até buzzer e LED acionados
+    ETAPA_ACIONAMENTO_PUBLICACAO,   // Acionamento até a publicação em /alarme (troca de núcleo incluída)
+    ETAPA_PUBLICACAO_PUBACK,        // Publicação até o PUBACK do broker
+    ETAPA_ORIGEM_ACIONAMENTO,
+    ETAPA_ORIGEM_PUBACK,
+    ETAPAS
+} etapa_latencia_t;
+static latencia_histograma_t latencias[ETAPAS];
+static const char *const nomes_etapas[ETAPAS] = {
+    "amostra-avaliacao", "avaliacao-acionamento", "acionamento-publicacao",
+    "publicacao-puback", "origem-acionamento", "origem-puback",
+};
+
+// Publicações do alarme aguardando PUBACK, identificadas pelo argumento do callback (posição + 1)
+#define MEDICOES_ALARME 4
+typedef struct {
+    uint32_t origem_us;
+    uint32_t publicado_us;
+} medicao_alarme_t;
+static medicao_alarme_t medicoes_alarme[MEDICOES_ALARME];
+static uint8_t proxima_medicao;
+
+// Confirmação das publicações do alarme
+static void alarme_request_cb(void *arg, err_t err);
+
+// Mostra as latências no stdio e as publica no tópico de diagnóstico
+static void publish_latencias(MQTT_CLIENT_DATA_T *state);
+
+// Avaliação periódica do alarme médico (núcleo 1)
+static void alarm_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_alarme = AGENDADOR_TAREFA("alarme", alarm_worker_fn, ALARM_WORKER_TIME_MS);
+
+// Atualização periódica do display (núcleo 1)
+static void display_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_display = AGENDADOR_TAREFA("display", display_worker_fn, DISPLAY_WORKER_TIME_MS);
+
+// Pedidos feitos a cada CONNACK, em ordem de prioridade. São emitidos de uma vez, sem esperar a resposta
+// dos anteriores; os recusados pelo limite de pedidos pendentes do lwIP (MQTT_REQ_MAX_IN_FLIGHT) ficam
+// para a próxima rodada de tarefa_pedidos. Os comandos chegam por um único filtro com curinga, e os
+// tópicos de controle, usados só para diagnóstico e para o /exit, vêm depois da primeira telemetria.
+typedef enum {
+    PEDIDO_ASSINA_COMANDOS,     // "<prefixo>/comando/#": faixas do alarme e lote
+    PEDIDO_ONLINE,              // Marcador retido em MQTT_WILL_TOPIC
+    PEDIDO_ALARME,              // Estado atual do alarme, publicado de outra forma só nas mudanças
+    PEDIDO_TELEMETRIA,          // Primeira telemetria, sem esperar o período de tarefa_publicacao
+    PEDIDO_ASSINA_EXIT,
+    PEDIDO_ASSINA_PING,
+    PEDIDO_ASSINA_PRINT,
+    PEDIDO_RELATORIO_BOOT,      // /diagnostico/boot, uma única vez, depois da primeira telemetria
+    PEDIDOS_CONEXAO
+} pedido_conexao_t;
+static const topico_id_t filtros_assinatura[PEDIDOS_CONEXAO] = {
+    [PEDIDO_ASSINA_COMANDOS] = TOPICO_COMANDOS,
+    [PEDIDO_ASSINA_EXIT] = TOPICO_EXIT,
+    [PEDIDO_ASSINA_PING] = TOPICO_PING,
+    [PEDIDO_ASSINA_PRINT] = TOPICO_PRINT,
+};
+#define PEDIDO_BIT(pedido) (1u << (pedido))
+#define PEDIDOS_TODOS (PEDIDO_BIT(PEDIDOS_CONEXAO) - 1)
+
+// Nova tentativa de um pedido recusado por falta de vaga (a resposta de um pedido anterior a libera) e
+// de uma assinatura que falhou no broker
+#define PEDIDOS_REPETICAO_MS 10
+#define PEDIDOS_FALHA_MS 1000
+
+// Emissão dos pedidos pendentes; executada sob demanda
+static void pedidos_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_pedidos = AGENDADOR_TAREFA("pedidos", pedidos_worker_fn, 0);
+
+// Faz um pedido; ERR_MEM o deixa pendente
+static err_t faz_pedido(MQTT_CLIENT_DATA_T *state, pedido_conexao_t pedido);
+
+// Volta um pedido para a fila, com nova tentativa após atraso_ms
+static void repete_pedido(MQTT_CLIENT_DATA_T *state, pedido_conexao_t pedido, uint32_t atraso_ms);
+
+// Respostas de SUBSCRIBE e UNSUBSCRIBE; o argumento é o pedido_conexao_t da assinatura
+static void sub_request_cb(void *arg, err_t err);
 static void unsub_request_cb(void *arg, err_t err);
 
-// Tópicos de assinatura
-static void sub_unsub_topics(MQTT_CLIENT_DATA_T* state, bool sub);
+// Primeira telemetria aceita desde o CONNACK: mede o intervalo e marca a fase da partida
+static void telemetria_publicada(MQTT_CLIENT_DATA_T *state);
 
 // Dados de entrada MQTT
 static void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags);
@@ -139,9 +385,42 @@ static void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t f
 // Dados de entrada publicados
 static void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len);
 
+// Comandos recebidos, resolvidos pelo tópico no início de cada publicação (lib/comandos.h); o contexto
+// dos tratadores é o MQTT_CLIENT_DATA_T
+static void comando_temperatura(void *contexto, const char *dados, size_t len);
+static void comando_batimento(void *contexto, const char *dados, size_t len);
+#if MQTT_COMBINED_TELEMETRY
+static void comando_lote(void *contexto, const char *dados, size_t len);
+#endif
+static void comando_print(void *contexto, const char *dados, size_t len);
+static void comando_ping(void *contexto, const char *dados, size_t len);
+static void comando_exit(void *contexto, const char *dados, size_t len);
+static const comando_t tabela_comandos[] = {
+    COMANDO("/comando/temperatura", comando_temperatura),
+    COMANDO("/comando/batimento", comando_batimento),
+#if MQTT_COMBINED_TELEMETRY
+    COMANDO("/comando/lote", comando_lote),
+#endif
+    COMANDO("/print", comando_print),
+    COMANDO("/ping", comando_ping),
+    COMANDO("/exit", comando_exit),
+};
+
 // Publicar saúde
-static void health_worker_fn(async_context_t *context, async_at_time_worker_t *worker);
-static async_at_time_worker_t health_worker = { .do_work = health_worker_fn };
+static void health_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_publicacao = AGENDADOR_TAREFA("publicacao", health_worker_fn, HEALTH_WORKER_TIME_S * 1000);
+
+// Relatório periódico das tarefas dos dois núcleos e das latências do alarme
+static void relatorio_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_relatorio = AGENDADOR_TAREFA("relatorio", relatorio_worker_fn, RELATORIO_TAREFAS_S * 1000);
+
+// Instantâneo periódico das métricas (lib/metricas.h)
+static void metricas_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_metricas = AGENDADOR_TAREFA("metricas", metricas_worker_fn, METRICAS_S * 1000);
+
+// Escrita dos registros do log adiado no stdio, fora dos caminhos do alarme e da publicação
+static void log_worker_fn(agendador_tarefa_t *tarefa);
+static agendador_tarefa_t tarefa_log = AGENDADOR_TAREFA("log", log_worker_fn, LOG_DRENAGEM_MS);
 
 // Conexão MQTT
 static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status);
@@ -149,26 +428,89 @@ static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection
 // Inicializar o cliente MQTT
 static void start_client(MQTT_CLIENT_DATA_T *state);
 
-// Call back com o resultado do DNS
-static void dns_found(const char *hostname, const ip_addr_t *ipaddr, void *arg);
+// Conectar ao broker
+static bool connect_client(MQTT_CLIENT_DATA_T *state);
+
+// Limpeza após a perda da conexão ao broker
+static void broker_desconectado(MQTT_CLIENT_DATA_T *state);
+
+// Operações do gerenciador de conexão (lib/conexao.h)
+static bool conectar_broker(const ip_addr_t *endereco);
+static void desconectar_broker(void);
 
 // Interrupção do botão A
 static void alarme_manual_handler(uint gpio, uint32_t events);
 
+// Núcleo 1: aquisição, sinais, alarme, botão e display, com async context próprio. O núcleo 0 fica com
+// o cyw43, o lwIP e o TLS, de modo que handshakes e retransmissões não atrasam o alarme.
+#define NUCLEO1_PRONTO 0x4E314F4B
+static async_context_poll_t contexto_nucleo1;
+static void core1_main(void);
+
+// Eventos das interrupções (no núcleo 1) e comandos do núcleo 0, tratados pelo núcleo 1
+#define BOTAO_DEBOUNCE_US 200000
+static fila_eventos_t eventos;
+static fila_eventos_t para_nucleo1;
+static void eventos_worker_fn(async_context_t *context, async_when_pending_worker_t *worker);
+static async_when_pending_worker_t eventos_worker = { .do_work = eventos_worker_fn };
+
+// Envia uma nova faixa do alarme ao núcleo 1; retorna false com a fila cheia
+static bool envia_nucleo1(evento_tipo_t tipo, int32_t minimo, int32_t maximo);
+
+// Mudanças do alarme vindas do núcleo 1, publicadas pelo núcleo 0
+static fila_eventos_t para_nucleo0;
+static void avisos_worker_fn(async_context_t *context, async_when_pending_worker_t *worker);
+static async_when_pending_worker_t avisos_worker = { .do_work = avisos_worker_fn };
+static volatile bool avisos_prontos; // O núcleo 0 já atende avisos_worker; antes disso os avisos esperam na fila
+
+// Fases da partida, em microssegundos desde o boot. O núcleo 1 começa antes do cyw43, então o alarme
+// local fica ativo sem esperar o firmware do Wi-Fi nem a rede; cada fase é marcada uma única vez, pelo
+// núcleo que a conclui, e a primeira publicação de telemetria fecha o relatório em /diagnostico/boot,
+// publicado como o último dos pedidos da conexão
+typedef enum {
+    FASE_NUCLEO1,       // Aquisição, botão, LEDs e alarme configurados
+    FASE_AVALIACAO,     // Primeira avaliação do alarme com uma leitura do ADC
+    FASE_DISPLAY,       // Display inicializado
+    FASE_CYW43,         // cyw43 e lwIP inicializados
+    FASE_REDE,          // Wi-Fi associado e endereço do broker resolvido
+    FASE_BROKER,        // Primeiro CONNACK
+    FASE_PUBLICACAO,    // Primeira publicação de telemetria
+    FASES_BOOT
+} fase_boot_t;
+static volatile uint32_t fases_boot_us[FASES_BOOT];
+static const char *const nomes_fases_boot[FASES_BOOT] = {
+    "nucleo1", "avaliacao", "display", "cyw43", "rede", "broker", "publicacao",
+};
+static void marca_fase(fase_boot_t fase);
+static err_t publish_relatorio_boot(MQTT_CLIENT_DATA_T *state);
+
 
 int main(void) {
 
     // Inicializa todos os tipos de bibliotecas stdio padrão presentes que estão ligados ao binário.
     stdio_init_all();
-    INFO_printf("mqtt client starting\n");
+    LOG(CLIENTE_INICIANDO);
 
-    // Inicializa o conversor ADC
-    adc_init();
+    // Filas entre os núcleos, prontas antes de o núcleo 1 começar
+    eventos_init(&eventos);
+    eventos_init(&para_nucleo1);
+    eventos_init(&para_nucleo0);
+
+    // Aquisição, alarme e display no núcleo 1, iniciados antes do cyw43, cuja inicialização carrega o
+    // firmware do Wi-Fi; o alarme local não depende de nada do núcleo 0
+    multicore_launch_core1(core1_main);
 
     // Inicializa a arquitetura do cyw43
     if (cyw43_arch_init()) {
         panic("Failed to inizialize CYW43");
     }
+    marca_fase(FASE_CYW43);
+    async_context_add_when_pending_worker(cyw43_arch_async_context(), &avisos_worker);
+
+    // O contexto do núcleo 1 precisa estar pronto para receber comandos
+    if (multicore_fifo_pop_blocking() != NUCLEO1_PRONTO) {
+        panic("Core 1 failed to start");
+    }
 
     // Usa identificador único da placa
     char unique_id_buf[5];
@@ -182,9 +524,19 @@ int main(void) {
     memcpy(&client_id_buf[0], MQTT_DEVICE_NAME, sizeof(MQTT_DEVICE_NAME) - 1);
     memcpy(&client_id_buf[sizeof(MQTT_DEVICE_NAME) - 1], unique_id_buf, sizeof(unique_id_buf) - 1);
     client_id_buf[sizeof(client_id_buf) - 1] = 0;
-    INFO_printf("Device name %s\n", client_id_buf);
+    LOG(NOME_DISPOSITIVO, client_id_buf);
 
     state.mqtt_client_info.client_id = client_id_buf;
+
+    // Todos os tópicos são montados aqui, uma única vez, com o prefixo "/site/ala/leito/cliente"
+    static char prefixo_topicos[MQTT_TOPIC_LEN];
+    const char *const niveis[] = { MQTT_TOPIC_SITE, MQTT_TOPIC_WARD, MQTT_TOPIC_BED, MQTT_UNIQUE_TOPIC ? client_id_buf : NULL };
+    if (topicos_prefixo(prefixo_topicos, sizeof(prefixo_topicos), niveis, sizeof(niveis) / sizeof(niveis[0])) < 0 ||
+        !topicos_monta(topicos, nomes_topicos, TOPICOS, prefixo_topicos, armazenamento_topicos, sizeof(armazenamento_topicos))) {
+        panic("Invalid MQTT topic prefix or MQTT_TOPICS_BYTES too small");
+    }
+    comandos_init(&state.comandos, tabela_comandos, sizeof(tabela_comandos) / sizeof(tabela_comandos[0]),
+                  prefixo_topicos, &state);
     state.mqtt_client_info.keep_alive = MQTT_KEEP_ALIVE_S; // Keep alive in sec
 #if defined(MQTT_USERNAME) && defined(MQTT_PASSWORD)
     state.mqtt_client_info.client_user = MQTT_USERNAME;
@@ -193,9 +545,7 @@ int main(void) {
     state.mqtt_client_info.client_user = NULL;
     state.mqtt_client_info.client_pass = NULL;
 #endif
-    static char will_topic[MQTT_TOPIC_LEN];
-    strncpy(will_topic, full_topic(&state, MQTT_WILL_TOPIC), sizeof(will_topic));
-    state.mqtt_client_info.will_topic = will_topic;
+    state.mqtt_client_info.will_topic = topicos[TOPICO_ONLINE];
     state.mqtt_client_info.will_msg = MQTT_WILL_MSG;
     state.mqtt_client_info.will_qos = MQTT_WILL_QOS;
     state.mqtt_client_info.will_retain = true;
@@ -209,151 +559,453 @@ int main(void) {
     state.mqtt_client_info.tls_config = altcp_tls_create_config_client_2wayauth(ca_cert, sizeof(ca_cert),
             client_key, sizeof(client_key), NULL, 0, client_cert, sizeof(client_cert));
 #if ALTCP_MBEDTLS_AUTHMODE != MBEDTLS_SSL_VERIFY_REQUIRED
-    WARN_printf("Warning: tls without verification is insecure\n");
+    LOG(TLS_SEM_VERIFICACAO);
 #endif
 #else
     state->client_info.tls_config = altcp_tls_create_config_client(NULL, 0);
-    WARN_printf("Warning: tls without a certificate is insecure\n");
+    LOG(TLS_SEM_CERTIFICADO);
 #endif
 #endif
 
-    // Conectar à rede WiFI - fazer um loop até que esteja conectado
+    // Wi-Fi, DNS e broker são conectados em segundo plano, com novas tentativas após qualquer falha
+    start_client(&state);
     cyw43_arch_enable_sta_mode();
-    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 30000)) {
-        panic("Failed to connect");
+    static const conexao_config_t config_conexao = {
+        .ssid = WIFI_SSID,
+        .senha = WIFI_PASSWORD,
+        .autenticacao = CYW43_AUTH_WPA2_AES_PSK,
+        .servidor = MQTT_SERVER,
+        .conectar_broker = conectar_broker,
+        .desconectar_broker = desconectar_broker,
+    };
+    cyw43_arch_lwip_begin();
+    conexao_inicia(&config_conexao);
+    cyw43_arch_lwip_end();
+
+    // Tarefas do núcleo 0, executadas no cyw43 async context junto com o lwIP
+    async_context_t *context = cyw43_arch_async_context();
+    cyw43_arch_lwip_begin();
+#if MQTT_COMBINED_TELEMETRY
+    // Coleta e enfileiramento das amostras, também independentes da conexão
+    lote_init(&lote);
+    fila_envio_init(&fila);
+    tarefa_envio.dados = &state;
+    agendador_inicia(&tarefa_amostra, context, 0);
+    agendador_inicia(&tarefa_envio, context, 0);
+#endif
+    tarefa_publicacao.dados = &state;
+    agendador_inicia(&tarefa_publicacao, context, HEALTH_WORKER_TIME_S * 1000);
+    tarefa_pedidos.dados = &state;
+    agendador_inicia(&tarefa_pedidos, context, 0);
+    if (RELATORIO_TAREFAS_S) {
+        agendador_inicia(&tarefa_relatorio, context, RELATORIO_TAREFAS_S * 1000);
+    }
+    if (METRICAS_S) {
+        agendador_inicia(&tarefa_metricas, context, METRICAS_S * 1000);
+    }
+    if (LOG_ADIADO) {
+        agendador_inicia(&tarefa_log, context, 0);
+    }
+    cyw43_arch_lwip_end();
+
+    // Com as tarefas prontas, atende os avisos do alarme, inclusive os que chegaram durante a partida
+    avisos_prontos = true;
+    __dmb();
+    async_context_set_work_pending(context, &avisos_worker);
+
+    // Todo o trabalho é feito pelas tarefas e callbacks em segundo plano; o laço só aguarda o comando /exit
+    // encerrar a conexão mqtt, verificando a condição a cada interrupção. O núcleo 1 segue monitorando.
+    // stop_client é escrito pelo callback do comando; a barreira obriga a relê-lo a cada volta.
+    while (!state.stop_client || mqtt_client_is_connected(state.mqtt_client_inst)) {
+        __wfe();
+        __compiler_memory_barrier();
     }
-    INFO_printf("\nConnected to Wifi\n");
 
-    //Faz um pedido de DNS para o endereço IP do servidor MQTT
+    LOG(CLIENTE_ENCERRANDO);
     cyw43_arch_lwip_begin();
-    int err = dns_gethostbyname(MQTT_SERVER, &state.mqtt_server_address, dns_found, &state);
+    log_drena(UINT32_MAX);
     cyw43_arch_lwip_end();
+    return 0;
+}
 
-    // Se tiver o endereço, inicia o cliente
-    if (err == ERR_OK) {
-        start_client(&state);
-    } else if (err != ERR_INPROGRESS) { // ERR_INPROGRESS means expect a callback
-        panic("dns request failed");
+// Núcleo 1. As interrupções do DMA do ADC e do botão são habilitadas aqui e por isso atendidas neste núcleo.
+static void core1_main(void) {
+    // Permite que o núcleo 0 grave a flash (extensão da fila de envio) com este núcleo em espera
+    flash_safe_execute_core_init();
+
+    if (!async_context_poll_init_with_defaults(&contexto_nucleo1)) {
+        panic("Failed to create core 1 context");
+    }
+    async_context_t *context = &contexto_nucleo1.core;
+
+    // Filtros dos sinais vitais, alimentados a cada bloco decimado do ADC
+    sinais_config_t config_sinais;
+    sinais_config_padrao(&config_sinais);
+    sinais_init(&config_sinais);
+    aquisicao_set_callback(sinais_processa);
+
+    // Inicializa a aquisição contínua do ADC (round-robin + DMA)
+    if (!aquisicao_init(AQ_TAXA_PADRAO_HZ)) {
+        panic("Failed to start ADC acquisition");
     }
 
     // Inicializa o botão A como botão de alarme manual, atraves de interrupção
+    async_context_add_when_pending_worker(context, &eventos_worker);
     gpio_init(BOTAO_A);
     gpio_set_dir(BOTAO_A, GPIO_IN);
     gpio_pull_up(BOTAO_A); // Configura o botão A com pull-up interno
     gpio_set_irq_enabled_with_callback(BOTAO_A, GPIO_IRQ_EDGE_FALL, true, &alarme_manual_handler);
 
-
     // Configura o led vermelho e o verde
     gpio_init(LED_PIN_RED);
     gpio_set_dir(LED_PIN_RED, GPIO_OUT);
     gpio_init(LED_PIN_GREEN);
     gpio_set_dir(LED_PIN_GREEN, GPIO_OUT);
 
-    // Inicializa o display
-    init_ssd();
+    // Avaliação do alarme, independente da conexão MQTT
+    alarme_init(&alarme, TEMP_MIN_C100, TEMP_MAX_C100, BPM_MIN, BPM_MAX);
+    control_led(false);
+    agendador_inicia(&tarefa_alarme, context, 0);
 
-    // Loop condicionado a conexão mqtt
-    while (!state.connect_done || mqtt_client_is_connected(state.mqtt_client_inst)) {
-        display_info(read_temperatura(), read_batimento()); // Exibe informações no display
-        cyw43_arch_poll();
-        cyw43_arch_wait_for_work_until(make_timeout_time_ms(10000));
-    }
+    // O display, que envia o primeiro quadro de forma bloqueante, é inicializado na primeira execução
+    // da sua tarefa, disparada pela primeira avaliação do alarme (ou no primeiro período, sem leituras)
+    agendador_inicia(&tarefa_display, context, DISPLAY_WORKER_TIME_MS);
 
-    INFO_printf("mqtt client exiting\n");
-    return 0;
+    marca_fase(FASE_NUCLEO1);
+    multicore_fifo_push_blocking(NUCLEO1_PRONTO);
+    while (true) {
+        async_context_poll(context);
+        async_context_wait_for_work_until(context, at_the_end_of_time);
+    }
 }
 
-// Interrupção do botão A
+// Interrupção do botão A: apenas registra a borda; o tratamento é feito por eventos_worker_fn
 static void alarme_manual_handler(uint gpio, uint32_t events) {
     if (gpio == BOTAO_A) {
-        static uint32_t last_press_time = 0;
-        uint32_t current_time = to_ms_since_boot(get_absolute_time());
-        if (current_time - last_press_time > 200) { // Debounce em 200ms
-            alarme_manual = !alarme_manual; // Alterna o estado do alarme manual
-            INFO_printf("Alarme manual %s\n", alarme_manual ? "ativado" : "desativado");
-            
-            // Publica tópico imediatamente
-            const char *alarme_key = full_topic(&state, "/alarme");
-            const char *alarme_msg = alarme_manual ? "1" : "0";
-
-            if (alarme_manual) {
-                control_led(true); // Liga o LED se o alarme manual estiver ativado
-                iniciar_buzzer(BUZZER_A); // Inicia o buzzer
-                INFO_printf("Publishing alarm status %s to %s\n", alarme_msg, alarme_key);
-                mqtt_publish(state.mqtt_client_inst, alarme_key, alarme_msg, strlen(alarme_msg), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, &state);
-            } else if (!alarme_medico) {
-                control_led(false); // Desliga o LED se o alarme manual estiver desativado
-                parar_buzzer(BUZZER_A); // Para o buzzer
-                INFO_printf("Publishing alarm status %s to %s\n", alarme_msg, alarme_key);
-                mqtt_publish(state.mqtt_client_inst, alarme_key, alarme_msg, strlen(alarme_msg), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, &state);
-            }
+        evento_t evento = { .instante_us = time_us_32(), .tipo = EVENTO_BOTAO, .dado = (uint16_t)gpio };
+        metricas.interrupcoes_botao++;
+        if (!eventos_publica(&eventos, &evento)) {
+            metricas.eventos_descartados++;
         }
-        last_press_time = current_time;
+        async_context_set_work_pending(&contexto_nucleo1.core, &eventos_worker);
     }
 }
 
-// Leitura de temperatura do sensor
-static float read_temperatura() {
-    adc_select_input(1); // SSeleciona o sensor de temperatura
-    uint16_t vrx_value = adc_read(); // Lê o valor do eixo x (Temperatura)
-    return ((vrx_value - 16) / max_value_joy) * 20 + 26; // Converte o valor do eixo x para a faixa de 26 a 46
+// Trata, no núcleo 1, as bordas do botão e as faixas do alarme recebidas pelo núcleo 0
+static void eventos_worker_fn(async_context_t *context, async_when_pending_worker_t *worker) {
+    static uint32_t ultima_borda_us = 0;
+    static bool primeira_borda = true;
+
+    evento_t evento;
+    while (eventos_consome(&eventos, &evento)) {
+        if (evento.tipo != EVENTO_BOTAO) {
+            continue;
+        }
+        // Debounce: só vale a borda após 200 ms sem nenhuma outra, medido pelo instante da interrupção
+        bool valida = primeira_borda || evento.instante_us - ultima_borda_us > BOTAO_DEBOUNCE_US;
+        ultima_borda_us = evento.instante_us;
+        primeira_borda = false;
+        if (valida) {
+            bool manual = !alarme.manual; // Alterna o estado do alarme manual
+            LOG(ALARME_MANUAL, manual ? "ativado" : "desativado");
+            gerenciar_alarme(alarme_set_manual(&alarme, manual), evento.instante_us, time_us_32());
+        }
+    }
+
+    while (eventos_consome(&para_nucleo1, &evento)) {
+        if (evento.tipo == EVENTO_FAIXA_TEMPERATURA) {
+            alarme_set_faixa_temperatura(&alarme, evento.valor[0], evento.valor[1]);
+        } else if (evento.tipo == EVENTO_FAIXA_BATIMENTO) {
+            alarme_set_faixa_batimento(&alarme, evento.valor[0], evento.valor[1]);
+        }
+    }
 }
 
-// Leitura de batimento cardíaco do sensor
-static int read_batimento() {
-    adc_select_input(0); // Seleciona o sensor de batimento
-    uint16_t vry_value = adc_read(); // Lê o valor do eixo y (Batimento)
-    return ((vry_value - 16) / max_value_joy) * 80 + 40; // Ajusta o valor do eixo y para a faixa de 40 a 120
+static bool envia_nucleo1(evento_tipo_t tipo, int32_t minimo, int32_t maximo) {
+    evento_t evento = { .instante_us = time_us_32(), .tipo = (uint16_t)tipo, .valor = { minimo, maximo } };
+    if (!eventos_publica(&para_nucleo1, &evento)) {
+        return false;
+    }
+    async_context_set_work_pending(&contexto_nucleo1.core, &eventos_worker);
+    return true;
+}
+
+// Publica, no núcleo 0, as mudanças do alarme na ordem em que o núcleo 1 as sinalizou, antecipando
+// a publicação dos sinais para que a mudança chegue acompanhada das leituras atuais
+static void avisos_worker_fn(async_context_t *context, async_when_pending_worker_t *worker) {
+    bool mudou = false;
+    evento_t evento;
+    while (eventos_consome(&para_nucleo0, &evento)) {
+        if (evento.tipo == EVENTO_ALARME) {
+            // Recusada ou sem conexão: o pedido de conexão publica o estado atual até o PUBACK chegar
+            if (publish_alarme(&state, (evento.dado & TELEMETRIA_ALARME_ATIVO) != 0, &evento) != ERR_OK) {
+                repete_pedido(&state, PEDIDO_ALARME, PEDIDOS_REPETICAO_MS);
+            }
+            mudou = true;
+        }
+    }
+    // Esvaziada a fila, uma mudança que não coube nela sai com o estado atual, já escrito pelo núcleo 1
+    if (aviso_alarme_perdido) {
+        aviso_alarme_perdido = false;
+        repete_pedido(&state, PEDIDO_ALARME, 0);
+        mudou = true;
+    }
+    if (mudou) {
+#if MQTT_COMBINED_TELEMETRY
+        coleta_amostra();
+#endif
+        agendador_dispara(&tarefa_publicacao);
+    }
+}
+
+// Leitura de temperatura do sensor, já filtrada e convertida em ponto fixo (faixa de 26 a 46)
+static float read_temperatura(const sinais_leitura_t *leitura) {
+    return leitura->temperatura_c100 / 100.0f;
 }
 
-// Verifica se há uma condição de alarme
-static bool verifica_condicao_alarme(float temperatura, int batimento) {
-    // Exemplo de condição de alarme: temperatura acima de 37.5 ou batimento fora da faixa de 60 a 100
-    return (temperatura > temp_max || temperatura < temp_min ||
-            batimento < bpm_min || batimento > bpm_max);
+// Leitura de batimento cardíaco do sensor, já filtrada (faixa de 40 a 120 no joystick)
+static int read_batimento(const sinais_leitura_t *leitura) {
+    return leitura->batimento_bpm;
 }
 
-// Gerencia o alarme médico e manual
-static bool gerenciar_alarme(float temperatura, int batimento){
+// Aciona buzzer e LED e avisa o núcleo 0, apenas nas mudanças do alarme
+static void gerenciar_alarme(alarme_evento_t evento, uint32_t origem_us, uint32_t avaliacao_us) {
+    // Os bits médico e manual podem mudar sem mudar o estado combinado
+    uint32_t bits = 0;
+    if (alarme_ativo(&alarme)) bits |= TELEMETRIA_ALARME_ATIVO;
+    if (alarme.medico) bits |= TELEMETRIA_ALARME_MEDICO;
+    if (alarme.manual) bits |= TELEMETRIA_ALARME_MANUAL;
+    estado_alarme = bits;
+
+    if (evento == ALARME_SEM_MUDANCA) {
+        return;
+    }
 
-    if (verifica_condicao_alarme(temperatura, batimento)) {
-        alarme_medico = true; // Ativa o alarme médico
-        INFO_printf("Alarme médico ativado!\n");
+    bool ativo = (evento == ALARME_ATIVADO);
+    if (ativo) {
+        LOG(ALARME_ATIVADO, alarme.medico ? "médico" : "manual");
         iniciar_buzzer(BUZZER_A); // Inicia o buzzer
         control_led(true); // Liga o LED vermelho
-        return true;
-    } else{
-        alarme_medico = false; // Desativa o alarme médico
-        if (alarme_manual){
-            INFO_printf("Alarme manual ativado!\n");
-            iniciar_buzzer(BUZZER_A); // Inicia o buzzer
-            control_led(true); // Liga o LED vermelho
-            return true;
-        } else{
-            INFO_printf("Condições normalizadas.\n");
-            parar_buzzer(BUZZER_A); // Para o buzzer
-            control_led(false); // Liga o LED verde
-            return false; // Desativa o alarme
+    } else {
+        LOG(CONDICOES_NORMALIZADAS);
+        parar_buzzer(BUZZER_A); // Para o buzzer
+        control_led(false); // Liga o LED verde
+    }
+    uint32_t acionamento_us = time_us_32();
+    latencia_registra(&latencias[ETAPA_AMOSTRA_AVALIACAO], avaliacao_us - origem_us);
+    latencia_registra(&latencias[ETAPA_AVALIACAO_ACIONAMENTO], acionamento_us - avaliacao_us);
+    latencia_registra(&latencias[ETAPA_ORIGEM_ACIONAMENTO], acionamento_us - origem_us);
+
+    agendador_dispara(&tarefa_display);
+
+    // A publicação fica com o núcleo 0; o cyw43 async context aceita o pedido vindo deste núcleo
+    evento_t aviso = {
+        .instante_us = acionamento_us,
+        .tipo = EVENTO_ALARME,
+        .dado = (uint16_t)bits,
+        .valor = { (int32_t)origem_us, 0 },
+    };
+    if (!eventos_publica(&para_nucleo0, &aviso)) {
+        // Fila cheia: o núcleo 0 publica o estado atual (estado_alarme) pelo pedido de conexão
+        metricas.eventos_descartados++;
+        aviso_alarme_perdido = true;
+    }
+    if (avisos_prontos) {
+        async_context_set_work_pending(cyw43_arch_async_context(), &avisos_worker);
+    }
+}
+
+// Publica o estado do alarme, retido para que novos assinantes recebam o estado atual. O argumento do
+// PUBACK leva o estado publicado no bit 0 e a medição de latência (índice + 1, ou 0) nos demais.
+static err_t publish_alarme(MQTT_CLIENT_DATA_T *state, bool ativo, const evento_t *aviso) {
+    state->alarme_pendente = true;
+    if (!state->mqtt_client_inst || !mqtt_client_is_connected(state->mqtt_client_inst)) {
+        return ERR_CONN;
+    }
+    const char *alarme_msg = ativo ? "1" : "0";
+
+    uintptr_t medicao = 0;
+    if (aviso) {
+        uint8_t i = proxima_medicao;
+        proxima_medicao = (proxima_medicao + 1) % MEDICOES_ALARME;
+        medicoes_alarme[i].origem_us = (uint32_t)aviso->valor[0];
+        medicoes_alarme[i].publicado_us = time_us_32();
+        latencia_registra(&latencias[ETAPA_ACIONAMENTO_PUBLICACAO], medicoes_alarme[i].publicado_us - aviso->instante_us);
+        medicao = i + 1;
+    }
+    LOG(PUBLICANDO_ALARME, alarme_msg, topicos[TOPICO_ALARME]);
+    return publica(state, TOPICO_ALARME, alarme_msg, 1, MQTT_PUBLISH_QOS, true, alarme_request_cb,
+                   (void *)(medicao << 1 | ativo));
+}
+
+// PUBACK de /alarme: confirma o estado publicado, se ainda for o atual, e fecha a medição iniciada em
+// publish_alarme. Uma falha publica de novo o estado atual, que pode já ter mudado.
+static void alarme_request_cb(void *arg, err_t err) {
+    metricas_publicacao_concluida(err);
+    if (err != ERR_OK) {
+        LOG(FALHA_ALARME, err);
+        if (state.alarme_pendente) {
+            repete_pedido(&state, PEDIDO_ALARME, PEDIDOS_FALHA_MS);
         }
+        return;
+    }
+    bool ativo = (uintptr_t)arg & 1;
+    if (ativo == ((estado_alarme & TELEMETRIA_ALARME_ATIVO) != 0)) {
+        state.alarme_pendente = false;
     }
+    uintptr_t i = (uintptr_t)arg >> 1;
+    if (i == 0 || i > MEDICOES_ALARME) {
+        return;
+    }
+    uint32_t agora_us = time_us_32();
+    const medicao_alarme_t *medicao = &medicoes_alarme[i - 1];
+    latencia_registra(&latencias[ETAPA_PUBLICACAO_PUBACK], agora_us - medicao->publicado_us);
+    latencia_registra(&latencias[ETAPA_ORIGEM_PUBACK], agora_us - medicao->origem_us);
+}
+
+// As etapas do núcleo 1 são lidas sem sincronização, apenas para diagnóstico
+static void publish_latencias(MQTT_CLIENT_DATA_T *state) {
+    char mensagem[ETAPAS * 80];
+    size_t len = 0;
+    for (int i = 0; i < ETAPAS; i++) {
+        int n = latencia_formata(&latencias[i], nomes_etapas[i], &mensagem[len], sizeof(mensagem) - len);
+        LOG_TEXTO(LOG_INFO, "Latencia %s\n", &mensagem[len]);
+        if (n < 0 || (size_t)n + 1 >= sizeof(mensagem) - len) {
+            break;
+        }
+        len += n;
+        mensagem[len++] = '\n';
+    }
+    if (!state->mqtt_client_inst || !mqtt_client_is_connected(state->mqtt_client_inst)) {
+        return;
+    }
+    publica(state, TOPICO_LATENCIA, mensagem, len, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
+}
+
+// Registra o instante da fase na primeira vez
+static void marca_fase(fase_boot_t fase) {
+    if (fases_boot_us[fase]) {
+        return;
+    }
+    uint32_t agora_us = time_us_32();
+    fases_boot_us[fase] = agora_us;
+    LOG(BOOT_FASE, nomes_fases_boot[fase], (unsigned long)agora_us);
+}
+
+// Relatório com todas as fases, depois da primeira publicação de telemetria; ERR_OK sem nada a publicar
+static err_t publish_relatorio_boot(MQTT_CLIENT_DATA_T *state) {
+    static bool publicado = false;
+    if (publicado || !fases_boot_us[FASE_PUBLICACAO]) {
+        return ERR_OK;
+    }
+
+    char mensagem[FASES_BOOT * 24];
+    size_t len = 0;
+    for (int i = 0; i < FASES_BOOT && len < sizeof(mensagem); i++) {
+        int n = snprintf(&mensagem[len], sizeof(mensagem) - len, "%s%s_us=%lu", i ? " " : "", nomes_fases_boot[i],
+                         (unsigned long)fases_boot_us[i]);
+        if (n < 0) {
+            return ERR_VAL;
+        }
+        len += (size_t)n;
+    }
+    if (len >= sizeof(mensagem)) {
+        len = sizeof(mensagem) - 1;
+    }
+    err_t err = publica(state, TOPICO_BOOT, mensagem, len, MQTT_PUBLISH_QOS, true, pub_request_cb, state);
+    if (err == ERR_OK) {
+        publicado = true;
+        LOG_TEXTO(LOG_INFO, "Boot %s\n", mensagem);
+    }
+    return err;
+}
+
+// Avaliação periódica do alarme médico a partir da última leitura filtrada
+static void alarm_worker_fn(agendador_tarefa_t *tarefa) {
+    uint32_t avaliacao_us = time_us_32();
+    sinais_leitura_t leitura;
+    sinais_leitura(&leitura);
+    if (!leitura.instante_us) {
+        agendador_agenda(tarefa, ALARME_PRIMEIRA_LEITURA_MS); // Logo após a partida, sem bloco do ADC ainda
+        return;
+    }
+    if (!fases_boot_us[FASE_AVALIACAO]) {
+        marca_fase(FASE_AVALIACAO);
+        agendador_dispara(&tarefa_display); // Alarme ativo; agora o display pode ocupar o núcleo
+    }
+    uint32_t agora_ms = to_ms_since_boot(get_absolute_time());
+    gerenciar_alarme(alarme_avalia(&alarme, leitura.temperatura_c100, leitura.batimento_bpm, agora_ms),
+                     leitura.instante_us, avaliacao_us);
+}
+
+// Exibe a última leitura filtrada no display
+static void display_worker_fn(agendador_tarefa_t *tarefa) {
+    static bool display_iniciado = false;
+    if (!display_iniciado) {
+        init_ssd();
+        if (!matriz_init(MATRIZ_PIN)) {
+            LOG(MATRIZ_INDISPONIVEL);
+        }
+        display_iniciado = true;
+        marca_fase(FASE_DISPLAY);
+    }
+    sinais_leitura_t leitura;
+    sinais_leitura(&leitura);
+    uint32_t inicio_us = time_us_32();
+    display_info(read_temperatura(&leitura), read_batimento(&leitura));
+    mostra_matriz(&leitura);
+    metricas_renderizacao(time_us_32() - inicio_us);
+}
+
+// Barra de duas colunas a partir da linha de baixo: um LED no mínimo da faixa do alarme e a altura toda
+// no máximo, em verde. Acima do máximo, a altura toda em vermelho; abaixo do mínimo, só o LED de baixo, em azul.
+static void barra_matriz(uint8_t coluna, int32_t valor, const alarme_limite_t *limite) {
+    const int32_t altura_maxima = MATRIZ_LADO - 1; // A primeira linha mostra o estado do alarme
+    int32_t altura;
+    uint32_t cor;
+    if (valor < limite->minimo) {
+        altura = 1;
+        cor = matriz_cor(0, 0, MATRIZ_BRILHO);
+    } else if (valor > limite->maximo) {
+        altura = altura_maxima;
+        cor = matriz_cor(MATRIZ_BRILHO, 0, 0);
+    } else {
+        altura = 1 + (valor - limite->minimo) * (altura_maxima - 1) / (limite->maximo - limite->minimo);
+        cor = matriz_cor(0, MATRIZ_BRILHO, 0);
+    }
+    for (int32_t i = 0; i < altura; i++) {
+        uint8_t linha = (uint8_t)(MATRIZ_LADO - 1 - i);
+        matriz_pixel(coluna, linha, cor);
+        matriz_pixel(coluna + 1, linha, cor);
+    }
+}
+
+// Primeira linha vermelha com o alarme ativo e verde sem ele; abaixo, a temperatura nas duas colunas da
+// esquerda e o batimento nas duas da direita. O quadro só vai para os LEDs quando muda.
+static void mostra_matriz(const sinais_leitura_t *leitura) {
+    matriz_limpa();
+    uint32_t estado = alarme_ativo(&alarme) ? matriz_cor(MATRIZ_BRILHO, 0, 0) : matriz_cor(0, MATRIZ_BRILHO, 0);
+    for (uint8_t x = 0; x < MATRIZ_LADO; x++) {
+        matriz_pixel(x, 0, estado);
+    }
+    barra_matriz(0, leitura->temperatura_c100, &alarme.temperatura);
+    barra_matriz(MATRIZ_LADO - 2, leitura->batimento_bpm, &alarme.batimento);
+    matriz_envia();
 }
 
 // Requisição para publicar
 static void pub_request_cb(__unused void *arg, err_t err) {
+    metricas_publicacao_concluida(err);
     if (err != 0) {
-        ERROR_printf("pub_request_cb failed %d", err);
+        LOG(FALHA_PUBLICACAO, err);
     }
 }
 
-//Topico MQTT
-static const char *full_topic(MQTT_CLIENT_DATA_T *state, const char *name) {
-#if MQTT_UNIQUE_TOPIC
-    static char full_topic[MQTT_TOPIC_LEN];
-    snprintf(full_topic, sizeof(full_topic), "/%s%s", state->mqtt_client_info.client_id, name);
-    return full_topic;
-#else
-    return name;
-#endif
+static err_t publica(MQTT_CLIENT_DATA_T *state, topico_id_t topico, const void *dados, size_t len, u8_t qos,
+                     u8_t retain, mqtt_request_cb_t cb, void *arg) {
+    err_t err = mqtt_publish(state->mqtt_client_inst, topicos[topico], dados, (u16_t)len, qos, retain, cb, arg);
+    metricas_publicacao(err);
+    return err;
 }
 
 // Controle do LED
@@ -361,11 +1013,11 @@ static void control_led(bool on) {
     if (on){
         gpio_put(LED_PIN_RED, 1); // Liga o LED vermelho
         gpio_put(LED_PIN_GREEN, 0); // Desliga o LED verde
-        INFO_printf("LED vermelho ligado\n");
+        LOG(LED_VERMELHO);
     } else {
         gpio_put(LED_PIN_RED, 0); // Desliga o LED vermelho
         gpio_put(LED_PIN_GREEN, 1); // Liga o LED verde
-        INFO_printf("LED verde ligado\n");
+        LOG(LED_VERDE);
     }
 
     //mqtt_publish(state->mqtt_client_inst, full_topic(state, "/alarm/state"), message, strlen(message), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
@@ -373,144 +1025,355 @@ static void control_led(bool on) {
 
 // Publicar saúde
 static void publish_health(MQTT_CLIENT_DATA_T *state) {
+#if MQTT_COMBINED_TELEMETRY
+    publish_telemetria(state);
+#else
+    if (!state->mqtt_client_inst || !mqtt_client_is_connected(state->mqtt_client_inst)) {
+        return; // Valores instantâneos não são guardados para depois
+    }
 
-    const char *temperatura_key = full_topic(state, "/temperatura");
-    float temperatura = read_temperatura();
+    // Uma única leitura alimenta as publicações
+    sinais_leitura_t leitura;
+    sinais_leitura(&leitura);
 
     // Publish temperatura on /temperatura topic
     char temp_str[16];
-    snprintf(temp_str, sizeof(temp_str), "%.2f", temperatura);
-    INFO_printf("Publishing %s to %s\n", temp_str, temperatura_key);
-    mqtt_publish(state->mqtt_client_inst, temperatura_key, temp_str, strlen(temp_str), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
+    int temp_len = formata_centesimos(temp_str, sizeof(temp_str), leitura.temperatura_c100);
+    LOG(PUBLICANDO, temp_str, topicos[TOPICO_TEMPERATURA]);
+    if (publica(state, TOPICO_TEMPERATURA, temp_str, (size_t)temp_len, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state) == ERR_OK) {
+        telemetria_publicada(state);
+    }
 
     static int old_batimento;
-    const char *batimento_key = full_topic(state, "/batimento");
-    int batimento = read_batimento();
+    int batimento = read_batimento(&leitura);
     // Verifica se o batimento mudou
     if (batimento != old_batimento) {
-        old_batimento = batimento;
-        // Publish batimento on /batimento topic
+        // Publish batimento on /batimento topic; recusado, é tentado de novo na próxima rodada
         char bat_str[16];
-        snprintf(bat_str, sizeof(bat_str), "%.2d", batimento);
-        INFO_printf("Publishing %s to %s\n", bat_str, batimento_key);
-        mqtt_publish(state->mqtt_client_inst, batimento_key, bat_str, strlen(bat_str), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
+        int bat_len = snprintf(bat_str, sizeof(bat_str), "%.2d", batimento);
+        LOG(PUBLICANDO, bat_str, topicos[TOPICO_BATIMENTO]);
+        if (publica(state, TOPICO_BATIMENTO, bat_str, (size_t)bat_len, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state) == ERR_OK) {
+            old_batimento = batimento;
+        }
     }
+#endif
+}
 
-    // Verifica se há uma condição de alarme e publica o status do alarme
-    // Se o alarme médico estiver ativo, o alarme manual será ignorado
-    bool alarme_atual = gerenciar_alarme(temperatura, batimento);
-    const char *alarme_key = full_topic(state, "/alarme");
-    const char *alarme_msg = alarme_atual ? "1" : "0";
-    
-    INFO_printf("Publishing alarm status %s to %s\n", alarme_msg, alarme_key);
-    mqtt_publish(state->mqtt_client_inst, alarme_key, alarme_msg, strlen(alarme_msg), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
+#if MQTT_COMBINED_TELEMETRY
+// Coleta uma amostra filtrada com o estado do alarme
+static void coleta_amostra(void) {
+    sinais_leitura_t leitura;
+    sinais_leitura(&leitura);
+
+    telemetria_registro_t amostra = {
+        .instante_ms = to_ms_since_boot(get_absolute_time()),
+        .temperatura_c100 = leitura.temperatura_c100,
+        .batimento_bpm = leitura.batimento_bpm,
+        .estado = (uint8_t)estado_alarme,
+    };
+    lote_adiciona(&lote, &amostra);
 }
 
-// Requisição de Assinatura - subscribe
-static void sub_request_cb(void *arg, err_t err) {
-    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg;
-    if (err != 0) {
-        panic("subscribe request failed %d", err);
+// Coleta periódica; o período divide o intervalo de publicação pelo tamanho do lote
+static void amostra_worker_fn(agendador_tarefa_t *tarefa) {
+    coleta_amostra();
+}
+
+// Codifica as amostras acumuladas, até lote_tamanho por mensagem (formato em lib/telemetria.h), e as coloca
+// na fila de envio; a sequência e os instantes originais são mantidos quando o envio é adiado
+static void publish_telemetria(MQTT_CLIENT_DATA_T *state) {
+    static uint32_t sequencia = 0;
+    static uint8_t mensagem[LOTE_MENSAGEM_MAXIMA];
+
+    while (lote_contagem(&lote) > 0) {
+        uint8_t n = lote_contagem(&lote) < lote_tamanho ? lote_contagem(&lote) : lote_tamanho;
+        size_t len = lote_codifica(&lote, n, sequencia++, mensagem, sizeof(mensagem));
+        if (!fila_envio_adiciona(&fila, mensagem, len)) {
+            LOG(FILA_TELEMETRIA_CHEIA, (unsigned)fila.descartadas);
+        }
+        lote_remove(&lote, n);
     }
-    state->subscribe_count++;
+    agendador_dispara(&tarefa_envio);
 }
 
-// Requisição para encerrar a assinatura
-static void unsub_request_cb(void *arg, err_t err) {
-    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg;
-    if (err != 0) {
-        panic("unsubscribe request failed %d", err);
+// Envia as mensagens da fila em ordem, sem ultrapassar o limite de publicações aguardando confirmação
+static void envio_worker_fn(agendador_tarefa_t *tarefa) {
+    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)tarefa->dados;
+    if (!state->mqtt_client_inst || !mqtt_client_is_connected(state->mqtt_client_inst)) {
+        return; // Retomado quando a conexão for aceita
     }
-    state->subscribe_count--;
-    assert(state->subscribe_count >= 0);
 
-    // Stop if requested
-    if (state->subscribe_count <= 0 && state->stop_client) {
-        mqtt_disconnect(state->mqtt_client_inst);
+    static uint8_t mensagem[LOTE_MENSAGEM_MAXIMA];
+    for (int enviadas = 0; enviadas < FILA_REENVIO_POR_RODADA && fila_em_voo < FILA_EM_VOO_MAX; enviadas++) {
+        size_t len = fila_envio_proxima(&fila, mensagem, sizeof(mensagem));
+        if (!len) {
+            break;
+        }
+        err_t err = publica(state, TOPICO_TELEMETRIA, mensagem, len, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN,
+                            telemetria_request_cb, (void *)(uintptr_t)fila_geracao);
+        if (err != ERR_OK) {
+            break; // Cliente sem espaço; nova tentativa na próxima rodada
+        }
+        fila_envio_marca_enviada(&fila);
+        fila_em_voo++;
+        telemetria_publicada(state);
+        LOG(PUBLICADO, (unsigned)len, topicos[TOPICO_TELEMETRIA], (unsigned)fila_envio_contagem(&fila));
+    }
+
+    // Com o limite de confirmações atingido, a próxima rodada parte de telemetria_request_cb
+    if (fila_envio_pendente(&fila) && fila_em_voo < FILA_EM_VOO_MAX) {
+        agendador_agenda(tarefa, FILA_REENVIO_INTERVALO_MS);
+    }
+}
+
+// A mensagem só sai da fila com a confirmação do broker; uma falha faz as não confirmadas serem reenviadas
+static void telemetria_request_cb(void *arg, err_t err) {
+    metricas_publicacao_concluida(err);
+    if ((uint8_t)(uintptr_t)arg != fila_geracao) {
+        return; // Publicação anterior a um reenvio, já contabilizada
+    }
+    fila_em_voo--;
+    if (err == ERR_OK) {
+        fila_envio_confirma(&fila);
+    } else {
+        LOG(FALHA_TELEMETRIA, err);
+        fila_envio_reenvia(&fila);
+        fila_em_voo = 0;
+        fila_geracao++;
+    }
+    if (fila_envio_pendente(&fila)) {
+        agendador_agenda(&tarefa_envio, FILA_REENVIO_INTERVALO_MS);
     }
 }
+#endif
 
-// Tópicos de assinatura
-static void sub_unsub_topics(MQTT_CLIENT_DATA_T* state, bool sub) {
-    mqtt_request_cb_t cb = sub ? sub_request_cb : unsub_request_cb;
-    mqtt_sub_unsub(state->mqtt_client_inst, full_topic(state, "/comando/temperatura"), MQTT_SUBSCRIBE_QOS, cb, state, sub);
-    mqtt_sub_unsub(state->mqtt_client_inst, full_topic(state, "/comando/batimento"), MQTT_SUBSCRIBE_QOS, cb, state, sub);
-    mqtt_sub_unsub(state->mqtt_client_inst, full_topic(state, "/print"), MQTT_SUBSCRIBE_QOS, cb, state, sub);
-    mqtt_sub_unsub(state->mqtt_client_inst, full_topic(state, "/ping"), MQTT_SUBSCRIBE_QOS, cb, state, sub);
-    mqtt_sub_unsub(state->mqtt_client_inst, full_topic(state, "/exit"), MQTT_SUBSCRIBE_QOS, cb, state, sub);
+#if !MQTT_COMBINED_TELEMETRY
+// Formata centésimos como número com duas casas decimais, sem printf de ponto flutuante
+static int formata_centesimos(char *destino, size_t tamanho, int32_t centesimos) {
+    const char *sinal = centesimos < 0 ? "-" : "";
+    uint32_t absoluto = centesimos < 0 ? -(uint32_t)centesimos : (uint32_t)centesimos;
+    return snprintf(destino, tamanho, "%s%lu.%02lu", sinal, (unsigned long)(absoluto / 100), (unsigned long)(absoluto % 100));
 }
+#endif
 
-// Dados de entrada MQTT
-static void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags) {
-    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg;
-#if MQTT_UNIQUE_TOPIC
-    const char *basic_topic = state->topic + strlen(state->mqtt_client_info.client_id) + 1;
-#else
-    const char *basic_topic = state->topic;
-#endif
-    strncpy(state->data, (const char *)data, len);
-    state->len = len;
-    state->data[len] = '\0';
-
-    DEBUG_printf("Topic: %s, Message: %s\n", state->topic, state->data);
-    if (strcmp(basic_topic, "/comando/batimento") == 0) {
-        char *data_str = (char *)state->data;
-        char *separator = strchr(data_str, ',');
-        if (separator){
-            *separator = '\0'; // Separa a string em dois, pela vírgula
-            int novo_batimento_min = atoi(data_str); // Converte a parte antes da vírgula para inteiro
-            int novo_batimento_max = atoi(separator + 1); // Converte a parte depois da vírgula para inteiro
-            if (novo_batimento_min < 0 || novo_batimento_max < 0 || novo_batimento_min >= novo_batimento_max) {
-                ERROR_printf("Faixa de batimento inválida: %.2d, %.2d\n", novo_batimento_min, novo_batimento_max);
-            } else {
-                bpm_min = (int)novo_batimento_min;
-                bpm_max = (int)novo_batimento_max;
-                INFO_printf("Faixa de batimento atualizada: %d - %d\n", bpm_min, bpm_max);
-            }
-        } else {
-            ERROR_printf("Formato inválido para batimento: %s\n", state->data);
+// Emite os pendentes em ordem de prioridade até o lwIP recusar um por falta de vaga
+static void pedidos_worker_fn(agendador_tarefa_t *tarefa) {
+    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)tarefa->dados;
+    for (int pedido = 0; pedido < PEDIDOS_CONEXAO && state->pedidos_pendentes; pedido++) {
+        if (!(state->pedidos_pendentes & PEDIDO_BIT(pedido))) {
+            continue;
         }
-    } else if (strcmp(basic_topic, "/comando/temperatura") == 0) {
-        char *data_str = (char *)state->data;
-        char *separator = strchr(data_str, ',');
-        if (separator) {
-            *separator = '\0'; // Separa a string em dois, pela vírgula
-            float novo_temp_min = atof(data_str); // Converte a parte antes da vírgula para float
-            float novo_temp_max = atof(separator + 1); // Converte a parte depois da vírgula para float
-            if (novo_temp_min < 0 || novo_temp_max < 0 || novo_temp_min >= novo_temp_max) {
-                ERROR_printf("Faixa de temperatura inválida: %.2f, %.2f\n", novo_temp_min, novo_temp_max);
-            } else {
-                temp_min = novo_temp_min;
-                temp_max = novo_temp_max;
-                INFO_printf("Faixa de temperatura atualizada: %.2f - %.2f\n", temp_min, temp_max);
-            }
-        } else {
-            ERROR_printf("Formato inválido para temperatura: %s\n", state->data);
+        if (faz_pedido(state, (pedido_conexao_t)pedido) == ERR_MEM) {
+            break;
+        }
+        // Aceito, ou sem conexão: nesse caso o próximo CONNACK refaz todos
+        state->pedidos_pendentes &= ~PEDIDO_BIT(pedido);
+        if (pedido == PEDIDO_TELEMETRIA) {
+            break; // A tarefa de publicação ocupa as vagas antes dos tópicos de controle
         }
+    }
+    if (state->pedidos_pendentes) {
+        agendador_agenda(tarefa, PEDIDOS_REPETICAO_MS);
+    }
+}
+
+static err_t faz_pedido(MQTT_CLIENT_DATA_T *state, pedido_conexao_t pedido) {
+    switch (pedido) {
+    case PEDIDO_ONLINE:
+        return publica(state, TOPICO_ONLINE, "1", 1, MQTT_WILL_QOS, true, pub_request_cb, state);
+    case PEDIDO_ALARME:
+        return publish_alarme(state, (estado_alarme & TELEMETRIA_ALARME_ATIVO) != 0, NULL);
+    case PEDIDO_TELEMETRIA:
+        // Na telemetria combinada, também envia o que foi acumulado enquanto a conexão estava fora
+        agendador_dispara(&tarefa_publicacao);
+        return ERR_OK;
+    case PEDIDO_RELATORIO_BOOT:
+        return publish_relatorio_boot(state);
+    default:
+        // Depois do /exit, as assinaturas pendentes são as que devem ser desfeitas
+        return mqtt_sub_unsub(state->mqtt_client_inst, topicos[filtros_assinatura[pedido]], MQTT_SUBSCRIBE_QOS,
+                              state->stop_client ? unsub_request_cb : sub_request_cb, (void *)(uintptr_t)pedido,
+                              !state->stop_client);
+    }
+}
+
+static void repete_pedido(MQTT_CLIENT_DATA_T *state, pedido_conexao_t pedido, uint32_t atraso_ms) {
+    state->pedidos_pendentes |= PEDIDO_BIT(pedido);
+    agendador_agenda(&tarefa_pedidos, atraso_ms);
+}
+
+// SUBACK: uma falha (prazo esgotado ou filtro recusado pelo broker) só adia a assinatura
+static void sub_request_cb(void *arg, err_t err) {
+    pedido_conexao_t pedido = (pedido_conexao_t)(uintptr_t)arg;
+    if (err != ERR_OK) {
+        LOG(ASSINATURA_FALHOU, "subscribe", topicos[filtros_assinatura[pedido]], err);
+        repete_pedido(&state, pedido, PEDIDOS_FALHA_MS);
+        return;
+    }
+    state.assinados |= PEDIDO_BIT(pedido);
+    if (state.stop_client) {
+        repete_pedido(&state, pedido, 0); // Confirmada depois do /exit: também é desfeita
+    }
+}
 
-    } else if (strcmp(basic_topic, "/print") == 0) {
-        INFO_printf("%.*s\n", len, data);
-    } else if (strcmp(basic_topic, "/ping") == 0) {
-        char buf[11];
-        snprintf(buf, sizeof(buf), "%u", to_ms_since_boot(get_absolute_time()) / 1000);
-        mqtt_publish(state->mqtt_client_inst, full_topic(state, "/uptime"), buf, strlen(buf), MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
-    } else if (strcmp(basic_topic, "/exit") == 0) {
-        state->stop_client = true; // stop the client when ALL subscriptions are stopped
-        sub_unsub_topics(state, false); // unsubscribe
+// UNSUBACK: o cliente é desconectado quando todas as assinaturas foram desfeitas
+static void unsub_request_cb(void *arg, err_t err) {
+    pedido_conexao_t pedido = (pedido_conexao_t)(uintptr_t)arg;
+    if (err != ERR_OK) {
+        LOG(ASSINATURA_FALHOU, "unsubscribe", topicos[filtros_assinatura[pedido]], err);
+        repete_pedido(&state, pedido, PEDIDOS_FALHA_MS);
+        return;
+    }
+    state.assinados &= ~PEDIDO_BIT(pedido);
+    if (!state.assinados && state.stop_client) {
+        mqtt_disconnect(state.mqtt_client_inst);
     }
 }
 
+static void telemetria_publicada(MQTT_CLIENT_DATA_T *state) {
+    if (state->aguardando_telemetria) {
+        state->aguardando_telemetria = false;
+        metricas.connack_telemetria_us = time_us_32() - state->connack_us;
+        LOG(PRIMEIRA_TELEMETRIA, (unsigned long)metricas.connack_telemetria_us);
+    }
+    if (!fases_boot_us[FASE_PUBLICACAO]) {
+        marca_fase(FASE_PUBLICACAO);
+        repete_pedido(state, PEDIDO_RELATORIO_BOOT, 0);
+    }
+}
+
+// Dados de entrada MQTT: o lwIP entrega cada publicação em pedaços, o último com MQTT_DATA_FLAG_LAST
+static void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags) {
+    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg;
+    comandos_fragmento(&state->comandos, data, len, (flags & MQTT_DATA_FLAG_LAST) != 0);
+}
+
 // Dados de entrada publicados
 static void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len) {
     MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg;
-    strncpy(state->topic, topic, sizeof(state->topic));
+    comandos_inicia(&state->comandos, topic, tot_len);
+}
+
+// Faixa do alarme de temperatura, "minimo,maximo" em graus Celsius com até duas casas
+static void comando_temperatura(void *contexto, const char *dados, size_t len) {
+    int32_t minimo, maximo;
+    if (!comandos_le_par(dados, len, 2, &minimo, &maximo)) {
+        LOG(TEMPERATURA_FORMATO, dados);
+    } else if (minimo < 0 || maximo < 0 || minimo >= maximo) {
+        LOG(TEMPERATURA_INVALIDA, dados);
+    } else if (!envia_nucleo1(EVENTO_FAIXA_TEMPERATURA, minimo, maximo)) {
+        LOG(TEMPERATURA_FILA_CHEIA);
+    } else {
+        LOG(TEMPERATURA_ATUALIZADA, (int)(minimo / 100), (int)(minimo % 100), (int)(maximo / 100), (int)(maximo % 100));
+    }
+}
+
+// Faixa do alarme de batimento, "minimo,maximo" em BPM
+static void comando_batimento(void *contexto, const char *dados, size_t len) {
+    int32_t minimo, maximo;
+    if (!comandos_le_par(dados, len, 0, &minimo, &maximo)) {
+        LOG(BATIMENTO_FORMATO, dados);
+    } else if (minimo < 0 || maximo < 0 || minimo >= maximo) {
+        LOG(BATIMENTO_INVALIDO, (int)minimo, (int)maximo);
+    } else if (!envia_nucleo1(EVENTO_FAIXA_BATIMENTO, minimo, maximo)) {
+        LOG(BATIMENTO_FILA_CHEIA);
+    } else {
+        LOG(BATIMENTO_ATUALIZADO, (int)minimo, (int)maximo);
+    }
+}
+
+#if MQTT_COMBINED_TELEMETRY
+// Formato "amostras,intervalo_ms"; vale a partir da próxima coleta e da próxima publicação
+static void comando_lote(void *contexto, const char *dados, size_t len) {
+    int32_t novo_tamanho, novo_intervalo_ms;
+    if (!comandos_le_par(dados, len, 0, &novo_tamanho, &novo_intervalo_ms)) {
+        LOG(LOTE_FORMATO, dados);
+    } else if (novo_tamanho < 1 || novo_tamanho > LOTE_AMOSTRAS_MAX ||
+               novo_intervalo_ms < novo_tamanho * LOTE_PERIODO_MINIMO_MS || novo_intervalo_ms > LOTE_INTERVALO_MAXIMO_MS) {
+        LOG(LOTE_INVALIDO, (int)novo_tamanho, (long)novo_intervalo_ms);
+    } else {
+        lote_tamanho = (uint8_t)novo_tamanho;
+        agendador_set_periodo(&tarefa_amostra, (uint32_t)novo_intervalo_ms / lote_tamanho);
+        agendador_set_periodo(&tarefa_publicacao, (uint32_t)novo_intervalo_ms);
+        LOG(LOTE_ATUALIZADO, (int)novo_tamanho, (long)novo_intervalo_ms);
+    }
+}
+#endif
+
+static void comando_print(void *contexto, const char *dados, size_t len) {
+    LOG_TEXTO(LOG_INFO, "%s\n", dados);
+}
+
+static void comando_ping(void *contexto, const char *dados, size_t len) {
+    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)contexto;
+    char buf[11];
+    int n = snprintf(buf, sizeof(buf), "%u", to_ms_since_boot(get_absolute_time()) / 1000);
+    publica(state, TOPICO_UPTIME, buf, (size_t)n, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, state);
+}
+
+static void comando_exit(void *contexto, const char *dados, size_t len) {
+    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)contexto;
+    state->stop_client = true; // stop the client when ALL subscriptions are stopped
+    state->pedidos_pendentes = state->assinados;
+    if (!state->assinados) {
+        mqtt_disconnect(state->mqtt_client_inst);
+        return;
+    }
+    agendador_dispara(&tarefa_pedidos);
 }
 
 // Publicar saúde
-static void health_worker_fn(async_context_t *context, async_at_time_worker_t *worker) {
-    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)worker->user_data;
+static void health_worker_fn(agendador_tarefa_t *tarefa) {
+    MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)tarefa->dados;
     publish_health(state);
-    async_context_add_at_time_worker_in_ms(context, worker, HEALTH_WORKER_TIME_S * 1000);
+}
+
+// Execuções e piores tempos das tarefas; as do núcleo 1 são lidas sem sincronização, apenas para diagnóstico
+static void relatorio_worker_fn(agendador_tarefa_t *tarefa) {
+    static const agendador_tarefa_t *const tarefas[] = {
+        &tarefa_alarme, &tarefa_display, &tarefa_publicacao, &tarefa_pedidos, &tarefa_metricas, &tarefa_log,
+#if MQTT_COMBINED_TELEMETRY
+        &tarefa_amostra, &tarefa_envio,
+#endif
+    };
+    for (size_t i = 0; i < sizeof(tarefas) / sizeof(tarefas[0]); i++) {
+        agendador_imprime(tarefas[i]);
+    }
+    publish_latencias(&state);
+}
+
+// Completa o instantâneo com os valores amostrados e o publica; os contadores do núcleo 1 são lidos
+// sem sincronização, apenas para diagnóstico
+static void metricas_worker_fn(agendador_tarefa_t *tarefa) {
+    aq_leitura_t leitura;
+    aquisicao_leitura(&leitura);
+    metricas.blocos_adc = leitura.sequencia;
+    metricas.bytes_i2c = display_bytes_enviados();
+    metricas.envio_display_us = display_tempo_envio_us();
+    metricas.quadros_matriz = matriz_quadros_enviados();
+    metricas.quadros_matriz_iguais = matriz_quadros_iguais();
+    metricas_amostra();
+
+    char mensagem[320];
+    int len = metricas_formata(mensagem, sizeof(mensagem));
+    if (len < 0) {
+        return;
+    }
+    if ((size_t)len >= sizeof(mensagem)) {
+        len = sizeof(mensagem) - 1;
+    }
+    LOG_TEXTO(LOG_INFO, "Metricas %s\n", mensagem);
+    if (!state.mqtt_client_inst || !mqtt_client_is_connected(state.mqtt_client_inst)) {
+        return;
+    }
+    publica(&state, TOPICO_METRICAS, mensagem, len, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, pub_request_cb, &state);
+}
+
+// Os registros gravados em qualquer núcleo saem no stdio a partir daqui, em ordem de instante
+static void log_worker_fn(agendador_tarefa_t *tarefa) {
+    if (log_drena(LOG_DRENAGEM_POR_RODADA)) {
+        agendador_agenda(tarefa, 1);
+    }
 }
 
 // Conexão MQTT
@@ -518,62 +1381,121 @@ static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection
     MQTT_CLIENT_DATA_T* state = (MQTT_CLIENT_DATA_T*)arg;
     if (status == MQTT_CONNECT_ACCEPTED) {
         state->connect_done = true;
-        sub_unsub_topics(state, true); // subscribe;
-
-        // indicate online
-        if (state->mqtt_client_info.will_topic) {
-            mqtt_publish(state->mqtt_client_inst, state->mqtt_client_info.will_topic, "1", 1, MQTT_WILL_QOS, true, pub_request_cb, state);
+        state->connected = true;
+        state->connect_time_ms = (uint32_t)((time_us_64() - state->connect_start_us) / 1000);
+        metricas.conexoes++;
+        marca_fase(FASE_BROKER);
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_TLS_SESSION_RESUMPTION
+        LOG(CONECTADO_TLS, (unsigned long)state->connect_time_ms,
+            state->tls_session_offered ? "TLS session offered for resumption" : "full TLS handshake");
+        // Guarda a sessão negociada (ou retomada) para a próxima conexão
+        altcp_tls_free_session(&state->tls_session);
+        altcp_tls_init_session(&state->tls_session);
+        state->tls_session_valid = altcp_tls_get_session(state->mqtt_client_inst->conn, &state->tls_session) == ERR_OK;
+#else
+        LOG(CONECTADO, (unsigned long)state->connect_time_ms);
+#endif
+        conexao_broker_conectado();
+
+        // A sessão não é persistente: as assinaturas são refeitas a cada conexão, com o marcador online,
+        // o estado do alarme e a primeira telemetria, todos emitidos sem esperar respostas
+        state->assinados = 0;
+        state->pedidos_pendentes = PEDIDOS_TODOS;
+        state->connack_us = time_us_32();
+        state->aguardando_telemetria = true;
+        agendador_dispara(&tarefa_pedidos);
+    } else {
+        // Desconexão, recusa ou tempo esgotado: o gerenciador de conexão agenda a nova tentativa
+        LOG(CONEXAO_PERDIDA, status);
+        broker_desconectado(state);
+        if (!state->stop_client) {
+            conexao_broker_perdido();
         }
+    }
+}
 
-        // Publish health data every 10 sec if it's changed
-        health_worker.user_data = state;
-        async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &health_worker, 0);
-    } else if (status == MQTT_CONNECT_DISCONNECTED) {
-        if (!state->connect_done) {
-            panic("Failed to connect to mqtt server");
-        }
+// A telemetria continua na fila até a próxima conexão
+static void broker_desconectado(MQTT_CLIENT_DATA_T *state) {
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_TLS_SESSION_RESUMPTION
+    // Uma sessão recusada ou expirada no broker não deve atrasar as próximas tentativas
+    if (!state->connected && state->tls_session_offered) {
+        state->tls_session_valid = false;
     }
-    else {
-        panic("Unexpected status");
+#endif
+    state->connected = false;
+    state->pedidos_pendentes = 0;
+    state->assinados = 0;
+    state->aguardando_telemetria = false;
+    metricas_conexao_perdida();
+#if MQTT_COMBINED_TELEMETRY
+    fila_envio_reenvia(&fila);
+    fila_em_voo = 0;
+    fila_geracao++;
+#endif
+}
+
+// Chamado pelo gerenciador de conexão com o endereço do broker já resolvido
+static bool conectar_broker(const ip_addr_t *endereco) {
+    if (state.stop_client) {
+        return false;
     }
+    state.mqtt_server_address = *endereco;
+    marca_fase(FASE_REDE);
+    return connect_client(&state);
+}
+
+// Wi-Fi perdido ou prazo da conexão esgotado; mqtt_disconnect não chama mqtt_connection_cb
+static void desconectar_broker(void) {
+    mqtt_disconnect(state.mqtt_client_inst);
+    broker_desconectado(&state);
 }
 
 // Inicializar o cliente MQTT
 static void start_client(MQTT_CLIENT_DATA_T *state) {
 #if LWIP_ALTCP && LWIP_ALTCP_TLS
-    const int port = MQTT_TLS_PORT;
-    INFO_printf("Using TLS\n");
+    LOG(USANDO_TLS);
 #else
-    const int port = MQTT_PORT;
-    INFO_printf("Warning: Not using TLS\n");
+    LOG(SEM_TLS);
 #endif
 
     state->mqtt_client_inst = mqtt_client_new();
     if (!state->mqtt_client_inst) {
         panic("MQTT client instance creation error");
     }
-    INFO_printf("IP address of this device %s\n", ipaddr_ntoa(&(netif_list->ip_addr)));
-    INFO_printf("Connecting to mqtt server at %s\n", ipaddr_ntoa(&state->mqtt_server_address));
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_TLS_SESSION_RESUMPTION
+    altcp_tls_init_session(&state->tls_session);
+    state->tls_session_valid = false;
+#endif
+}
+
+// Conectar ao broker; retorna false se a tentativa falhar imediatamente
+static bool connect_client(MQTT_CLIENT_DATA_T *state) {
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+    const int port = MQTT_TLS_PORT;
+#else
+    const int port = MQTT_PORT;
+#endif
+    LOG(CONECTANDO, ipaddr_ntoa(&state->mqtt_server_address));
 
+    state->connected = false;
+    state->connect_start_us = time_us_64();
     cyw43_arch_lwip_begin();
-    if (mqtt_client_connect(state->mqtt_client_inst, &state->mqtt_server_address, port, mqtt_connection_cb, state, &state->mqtt_client_info) != ERR_OK) {
-        panic("MQTT broker connection error");
+    err_t err = mqtt_client_connect(state->mqtt_client_inst, &state->mqtt_server_address, port, mqtt_connection_cb, state, &state->mqtt_client_info);
+    if (err != ERR_OK) {
+        cyw43_arch_lwip_end();
+        LOG(ERRO_CONEXAO, err);
+        return false;
     }
 #if LWIP_ALTCP && LWIP_ALTCP_TLS
     // This is important for MBEDTLS_SSL_SERVER_NAME_INDICATION
     mbedtls_ssl_set_hostname(altcp_tls_context(state->mqtt_client_inst->conn), MQTT_SERVER);
+#if MQTT_TLS_SESSION_RESUMPTION
+    // O handshake começa quando o TCP conectar, então a sessão ainda pode ser definida aqui
+    state->tls_session_offered = state->tls_session_valid &&
+            altcp_tls_set_session(state->mqtt_client_inst->conn, &state->tls_session) == ERR_OK;
+#endif
 #endif
     mqtt_set_inpub_callback(state->mqtt_client_inst, mqtt_incoming_publish_cb, mqtt_incoming_data_cb, state);
     cyw43_arch_lwip_end();
+    return true;
 }
-
-// Call back com o resultado do DNS
-static void dns_found(const char *hostname, const ip_addr_t *ipaddr, void *arg) {
-    MQTT_CLIENT_DATA_T *state = (MQTT_CLIENT_DATA_T*)arg;
-    if (ipaddr) {
-        state->mqtt_server_address = *ipaddr;
-        start_client(state);
-    } else {
-        panic("dns request failed");
-    }
-}
\ No newline at end of file